@@ -0,0 +1,43 @@
+#!/bin/sh
+# File:        array_growth.sh
+# Author:      Karl-Mihkel Ott
+# Created      2021-06-12
+# Last edit:   2021-06-12
+# Description: Measure tracked and resident memory after loading a generated log file
+#              and adding a single log, for each array growth factor
+# Usage:       sh bench/array_growth.sh [log count] [growth factors as NUM/DEN ...]
+
+LOG_C="${1:-10000000}"
+[ $# -gt 0 ] && shift
+FACTORS="${*:-3/2 2/1 5/4}"
+
+ROOT="$(pwd)"
+DIR="$(mktemp -d)"
+trap 'rm -rf "$DIR"' EXIT
+
+# Logs are spread over the sample power plants with distinct dates per plant
+cp plants.csv "$DIR"
+awk -v n="$LOG_C" 'BEGIN {
+    for(i = 0; i < n; i++) {
+        d = int(i / 63);
+        printf("%d,%d,%f,%f,\"%04d-%02d-%02d\"\n", i + 1, i % 63 + 1, (i % 1000) / 10.0,
+            (i % 500) / 10000.0, 1990 + int(d / 336) % 100, int(d / 28) % 12 + 1, d % 28 + 1);
+    }
+}' > "$DIR/logs.csv"
+
+for f in $FACTORS; do
+    num="${f%/*}"
+    den="${f#*/}"
+    make -s OBJ_DIR="$DIR/obj_${num}_${den}" TARGET="$DIR/em_${num}_${den}" \
+        FLAGS="-g -O3 -DARRAY_GROWTH_NUM=$num -DARRAY_GROWTH_DEN=$den" > /dev/null || exit 1
+
+    # Adding a log after the load grows the shrunk log array by the growth factor
+    cd "$DIR" || exit 1
+    OUT="$(printf 'plants.csv\nlogs.csv\nselect 1\nnew\na\n1\n1\n2021-01-01\nunsel\nmem\nexit\n' | \
+        "$DIR/em_${num}_${den}" 2>&1)"
+    cd "$ROOT" || exit 1
+
+    echo "Growth factor $num/$den, $LOG_C logs:"
+    printf '%s\n' "$OUT" | sed 's/.*(energy_manager[:0-9]*) //' | grep -a -E '^(Subsystem|logs |total |Resident set)'
+    echo
+done
@@ -11,6 +11,17 @@
 #ifndef __ACT_IMPL_H
 #define __ACT_IMPL_H
 
+#ifdef __ACT_IMPL_C
+    #include <stdio.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include <stdlib.h>
+    #include <stddef.h>
+    #include <stdbool.h>
+    #include <time.h>
+    #include <math.h>
+#endif
+
 
 /// Enumeral values to specify data sorting
 typedef enum ListSortMode {
@@ -23,18 +34,20 @@ typedef enum ListSortMode {
     LIST_SORT_MODE_POW_CAP_DECR             = 6,
     LIST_SORT_MODE_POW_COST_INCR            = 7,
     LIST_SORT_MODE_POW_COST_DECR            = 8,
-    LIST_SORT_MODE_LOG_ID_INCR              = 9,
-    LIST_SORT_MODE_LOG_ID_DECR              = 10,
-    LIST_SORT_MODE_LOG_PLANT_ID_INCR        = 11,
-    LIST_SORT_MODE_LOG_PLANT_ID_DECR        = 12,
-    LIST_SORT_MODE_LOG_PRODUCTION_INCR      = 13,
-    LIST_SORT_MODE_LOG_PRODUCTION_DECR      = 14,
-    LIST_SORT_MODE_LOG_SALE_PRICE_INCR      = 15,
-    LIST_SORT_MODE_LOG_SALE_PRICE_DECR      = 16,
-    LIST_SORT_MODE_LOG_DATE_INCR            = 17,
-    LIST_SORT_MODE_LOG_DATE_DECR            = 18,
+    LIST_SORT_MODE_POW_NAME_INCR            = 9,
+    LIST_SORT_MODE_POW_NAME_DECR            = 10,
+    LIST_SORT_MODE_LOG_ID_INCR              = 11,
+    LIST_SORT_MODE_LOG_ID_DECR              = 12,
+    LIST_SORT_MODE_LOG_PLANT_ID_INCR        = 13,
+    LIST_SORT_MODE_LOG_PLANT_ID_DECR        = 14,
+    LIST_SORT_MODE_LOG_PRODUCTION_INCR      = 15,
+    LIST_SORT_MODE_LOG_PRODUCTION_DECR      = 16,
+    LIST_SORT_MODE_LOG_SALE_PRICE_INCR      = 17,
+    LIST_SORT_MODE_LOG_SALE_PRICE_DECR      = 18,
+    LIST_SORT_MODE_LOG_DATE_INCR            = 19,
+    LIST_SORT_MODE_LOG_DATE_DECR            = 20,
     LIST_SORT_MODE_FIRST_UNSEL              = LIST_SORT_MODE_POW_UTIL_DECR,
-    LIST_SORT_MODE_LAST_UNSEL               = LIST_SORT_MODE_POW_COST_DECR,
+    LIST_SORT_MODE_LAST_UNSEL               = LIST_SORT_MODE_POW_NAME_DECR,
     LIST_SORT_MODE_FIRST_SEL                = LIST_SORT_MODE_LOG_ID_INCR,
     LIST_SORT_MODE_LOG_LAST_SEL             = LIST_SORT_MODE_LOG_DATE_DECR,
     LIST_SORT_MODE_FIRST                    = LIST_SORT_MODE_UNKNOWN,
@@ -42,14 +55,127 @@ typedef enum ListSortMode {
 } ListSortMode;
 
 
+/// Enumeral values to specify the period of rollup buckets
+typedef enum RollupPeriod {
+    ROLLUP_PERIOD_MONTH                     = 0,
+    ROLLUP_PERIOD_YEAR                      = 1
+} RollupPeriod;
+
+
+/// Enumeral values to specify the log field of quantile and group aggregate queries
+typedef enum QuantileField {
+    QUANTILE_FIELD_PRODUCTION               = 0,
+    QUANTILE_FIELD_SALE_PRICE               = 1
+} QuantileField;
+
+
+/// Enumeral values to specify the key that logs are grouped by
+typedef enum GroupKey {
+    GROUP_KEY_PLANT                         = 0,
+    GROUP_KEY_FUEL                          = 1,
+    GROUP_KEY_MONTH                         = 2,
+    GROUP_KEY_YEAR                          = 3,
+    GROUP_KEY_WEEKDAY                       = 4
+} GroupKey;
+
+
+/// Enumeral values to specify the aggregate function over grouped logs
+typedef enum GroupAggFunc {
+    GROUP_AGG_FUNC_SUM                      = 0,
+    GROUP_AGG_FUNC_AVG                      = 1,
+    GROUP_AGG_FUNC_MIN                      = 2,
+    GROUP_AGG_FUNC_MAX                      = 3,
+    GROUP_AGG_FUNC_COUNT                    = 4
+} GroupAggFunc;
+
+
+/// Enumeral values of filter predicate instructions, comparisons push the result of
+/// comparing the field with constant value and logical operators pop their operands
+typedef enum PredicateOp {
+    PREDICATE_OP_LT                         = 0,
+    PREDICATE_OP_LE                         = 1,
+    PREDICATE_OP_GT                         = 2,
+    PREDICATE_OP_GE                         = 3,
+    PREDICATE_OP_EQ                         = 4,
+    PREDICATE_OP_NE                         = 5,
+    PREDICATE_OP_AND                        = 6,
+    PREDICATE_OP_OR                         = 7,
+    PREDICATE_OP_NOT                        = 8,
+    PREDICATE_OP_LAST_CMP                   = PREDICATE_OP_NE
+} PredicateOp;
+
+
+/// Enumeral values of the fields that can be compared in filter predicates
+typedef enum PredicateField {
+    PREDICATE_FIELD_POW_ID                  = 0,
+    PREDICATE_FIELD_POW_FUEL                = 1,
+    PREDICATE_FIELD_POW_RATED_CAP           = 2,
+    PREDICATE_FIELD_POW_AVG_PRICE           = 3,
+    PREDICATE_FIELD_POW_AVG_UTIL            = 4,
+    PREDICATE_FIELD_LOG_ID                  = 5,
+    PREDICATE_FIELD_LOG_PLANT_ID            = 6,
+    PREDICATE_FIELD_LOG_PRODUCTION          = 7,
+    PREDICATE_FIELD_LOG_SALE_PRICE          = 8,
+    PREDICATE_FIELD_LOG_DATE                = 9,
+    PREDICATE_FIELD_LOG_YEAR                = 10,
+    PREDICATE_FIELD_LOG_MONTH               = 11,
+    PREDICATE_FIELD_LOG_DAY                 = 12,
+    PREDICATE_FIELD_LOG_FUEL                = 13
+} PredicateField;
+
+
+/// Structure for a single filter predicate instruction
+/// Predicates are stored in postfix order, so that they can be evaluated with a stack
+typedef struct PredicateInstr {
+    PredicateOp op;
+    PredicateField field;
+    double val;
+} PredicateInstr;
+
+
+/// Maximum amount of instructions in a filter predicate
+#define LIST_MAX_PREDICATE_C    32
+
+
+/// Default rolling window length in days
+#define ROLLING_DEFAULT_DAYS    30
+
+
+/// Default age in days of the logs that are archived
+#define ARCHIVE_DEFAULT_DAYS    365
+
+
+/// Maximum amount of quantiles that can be queried at once
+#define LIST_MAX_QUANTILE_C     8
+
+
+/// Maximum amount of sort keys that can be given for listing, each key is
+/// packed into a 32 bit field of a 128 bit sort key
+#define LIST_MAX_SORT_KEY_C     4
+
+
+/// Structure for specifying how listed data should be ordered and which
+/// rows should be shown
+typedef struct ListQuery {
+    ListSortMode smodes[LIST_MAX_SORT_KEY_C];
+    size_t smode_c;
+    size_t offset;
+    size_t limit;   // 0 means no limit
+    bool has_range;
+    int32_t from;   // first day of the date range
+    int32_t to;     // last day of the date range
+    RollupPeriod period;
+    QuantileField qfield;
+    GroupKey group_key;
+    GroupAggFunc agg_func;
+    double quantiles[LIST_MAX_QUANTILE_C];
+    size_t quantile_c;
+    PredicateInstr pred[LIST_MAX_PREDICATE_C];
+    size_t pred_c;  // 0 means no filter
+} ListQuery;
+
+
 #ifdef __ACT_IMPL_C
-    #include <stdio.h>
-    #include <stdint.h>
-    #include <string.h>
-    #include <stdlib.h>
-    #include <stddef.h>
-    #include <stdbool.h>
-    
     #include <hashmap.h>
     #include <err_def.h>
     #include <entity_data.h>
@@ -57,6 +183,20 @@ typedef enum ListSortMode {
     #include <mem_check.h>
     #include <prompt.h>
     #include <energy_manager.h>
+    #include <log_columns.h>
+    #include <fleet_stats.h>
+    #include <sketch.h>
+    #include <rolling.h>
+    #include <predicate.h>
+    #include <date.h>
+    #include <bitmap.h>
+    #include <indexes.h>
+    #include <group_by.h>
+    #include <id_map.h>
+    #include <arena.h>
+    #include <log_slab.h>
+    #include <log_archive.h>
+    #include <data_store.h>
 
 
     /// Unselected mode help text
@@ -65,16 +205,41 @@ typedef enum ListSortMode {
         "help -- show usage info\n"\
         "new -- create a new power plant entry\n"\
         "list -- show all available power plants\n"\
+        "  [[i|d] <key>]... -- sort by given keys in the order of priority\n"\
         "  [i|d] -- list by increasing or decreasing value (default: increasing)\n"\
         "    plant_id -- sort by plant id\n"\
         "    rated_cap -- sort by rated capacity\n"\
         "    avg_price -- sort by average price per MWh\n"\
         "    avg_util -- sort by average utilisation\n"\
-        "log -- show all available logs\n"\
+        "    name -- sort by power plant name\n"\
+        "  limit <N> -- show only the first N power plants\n"\
+        "  offset <N> -- skip the first N power plants\n"\
+        "  where <expr> -- show only power plants matching the expression, which must be the last argument\n"\
+        "    <field> <op> <value> -- compare the field with value, op is one of < <= > >= = !=\n"\
+        "      fields: plant_id, fuel, rated_cap, avg_price, avg_util\n"\
+        "    not <expr>, <expr> and <expr>, <expr> or <expr>, ( <expr> ) -- combine comparisons\n"\
+        "log -- show all available logs (same arguments as 'list' in selected mode)\n"\
         "edit <ID> -- edit power plant values\n"\
         "delete <ID> -- delete power plant from the list\n"\
         "select <ID> -- select a power plant for usage\n"\
-        "save -- save the data into correct files\n"\
+        "stats -- show fleet-wide log statistics\n"\
+        "stats fuel [<threads>] -- show capacity, production, utilisation and price per fuel type\n"\
+        "rollup [month|year] -- show production and average price per period for each power plant\n"\
+        "quantiles <production|price> [p<N>]... -- show quantiles of log values for the fleet and\n"\
+        "  each fuel type (default: p50 p90 p99)\n"\
+        "rolling [<days>] -- rank power plants by utilisation over the latest days (default: 30)\n"\
+        "count [where <expr>] -- count all logs matching the expression (same fields as 'list'\n"\
+        "  in selected mode)\n"\
+        "group by <key> agg <func>(<field>) [where <expr>] -- aggregate the log field over logs\n"\
+        "  grouped by the key (where fields are the same as 'list' in selected mode)\n"\
+        "    keys: plant, fuel, month, year, weekday\n"\
+        "    funcs: sum, avg, min, max, count\n"\
+        "    fields: production, price\n"\
+        "compact -- remove deleted log rows from log storage\n"\
+        "archive [<days>] -- compress logs older than the given amount of days before the latest\n"\
+        "  log date into per power plant archive, archived logs are read-only (default: 365)\n"\
+        "mem -- show memory usage of each subsystem\n"\
+        "save -- save the data into correct files (or into the data file in store mode)\n"\
         "exit -- exit the program\n";
 
     /// Selected mode help text
@@ -83,85 +248,316 @@ typedef enum ListSortMode {
         "help -- show usage info\n"\
         "new -- create a new log entry\n"\
         "list -- show all logs for that power plant\n"\
+        "  [[i|d] <key>]... -- sort by given keys in the order of priority\n"\
         "  [i|d] -- list by increasing or decreasing value (default: increasing)\n"\
         "    log_id -- sort by log id\n"\
         "    plant_id -- sort by plant id\n"\
         "    production -- sort by production output\n"\
         "    price -- sort by average price for that day\n"\
         "    date -- sort by date\n"\
-        "edit <ID> -- edit log values\n"\
-        "delete <ID> -- delete log\n"\
+        "  limit <N> -- show only the first N logs\n"\
+        "  offset <N> -- skip the first N logs\n"\
+        "  from <yyyy-mm-dd> -- show only logs starting from the date (default order: date)\n"\
+        "  to <yyyy-mm-dd> -- show only logs up to the date (default order: date)\n"\
+        "  where <expr> -- show only logs matching the expression, which must be the last argument\n"\
+        "    <field> <op> <value> -- compare the field with value, op is one of < <= > >= = !=\n"\
+        "      fields: log_id, plant_id, production, price, date, year, month, day, fuel\n"\
+        "    not <expr>, <expr> and <expr>, <expr> or <expr>, ( <expr> ) -- combine comparisons\n"\
+        "edit <ID> -- edit log values, archived logs cannot be edited\n"\
+        "delete <ID> -- delete log, archived logs cannot be deleted\n"\
+        "rollup [month|year] -- show production and average price per period\n"\
+        "quantiles <production|price> [p<N>]... -- show quantiles of log values (default: p50 p90 p99)\n"\
+        "rolling [<days>] -- show utilisation over a sliding window of days (default: 30)\n"\
+        "count [where <expr>] -- count logs matching the expression (same fields as 'list')\n"\
         "unsel -- unselect current power plant\n"\
-        "save -- save the data into correct files\n"\
+        "compact -- remove deleted log rows from log storage\n"\
+        "mem -- show memory usage of each subsystem\n"\
+        "save -- save the data into correct files (or into the data file in store mode)\n"\
         "exit -- exit selected mode\n";
 
 
     #define __MAX_LOG_LINE                  256
     #define __MAX_PLANT_FILE_LINE(max_name) __roundToBase2(82 + max_name)
     #define __DEFAULT_BUF_SIZE              4096
+    #define __DEFAULT_SMALL_BUF_SIZE        64
 
     
-    /// Perform sorting on power plant data according to the list sorting mode
-    void __sortPowerPlantRefs(PowerPlantRefs *p_refs, ListSortMode smode);
+    /// Structure for describing the value that is sorted with certain list sort mode
+    typedef struct __SortKeyDef {
+        size_t val_offset;
+        SortValueType val_type;
+        bool is_decr;
+    } __SortKeyDef;
+
+
+    /// Sorted value descriptions for each list sort mode
+    static const __SortKeyDef __sort_key_defs[] = {
+        [LIST_SORT_MODE_POW_UTIL_DECR]          = { offsetof(PlantData, avg_utilisation),   SORT_VALUE_TYPE_FLOAT32,    true },
+        [LIST_SORT_MODE_POW_UTIL_INCR]          = { offsetof(PlantData, avg_utilisation),   SORT_VALUE_TYPE_FLOAT32,    false },
+        [LIST_SORT_MODE_POW_ID_INCR]            = { offsetof(PlantData, no),                SORT_VALUE_TYPE_UINT32,     false },
+        [LIST_SORT_MODE_POW_ID_DECR]            = { offsetof(PlantData, no),                SORT_VALUE_TYPE_UINT32,     true },
+        [LIST_SORT_MODE_POW_CAP_INCR]           = { offsetof(PlantData, rated_cap),         SORT_VALUE_TYPE_FLOAT32,    false },
+        [LIST_SORT_MODE_POW_CAP_DECR]           = { offsetof(PlantData, rated_cap),         SORT_VALUE_TYPE_FLOAT32,    true },
+        [LIST_SORT_MODE_POW_COST_INCR]          = { offsetof(PlantData, avg_cost),          SORT_VALUE_TYPE_FLOAT32,    false },
+        [LIST_SORT_MODE_POW_COST_DECR]          = { offsetof(PlantData, avg_cost),          SORT_VALUE_TYPE_FLOAT32,    true },
+        [LIST_SORT_MODE_POW_NAME_INCR]          = { offsetof(PlantData, name),              SORT_VALUE_TYPE_STRING,     false },
+        [LIST_SORT_MODE_POW_NAME_DECR]          = { offsetof(PlantData, name),              SORT_VALUE_TYPE_STRING,     true },
+        [LIST_SORT_MODE_LOG_ID_INCR]            = { offsetof(LogEntry, log_id),             SORT_VALUE_TYPE_UINT32,     false },
+        [LIST_SORT_MODE_LOG_ID_DECR]            = { offsetof(LogEntry, log_id),             SORT_VALUE_TYPE_UINT32,     true },
+        [LIST_SORT_MODE_LOG_PLANT_ID_INCR]      = { offsetof(LogEntry, plant_no),           SORT_VALUE_TYPE_UINT32,     false },
+        [LIST_SORT_MODE_LOG_PLANT_ID_DECR]      = { offsetof(LogEntry, plant_no),           SORT_VALUE_TYPE_UINT32,     true },
+        [LIST_SORT_MODE_LOG_PRODUCTION_INCR]    = { offsetof(LogEntry, production),         SORT_VALUE_TYPE_FLOAT32,    false },
+        [LIST_SORT_MODE_LOG_PRODUCTION_DECR]    = { offsetof(LogEntry, production),         SORT_VALUE_TYPE_FLOAT32,    true },
+        [LIST_SORT_MODE_LOG_SALE_PRICE_INCR]    = { offsetof(LogEntry, avg_sale_price),     SORT_VALUE_TYPE_FLOAT32,    false },
+        [LIST_SORT_MODE_LOG_SALE_PRICE_DECR]    = { offsetof(LogEntry, avg_sale_price),     SORT_VALUE_TYPE_FLOAT32,    true },
+        [LIST_SORT_MODE_LOG_DATE_INCR]          = { offsetof(LogEntry, date),               SORT_VALUE_TYPE_DATE,       false },
+        [LIST_SORT_MODE_LOG_DATE_DECR]          = { offsetof(LogEntry, date),               SORT_VALUE_TYPE_DATE,       true },
+    };
+
+
+    /// Pack the key fields of the reference starting from field index beg_field of 
+    /// its key field stream, where each numeric value takes a single field and each 
+    /// string value takes as many fields as needed to hold it
+    /// Returns true if the key field stream continues after the packed fields
+    bool __packRefKey(void *ref, ListSortMode *smodes, size_t smode_c, size_t beg_field,
+        PackedSortKey *p_key);
+
+
+    /// Sort generic references with packed keys built from given list sort modes
+    /// starting from field index beg_field of the key field stream
+    /// If k is not zero, only the first k references are guaranteed to be sorted
+    void __sortRefsByModes(void **refs, size_t n, ListSortMode *smodes, size_t smode_c, size_t k,
+        size_t beg_field);
+
+    
+    /// Perform sorting on power plant data according to the list query sorting modes
+    /// If k is not zero, only the first k references are guaranteed to be sorted
+    void __sortPowerPlantRefs(PowerPlantRefs *p_refs, ListQuery *p_query, size_t k);
 
 
     /// Perform required sorting on logs references according to the list 
-    /// sorting mode
-    void __sortLogRefs(PlantLogRefs *p_logs, ListSortMode smode);
+    /// query sorting modes
+    /// If k is not zero, only the first k references are guaranteed to be sorted
+    void __sortLogRefs(PlantLogRefs *p_logs, ListQuery *p_query, size_t k);
+
+
+    /// Find the index of the first log reference with date not before the given day
+    /// NOTE: Log references must be in date order
+    size_t __lowerBoundLogDate(PlantLogRows *p_rows, const LogEntry *entries, int32_t day);
+
+
+    /// Insert the log reference into date ordered log references after all 
+    /// references with the same date
+    void __insertLogRef(Arena *p_arena, PlantLogRows *p_rows, const LogEntry *entries, uint32_t row);
+
+
+    /// Remove the log reference from date ordered log references, the day must be
+    /// the date of the entry at the time it was inserted
+    void __removeLogRef(PlantLogRows *p_rows, const LogEntry *entries, uint32_t row, int32_t day);
+
+
+    /// Append the date ordered log references in query date range, which match the
+    /// query predicate, to destination references
+    void __collectLogDateRange(PlantLogRows *p_src, ListQuery *p_query, PlantLogs *p_logs,
+        const RoaringBitmap *bms, PlantLogRefs *p_dst);
+
+
+    /// Find the upper bound of the amount of archived logs of the power plants in the
+    /// query date range
+    size_t __archivedLogBound(PlantData *plants, size_t plant_c, ListQuery *p_query);
+
+
+    /// Decode the archived logs of the power plant in query date range into the buffer and
+    /// append the references of the logs, which match the query predicate, to destination references
+    /// NOTE: The buffer must fit all logs counted by __archivedLogBound()
+    void __collectArchivedLogs(PlantData *p_plant, ListQuery *p_query, LogEntry *buf, size_t *p_buf_n,
+        PlantLogRefs *p_dst);
+
+
+    /// Count the archived logs of the power plant, which match the query predicate
+    size_t __countArchivedLogs(PlantData *p_plant, ListQuery *p_query);
+
+
+    /// Find the bitmap of all log rows that match the query predicate
+    /// Fully indexed predicates are answered with bitmap operations only, while other
+    /// predicates are evaluated over log columns in blocks, where comparisons on indexed
+    /// fields are read from their comparison bitmaps
+    void __matchingLogRows(PlantLogs *p_logs, ListQuery *p_query, RoaringBitmap *bms, 
+        bool is_indexed, RoaringBitmap *p_rows);
+
+
+    /// Display the log references in the query window and the aggregates of all
+    /// references if the query has a date range or a predicate
+    void __displayLogQuery(PlantLogRefs *p_refs, ListQuery *p_query);
+
+
+    /// Display a single row of estimated quantiles from the digest
+    void __displayQuantileRow(const char *label, TDigest *p_td, ListQuery *p_query);
+
 
+    /// Copy all logs of the power plant into a new array in date order, where archived
+    /// logs are decoded and merged with the live logs
+    /// Returns the amount of logs in the array
+    size_t __plantLogsByDate(PlantLogs *p_logs, PlantData *p_plant, LogEntry **p_out);
+
+
+    /// Structure for the window utilisation of a single power plant in rolling ranking
+    typedef struct __RollingRank {
+        float util;
+        float production;
+        PlantData *p_plant;
+    } __RollingRank;
+
+
+    #define __MAX_ROLLING_DAYS              3660
+
+
+    /// Group key and aggregate function names in display order of their enumeral values
+    static const char *__group_key_names[] = { "plant", "fuel", "month", "year", "weekday" };
+    static const char *__group_func_names[] = { "sum", "avg", "min", "max", "count" };
+    static const char *__weekday_names[] = { "monday", "tuesday", "wednesday", "thursday", 
+        "friday", "saturday", "sunday" };
+
+
+    /// Write the display label of the group key into the buffer
+    void __formatGroupKey(GroupKey key, uint32_t val, PowerPlants *p_plants, char *buf);
+
+
+    /// Find the count of rows that should be sorted to display the query window
+    /// Returns 0 if all rows must be sorted
+    size_t __queryRowCount(ListQuery *p_query, size_t n);
+
+
+    /// Write the log entry as a csv line into the file using the given buffer
+    void __writeLogLine(FILE *file, char *buf, LogEntry *p_ent);
 
-    /// Perform required sorting on logs according to the list sorting mode
-    void __sortLogs(PlantLogs *p_logs, ListSortMode smode);
 #endif
 
 
+/// Perform required sorting on logs according to the list sorting mode
+void __sortLogs(PlantLogs *p_logs, ListSortMode smode);
+
+
+/// Encode the log entry value that is sorted with given sort mode into order 
+/// preserving 32 bit unsigned integer
+uint32_t __sortLogKey(LogEntry *p_entry, ListSortMode smode);
+
+
 /// Print out help text
 void showHelp(bool is_sel);
 
 
 /// Ask information about the new power plant instance from the user
 /// and create a new instance
-void createNewPowerPlant(PowerPlants *p_plants, uint32_t *arg, Hashmap *p_map);
+void createNewPowerPlant(PowerPlants *p_plants, uint32_t *arg, IdMap *p_map);
 
 
-/// List all currently available power plants according to specified sort mode
-void listPowerPlants(PowerPlants *p_plants, ListSortMode smode);
+/// List all currently available power plants according to specified list query
+void listPowerPlants(PowerPlants *p_plants, ListQuery *p_query);
 
 
-/// List all written logs according to specified sort mode
-void listAllLogs(PlantLogs *p_logs, ListSortMode smode);
+/// List all written logs according to specified list query
+/// Date range queries are answered from the date ordered power plant log references
+/// Archived logs are decoded from the blocks that overlap the date range
+void listAllLogs(PowerPlants *p_plants, PlantLogs *p_logs, ListQuery *p_query);
 
 
 /// List all logs that belong to the power plant
-void listPowerPlantLogs(PlantData *plant, ListSortMode smode);
+void listPowerPlantLogs(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *plant, ListQuery *p_query);
+
+
+/// Count the logs that match the query predicate, if no power plant is given,
+/// logs of the whole fleet are counted
+/// Fully indexed predicates are counted from the cardinality of the combined bitmaps
+void countLogs(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *p_plant, ListQuery *p_query);
 
 
 /// Edit power plant properties
-void editPowerPlant(Hashmap *plant_map, uint32_t index);
+void editPowerPlant(PowerPlants *p_plants, IdMap *plant_map, uint32_t index);
 
 
 /// Create a new log for certain power plant instance
-void newLog(Hashmap *pow_map, Hashmap *log_map, PowerPlants *p_plants, 
+void newLog(IdMap *pow_map, IdMap *log_map, PowerPlants *p_plants, 
     PlantLogs *p_logs, uint32_t *arg, uint32_t sel_id);
 
 
 /// Edit the power plant log data
-void editLog(Hashmap *plant_map, Hashmap *log_map, uint32_t sel_id, uint32_t index);
+void editLog(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *plant_map, IdMap *log_map, 
+    uint32_t sel_id, uint32_t index);
 
 
 /// Delete a power plant entry
-void deletePowerPlant(PowerPlants *p_plants, Hashmap *plant_map, uint32_t index);
+void deletePowerPlant(PowerPlants *p_plants, IdMap *plant_map, uint32_t index);
 
 
 /// Delete a log entry
-void deleteLog(PlantLogs *p_logs, Hashmap *pow_map, Hashmap *log_map, uint32_t sel_id, uint32_t index);
+/// The row is tombstoned instead of shifting the following rows, and the logs are
+/// compacted once enough rows are deleted
+void deleteLog(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *pow_map, IdMap *log_map, 
+    uint32_t sel_id, uint32_t index);
+
+
+/// Remove all deleted log rows from the log array
+void compactLogArray(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *log_map);
+
+
+/// Move all logs older than the given amount of days before the latest log date
+/// into the compressed archives of their power plants
+void archiveOldLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *log_map, size_t days);
+
+
+/// Display live, peak and slack bytes of each subsystem
+/// Slack is found from the capacities of the long lived arrays, temporary
+/// listing, parser and sorting memory has no slack between commands
+void showMemoryUsage(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *pow_map, IdMap *log_map);
 
 
 /// Check if the user provided selection id is available for selection
-void selectionCheck(uint32_t *p_sel_val, uint32_t arg, Hashmap *p_map);
+void selectionCheck(uint32_t *p_sel_val, uint32_t arg, IdMap *p_map);
+
+
+/// Display fleet-wide statistics over all logs
+/// Live logs are reduced from log columns, while archived logs are decoded block by block
+void showLogStats(PowerPlants *p_plants, PlantLogs *p_logs);
+
+
+/// Display fleet-wide statistics grouped by power plant fuel type
+/// If thread_c is 0, the amount of threads is chosen automatically
+void showFuelStats(PowerPlants *p_plants, PlantLogs *p_logs, size_t thread_c);
+
+
+/// Display estimated quantiles of the log field for the given power plant, if no plant
+/// is given, quantiles for the whole fleet and each fuel type are displayed
+void showQuantiles(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *p_plant, ListQuery *p_query);
+
+
+/// Display the aggregate of the log field for each group of logs, where logs are
+/// grouped by the query group key and filtered by the query predicate
+void showGroupAggregates(PowerPlants *p_plants, PlantLogs *p_logs, ListQuery *p_query);
+
+
+/// Display the rolling utilisation of the power plant for each day, where
+/// utilisation is the production of the last given amount of days relative to
+/// the rated production of those days
+/// Days without logs count as days without production
+void showRolling(PlantLogs *p_logs, PlantData *p_plant, size_t days);
+
+
+/// Display power plants ranked by the increasing utilisation of the given amount
+/// of days up to the latest log date of the fleet
+void showRollingRanking(PowerPlants *p_plants, PlantLogs *p_logs, size_t days);
+
+
+/// Display monthly or yearly rollups for the given power plant, if no plant
+/// is given, rollups for all power plants are displayed
+void showRollup(PowerPlants *p_plants, PlantData *p_plant, ListQuery *p_query);
 
 
 /// Save all edited data into a file
 void saveData(PowerPlants *p_plants, PlantLogs *p_logs, char *plants_file,
     char *logs_file);
+
+
+/// Save all edited data into the data file in data store mode
+void syncStoreData(DataStore *p_store, PowerPlants *p_plants, PlantLogs *p_logs);
 #endif
@@ -8,74 +8,204 @@
 
 
 #ifndef __ALGO_H
+#define __ALGO_H
 
+#ifdef __ALGO_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdbool.h>
+    #include <stdint.h>
+    #include <string.h>
+    #include <math.h>
+#endif
 
 /// Specifies sort value type
 typedef enum SortValueType {
     SORT_VALUE_TYPE_UINT32      = 0,
     SORT_VALUE_TYPE_FLOAT32     = 1,
-    SORT_VALUE_TYPE_DATE        = 2
+    SORT_VALUE_TYPE_DATE        = 2,
+    SORT_VALUE_TYPE_PACKED128   = 3,
+    SORT_VALUE_TYPE_STRING      = 4
 } SortValueType;
 
 
-#ifdef __ALGO_C
-    #include <stdio.h>
-    #include <stdlib.h>
-    #include <stdbool.h>
-    #include <stdint.h>
-    #include <string.h>
+/// Order preserving composite sort key, where each 32 bit key field is packed
+/// into 128 bit integer starting from the most significant bits
+/// The key is compared as a single unsigned integer in increasing order
+/// Equal keys are ordered by their ordinal, so that the key order is a strict total
+/// order and partial sorts agree with full sorts
+typedef struct PackedSortKey {
+    uint64_t hi;
+    uint64_t lo;
+    uint64_t ord;
+    void *ref;
+} PackedSortKey;
+
 
+/// Maximum amount of 32 bit fields that fit into packed sort key
+#define PACKED_SORT_KEY_MAX_FIELDS      4
+
+
+#ifdef __ALGO_C
     #include <entity_data.h>
+    #include <date.h>
+    #include <mem_check.h>
+    #include <sketch.h>
+
+    /// Structure for describing the sorted values of the sorted array
+    typedef struct __SortCtx {
+        size_t val_offset;
+        size_t stride;
+        bool is_decr;
+        SortValueType val_type;
+        bool is_ref;
+    } __SortCtx;
+
+
+    /// Structure for describing a single natural run on the merge stack
+    /// Power specifies the depth of the merge tree node between this run and
+    /// the next run
+    typedef struct __MergeRun {
+        size_t beg;
+        size_t n;
+        uint32_t power;
+    } __MergeRun;
+
+
+    /// Check if the left element must be sorted strictly before the right element
+    bool __sortsBefore(__SortCtx *p_ctx, void *l, void *r);
+
+
+    /// Count the elements at the beginning of the sorted array that are sorted before
+    /// the key element, if is_incl is true the elements equal to key are also counted
+    /// The boundary is found with exponential search followed by binary search
+    size_t __gallop(__SortCtx *p_ctx, void *key, void *base, size_t n, bool is_incl);
+
+
+    /// Find the natural run starting from the beginning of the array and return
+    /// its length, strictly descending runs are reversed in place
+    size_t __findRun(__SortCtx *p_ctx, void *arr, size_t n);
+
+
+    /// Extend the sorted prefix of sorted_n elements to n elements with binary 
+    /// insertion sort
+    void __insertionSort(__SortCtx *p_ctx, void *arr, size_t sorted_n, size_t n);
 
-    /// Check if the data sorting should set for integer to destination buffe
-    void iswap(bool is_decr, uint32_t lval, uint32_t rval, void *dst, void *la, 
-        void *ra, size_t stride, size_t *p_i, size_t *p_j);
 
+    /// Find the minimum run length, that makes the run count close to, but not 
+    /// greater than a power of two
+    size_t __minRunLength(size_t n);
 
-    /// Check if the data sorting should set for floating point integer to 
-    /// destination buffe
-    void fswap(bool is_decr, float lval, float rval, void *dst, void *la, 
-        void *ra, size_t stride, size_t *p_i, size_t *p_j);
 
+    /// Find the merge tree node power between two adjacent runs in array of n elements
+    uint32_t __nodePower(size_t beg1, size_t n1, size_t n2, size_t n);
 
-    /// Check how the subarray element sorting should be done for sorting
-    /// float values
-    void __sortCheckf(bool is_decr, bool is_ref, void *dst, void *la, void *ra, size_t stride, 
-        size_t val_offset, size_t *p_i, size_t *p_j);
 
+    /// Merge the adjacent sorted runs arr[0, n1) and arr[n1, n1 + n2) with galloping
+    /// Scratch buffer must be able to hold n1 elements
+    void __mergeRuns(__SortCtx *p_ctx, void *arr, void *scratch, size_t n1, size_t n2);
 
-    /// Check how the subarray element sorting should be done for sorting
-    /// integer values
-    void __sortChecki(bool is_decr, bool is_ref, void *dst, void *la, void *ra, size_t stride, 
-        size_t val_offset, size_t *p_i, size_t *p_j);
 
-    
-    /// Check how the subarray element sorting should be done for sorting
-    /// by date
-    void __sortCheckDate(bool is_decr, bool is_ref, void *dst, void *la, void *ra, size_t stride,
-        size_t val_offset, size_t *p_i, size_t *p_j);
+    /// Find the rollup bucket for the given month, buckets are added as needed
+    PlantAggregates *__rollupBucket(PlantRollup *p_rollup, int32_t month);
 
 
-    /// Merge the subarrays in sorted order (using floating point values)
-    void __merge(void *arr, size_t val_offset, size_t stride, bool is_decr,
-        SortValueType use_float_cmp, bool is_ref, size_t end);
+    /// Add value to aggregates
+    void __aggregatesAdd(PlantAggregates *p_agg, LogEntry *p_entry);
 
 
-    #define __DEFAULT_BUF_SIZE          256
+    /// Remove value from aggregates
+    void __aggregatesRemove(PlantAggregates *p_agg, LogEntry *p_entry);
+
+
+    #define __MIN_GALLOP                7
+    #define __MAX_MERGE_STACK           128
+
+
+    /// Compare two sortable values
+    /// Returns negative value if the left value is smaller, positive value if the
+    /// left value is bigger and zero if the values are equal
+    int __sortValueCmp(void *l, void *r, size_t val_offset, SortValueType val_type, bool is_ref);
+
+
+    /// Swap two generic array elements with specified stride
+    void __swapElements(void *a, void *b, size_t stride);
+
+
+    /// Restore the heap property for the subtree starting at given root
+    void __siftDown(void *heap, size_t root, size_t n, size_t val_offset, size_t stride,
+        bool is_decr, SortValueType val_type, bool is_ref);
 #endif
 
 
-/// Perform merge sort on generic structure with specified stride and value
+/// Perform stable merge sort on generic structure with specified stride and value
 /// offset
+/// Natural ascending and descending runs are detected and merged, so already
+/// sorted and reversed data is sorted in linear time
 void mergesort(void *arr, size_t val_offset, size_t stride, bool is_decr,
     SortValueType type, bool is_ref, size_t beg, size_t end);
 
 
-/// Calculate the average utilisation for a power plant based on its daily logs
-void calcAvgUtilisation(PlantData *p_plant);
+/// Move the first k elements in sorting order to the beginning of the generic array
+/// and sort them using a bounded heap (O(n log k))
+/// NOTE: The order of the remaining n - k elements is unspecified
+void heapselect(void *arr, size_t val_offset, size_t stride, bool is_decr,
+    SortValueType type, bool is_ref, size_t n, size_t k);
+
+
+/// Sort the first k elements of the generic array, when k is zero or not smaller
+/// than the element count, the whole array is sorted with stable merge sort
+void partialsort(void *arr, size_t val_offset, size_t stride, bool is_decr,
+    SortValueType type, bool is_ref, size_t n, size_t k);
+
+
+/// Convert a sortable value into 32 bit unsigned integer, which preserves the
+/// sorting order of given value type when compared as unsigned integer
+/// If is_decr is true, the bits are inverted so that the order is reversed
+uint32_t encodeSortField(void *p_val, SortValueType type, bool is_decr);
+
+
+/// Set the 32 bit field with index field_i in the packed sort key
+void packSortKeyField(PackedSortKey *p_key, size_t field_i, uint32_t field);
+
+
+/// Find the amount of 32 bit key fields that the string of given length is 
+/// encoded into, including the null terminator
+size_t sortStringFieldCount(size_t len);
+
+
+/// Encode the 4 byte chunk with index field_i of the string into 32 bit order
+/// preserving key field
+/// Bytes are packed in big-endian order as unsigned values, so UTF-8 strings are
+/// collated by their byte order
+uint32_t encodeSortStringField(char *str, size_t len, size_t field_i, bool is_decr);
+
+
+/// Add value to the compensated sum
+void kahanAdd(KahanSum *p_sum, double val);
+
+
+/// Find the value of the compensated sum
+double kahanValue(KahanSum *p_sum);
+
+
+/// Add the log entry values to the running aggregates, monthly rollup and 
+/// quantile sketches of the power plant and update its averages
+void addLogAggregates(PlantData *p_plant, LogEntry *p_entry);
+
+
+/// Remove the log entry values from the running aggregates and monthly rollup
+/// of the power plant and update its averages
+/// Quantile sketches are marked stale, since values cannot be removed from them
+void removeLogAggregates(PlantData *p_plant, LogEntry *p_entry);
+
+
+/// Free all memory allocated for the rollup buckets
+void destroyPlantRollup(PlantRollup *p_rollup);
 
 
-/// Calculate the average cost for the power plant based on its daily logs
-void calcAvgCost(PlantData *p_plant);
+/// Calculate the average cost and utilisation for the power plant from its
+/// running log aggregates
+void calcPlantAverages(PlantData *p_plant);
 
 #endif
@@ -0,0 +1,64 @@
+/*
+ * File:        arena.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for region allocator, which is used for
+ *              power plant names and log row arrays
+ */
+
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#ifdef __ARENA_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+
+
+    /// Find the size class of the allocation size
+    static size_t __arenaSizeClass(size_t size);
+
+
+    /// Allocate a new block of the given size and link it to the arena
+    static uint8_t *__arenaNewBlock(Arena *p_arena, size_t size);
+
+
+    /// Split the unused tail of the bump block into free list allocations
+    static void __arenaRetireTail(Arena *p_arena);
+
+
+    #define __ARENA_MIN_ALLOC           16
+    #define __ARENA_BLOCK_SIZE          (1 << 16)
+#endif
+
+
+/// Allocate memory from the arena, the size is rounded up to its size class
+/// NOTE: The memory is not zeroed
+void *arenaAlloc(Arena *p_arena, size_t size);
+
+
+/// Return the allocation to the free list of its size class, the size must be
+/// the same as was used for allocating it
+void arenaFree(Arena *p_arena, void *ptr, size_t size);
+
+
+/// Resize the allocation, the contents are kept up to the smaller of the sizes
+/// Allocations that stay in the same size class are not moved
+void *arenaRealloc(Arena *p_arena, void *ptr, size_t old_size, size_t new_size);
+
+
+/// Copy the string into arena memory
+char *arenaStrdup(Arena *p_arena, const char *str);
+
+
+/// Release all memory of the arena at once
+void destroyArena(Arena *p_arena);
+
+#endif
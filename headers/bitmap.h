@@ -0,0 +1,182 @@
+/*
+ * File:        bitmap.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-11
+ * Last edit:   2021-06-11
+ * Description: Function declarations for roaring compressed bitmaps and bitmap
+ *              indexes built from them
+ */
+
+
+#ifndef __BITMAP_H
+#define __BITMAP_H
+
+#ifdef __BITMAP_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+
+
+    /// Maximum cardinality of array containers, bigger containers are stored as bitsets,
+    /// which take the same 8KB of memory as an array of this many values
+    #define __ROARING_ARRAY_MAX_C       4096
+    #define __ROARING_BITSET_WORD_C     1024
+
+
+    /// Find the index of the first container with key not smaller than the given key
+    static size_t __roaringLowerBound(const RoaringBitmap *p_bm, uint16_t key);
+
+
+    /// Find the container with the given key, NULL is returned if it does not exist
+    static RoaringContainer *__roaringFind(const RoaringBitmap *p_bm, uint16_t key);
+
+
+    /// Find the container with the given key, the container is created if it does not exist
+    static RoaringContainer *__roaringGet(RoaringBitmap *p_bm, uint16_t key);
+
+
+    /// Find the amount of bytes allocated for the container data
+    static size_t __containerSize(const RoaringContainer *p_cont);
+
+
+    /// Free the data of the container
+    static void __containerDestroy(RoaringContainer *p_cont);
+
+
+    /// Find the index of the first array container value not smaller than the given value
+    static size_t __arrayLowerBound(const uint16_t *vals, size_t n, uint16_t val);
+
+
+    /// Check if the container contains the value
+    static bool __containerContains(const RoaringContainer *p_cont, uint16_t val);
+
+
+    /// Convert the array container into bitset container
+    static void __containerToBitset(RoaringContainer *p_cont);
+
+
+    /// Convert the bitset container into array container if its cardinality allows it
+    static void __containerNormalize(RoaringContainer *p_cont);
+
+
+    /// Recalculate the cardinality of the bitset container from its words
+    static void __containerRecount(RoaringContainer *p_cont);
+
+
+    /// Add the value into the container
+    static void __containerAdd(RoaringContainer *p_cont, uint16_t val);
+
+
+    /// Remove the value from the container
+    /// Returns true if the value was in the container
+    static bool __containerRemove(RoaringContainer *p_cont, uint16_t val);
+
+
+    /// Copy the source container into uninitialised destination container
+    static void __containerCopy(RoaringContainer *p_dst, const RoaringContainer *p_src);
+
+
+    /// Perform union of the containers into the destination container
+    static void __containerOr(RoaringContainer *p_dst, const RoaringContainer *p_src);
+
+
+    /// Perform intersection of the containers into the destination container
+    static void __containerAnd(RoaringContainer *p_dst, const RoaringContainer *p_src);
+
+
+    /// Remove all values of the source container from the destination container
+    static void __containerAndNot(RoaringContainer *p_dst, const RoaringContainer *p_src);
+
+
+    /// Remove the empty containers from the bitmap
+    static void __roaringCompact(RoaringBitmap *p_bm);
+
+
+    /// Find the index of the first bitmap index entry with key not smaller than the given key
+    static size_t __bitmapIndexLowerBound(const BitmapIndex *p_idx, uint32_t key);
+#endif
+
+
+/// Add the value into the bitmap
+/// Values are appended in constant time when they are added in increasing order
+void roaringAdd(RoaringBitmap *p_bm, uint32_t val);
+
+
+/// Add all values in range [beg, end) into the bitmap
+void roaringAddRange(RoaringBitmap *p_bm, uint32_t beg, uint32_t end);
+
+
+/// Remove the value from the bitmap
+void roaringRemove(RoaringBitmap *p_bm, uint32_t val);
+
+
+/// Check if the bitmap contains the value
+bool roaringContains(const RoaringBitmap *p_bm, uint32_t val);
+
+
+/// Find the amount of values in the bitmap
+size_t roaringCardinality(const RoaringBitmap *p_bm);
+
+
+/// Find the 64 bits of the bitmap starting from the given value, which must be
+/// a multiple of 64, where bit i is set if the bitmap contains value beg + i
+uint64_t roaringWord(const RoaringBitmap *p_bm, uint32_t beg);
+
+
+/// Write all values of the bitmap in increasing order into the output array
+/// Returns the amount of values written
+size_t roaringToArray(const RoaringBitmap *p_bm, uint32_t *out);
+
+
+/// Copy the source bitmap into the destination bitmap, previous destination values
+/// are discarded
+void roaringCopy(RoaringBitmap *p_dst, const RoaringBitmap *p_src);
+
+
+/// Add all values of the source bitmap into the destination bitmap
+void roaringOr(RoaringBitmap *p_dst, const RoaringBitmap *p_src);
+
+
+/// Keep only the destination bitmap values that are also in the source bitmap
+void roaringAnd(RoaringBitmap *p_dst, const RoaringBitmap *p_src);
+
+
+/// Remove all values of the source bitmap from the destination bitmap
+void roaringAndNot(RoaringBitmap *p_dst, const RoaringBitmap *p_src);
+
+
+/// Free all memory allocated for the bitmap
+void destroyRoaring(RoaringBitmap *p_bm);
+
+
+/// Find the amount of allocated bytes in the bitmap that are not used by its values
+size_t roaringSlack(const RoaringBitmap *p_bm);
+
+
+/// Find the bitmap of rows with the given key, NULL is returned if the key
+/// is not in the index
+RoaringBitmap *bitmapIndexFind(BitmapIndex *p_idx, uint32_t key);
+
+
+/// Add the row under the given key into the bitmap index
+void bitmapIndexAdd(BitmapIndex *p_idx, uint32_t key, uint32_t row);
+
+
+/// Remove the row under the given key from the bitmap index, keys without
+/// rows are removed from the index
+void bitmapIndexRemove(BitmapIndex *p_idx, uint32_t key, uint32_t row);
+
+
+/// Find the amount of allocated bytes in the bitmap index that are not used by its rows
+size_t bitmapIndexSlack(const BitmapIndex *p_idx);
+
+
+/// Free all memory allocated for the bitmap index
+void destroyBitmapIndex(BitmapIndex *p_idx);
+
+#endif
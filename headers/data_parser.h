@@ -18,8 +18,10 @@
     #include <stdint.h>
 
     #include <entity_data.h>
+    #include <date.h>
     #include <mem_check.h>
     #include <err_def.h>
+    #include <arena.h>
 
     #define __DEFAULT_POWER_PLANT_CAP       16
     #define __DEFAULT_LOG_CAP               32
@@ -66,7 +68,8 @@ typedef struct CsvRow {
 
 
     /// Parse all CSV rows and check if the csv table has constant amount of columns
-    static void __parseCSVRows(char *buf, size_t buf_len, char *file_name, CsvRow **p_rows, size_t *p_row_c);
+    static void __parseCSVRows(char *buf, size_t buf_len, char *file_name, CsvRow **p_rows, size_t *p_row_c,
+        size_t *p_row_cap);
 
 
     /// Check the current entry and return integer when possible
@@ -78,15 +81,23 @@ typedef struct CsvRow {
 
 
     /// Check the current entry for string value and return it, when possible
-    static char *__csvEntryRetrieveString(CsvEntry *p_entry);
+    static char *__csvEntryRetrieveString(CsvEntry *p_entry, Arena *p_arena);
 
 
     /// Check the entry for string and try to parse fuel type out of it
     static FuelType __csvCheckFuelType(CsvEntry *p_entry);
 
 
-    /// Check the entry for string date format and try to parse it into Date structure
-    static Date __csvCheckDateType(char *file_name, CsvEntry *p_entry);
+    /// Check the entry for string date format and try to parse it into epoch day
+    static int32_t __csvCheckDateType(char *file_name, CsvEntry *p_entry);
+
+
+    /// Verify the log CSV row data types and set the values into LogEntry
+    static void __csvRowToLogEntry(char *file_name, CsvRow *p_row, LogEntry *p_entry);
+
+
+    /// Free all memory allocated for CSV row entries
+    static void __freeCSVRow(CsvRow *p_row);
 #endif
 
 
@@ -97,4 +108,10 @@ void parsePowerPlantFile(char *file_name, PowerPlants *p_plants);
 /// High level function to parse all logs from the csv logs file
 void parseLogsFile(char *file_name, PlantLogs *p_logs);
 
+
+/// Parse a single log CSV line into LogEntry structure
+/// The line is given by its beginning and end pointers, where end points to
+/// the line terminator or to the end of the buffer
+void parseLogLine(char *beg, char *end, char *file_name, uint32_t line, LogEntry *p_entry);
+
 #endif
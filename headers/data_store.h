@@ -0,0 +1,170 @@
+/*
+ * File:        data_store.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for keeping power plants and logs in a
+ *              memory mapped data file
+ */
+
+
+#ifndef __DATA_STORE_H
+#define __DATA_STORE_H
+
+#ifdef __DATA_STORE_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+    #include <time.h>
+    #include <errno.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+
+    #include <entity_data.h>
+    #include <err_def.h>
+    #include <mem_check.h>
+    #include <id_map.h>
+    #include <arena.h>
+    #include <bitmap.h>
+    #include <algo.h>
+    #include <log_archive.h>
+
+
+    /// Fixed header at the start of the data file
+    /// All offsets are relative to the start of the file, so that the file can be
+    /// mapped at any address
+    /// The log section is followed by the tail, which holds the power plant, name and
+    /// archive sections in this order
+    typedef struct __StoreHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t header_size;
+        uint64_t log_off;
+        uint64_t log_n;
+        uint64_t log_cap;
+        uint64_t plant_off;
+        uint64_t plant_n;
+        uint64_t name_off;
+        uint64_t name_size;
+        uint64_t archive_off;
+        uint64_t archive_size;
+        uint64_t plant_max_id;
+        uint64_t log_max_id;
+        int64_t sync_time;          // seconds since 1970-01-01
+    } __StoreHeader;
+
+
+    /// Power plant record of the data file, name and archive offsets are relative
+    /// to the start of their sections
+    typedef struct __StorePlant {
+        uint32_t no;
+        uint32_t fuel;
+        float rated_cap;
+        uint32_t block_c;
+        uint64_t name_off;
+        uint64_t archive_off;
+        uint32_t name_len;
+        uint32_t reserved;
+    } __StorePlant;
+
+
+    /// Archive block record of the data file, the block data follows the record
+    /// and is padded to the section alignment
+    typedef struct __StoreBlock {
+        uint64_t size;
+        uint32_t n;
+        int32_t first_date;
+        int32_t last_date;
+        uint32_t reserved;
+    } __StoreBlock;
+
+
+    /// Round the size up to the section alignment
+    static size_t __alignStore(size_t size);
+
+
+    /// Resize the data file and map all of it again
+    /// NOTE: Pointers into the previous mapping are invalid afterwards
+    static void __mapDataStore(DataStore *p_store, size_t size);
+
+
+    /// Change the capacity of the log section, the tail is moved to follow the log section
+    static void __resizeStoreLogs(DataStore *p_store, PlantLogs *p_logs, size_t cap);
+
+
+    /// Check that the header and all sections of the data file are within the file
+    static void __validateDataStore(const DataStore *p_store, const char *file_name);
+
+
+    /// Load power plants, their names and archives from the tail of the data file
+    static void __loadStorePlants(const DataStore *p_store, const char *file_name, PowerPlants *p_plants);
+
+
+    /// Remove the log rows, which were deleted or belong to deleted power plants after
+    /// the last sync, by moving the following rows back
+    /// Returns the amount of removed rows
+    static size_t __dropDeadStoreRows(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs);
+
+
+    #define __STORE_MAGIC                   "EMSTORE"
+    #define __STORE_VERSION                 1
+    // Header takes a whole page, so that the log section is page aligned
+    #define __STORE_HEADER_SIZE             4096
+    #define __STORE_PAGE_SIZE               4096
+    #define __STORE_ALIGNMENT               8
+    #define __STORE_MIN_LOG_CAP             1024
+#endif
+
+
+/// Amount of seconds after which changed log rows are flushed to the data file
+#define DATA_STORE_SYNC_INTERVAL            30
+
+
+/// Open the data file and map its log rows into log entries, power plants and their
+/// archives are loaded into memory
+/// Logs are not associated with their power plants yet
+/// NOTE: Rows that were deleted after the last sync have DEAD_LOG_ID as their log id
+/// and they are removed
+void openDataStore(DataStore *p_store, const char *file_name, PowerPlants *p_plants, PlantLogs *p_logs);
+
+
+/// Create a new data file from the loaded power plants and logs, afterwards the log
+/// entries are mapped from the data file
+void createDataStore(DataStore *p_store, const char *file_name, PowerPlants *p_plants, PlantLogs *p_logs);
+
+
+/// Allocate a new log row at the end of the mapped log section, which is grown if needed
+/// The new row is marked as deleted until it is written, and the row count in the data
+/// file is updated
+uint32_t allocStoreLogRow(DataStore *p_store, PlantLogs *p_logs);
+
+
+/// Release the unused log section capacity after the log rows were compacted
+void fitStoreLogs(DataStore *p_store, PlantLogs *p_logs);
+
+
+/// Copy reordered log entries over the mapped log rows, only the pages that
+/// differ are written, so that unchanged pages are not written back to the file
+void writeStoreLogs(PlantLogs *p_logs, const LogEntry *entries);
+
+
+/// Write power plants and archives into the data file and flush all changes
+void syncDataStore(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs);
+
+
+/// Flush changed log rows and the row count into the data file
+void flushDataStore(DataStore *p_store, const PlantLogs *p_logs);
+
+
+/// Check if the changed log rows should be flushed
+bool isDataStoreSyncDue(const DataStore *p_store);
+
+
+/// Sync the data store and unmap the data file
+void closeDataStore(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs);
+
+#endif
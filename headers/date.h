@@ -0,0 +1,46 @@
+/*
+ * File:        date.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-03
+ * Last edit:   2021-06-03
+ * Description: Function declarations for converting between civil dates and
+ *              epoch days (days since 1970-01-01)
+ */
+
+
+#ifndef __DATE_H
+#define __DATE_H
+
+#ifdef __DATE_C
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+
+    #include <entity_data.h>
+
+    /// Check if the given year is a leap year
+    static bool __isLeapYear(int32_t year);
+#endif
+
+
+/// Convert civil date into days since 1970-01-01
+int32_t dateToEpochDay(Date date);
+
+
+/// Convert days since 1970-01-01 into civil date
+Date epochDayToDate(int32_t day);
+
+
+/// Convert days since 1970-01-01 into months since 1970-01
+int32_t epochDayToMonth(int32_t day);
+
+
+/// Find the amount of days in the given month
+uint16_t daysInMonth(int32_t year, uint16_t month);
+
+
+/// Parse date string in yyyy-mm-dd format directly into days since 1970-01-01
+/// Returns false if the string is not a valid date
+bool parseDate(const char *str, size_t len, int32_t *p_day);
+
+#endif
@@ -17,6 +17,7 @@
     #include <stdbool.h>
     #include <stdlib.h>
     #include <stdint.h>
+    #include <stddef.h>
 
     #include <hashmap.h>
     #include <entity_data.h>
@@ -25,48 +26,81 @@
     #include <mem_check.h>
     #include <err_def.h>
     #include <prompt.h>
+    #include <indexes.h>
+    #include <id_map.h>
+    #include <arena.h>
+    #include <log_slab.h>
+    #include <data_store.h>
 
     #define __DEFAULT_POWER_PLANT_LOG_C     16
     #define __FUEL_TYPE_STR_MAX_LEN         32
 #endif
 
-/// Create a new hashmap instance for power plants
-Hashmap createPowerPlantMap(PowerPlants *p_power_plants);
+/// Create a new id map instance for power plants
+IdMap createPowerPlantMap(PowerPlants *p_power_plants);
 
 
-/// Create a new hashmap instance for daily logs
-Hashmap createLogMap(PlantLogs *p_logs);
+/// Create a new id map instance for daily logs
+IdMap createLogMap(PlantLogs *p_logs);
 
 
-/// Associate file read log data with its power plant instances
-void associateLogData(PowerPlants *p_power_plants, PlantLogs *p_logs, Hashmap *p_map);
+/// Find the power plant with the given number, NULL is returned if it does not exist
+/// NOTE: The returned pointer is valid until the power plant array is modified
+PlantData *findPowerPlant(PowerPlants *p_plants, IdMap *p_map, uint32_t no);
+
+
+/// Find the log with the given id, NULL is returned if it does not exist
+/// NOTE: The returned pointer is valid until the log array is modified
+LogEntry *findLog(PlantLogs *p_logs, IdMap *p_map, uint32_t id);
+
+
+/// Make room for at least req_n log rows of the power plant, the rows are
+/// allocated from the power plant arena
+void reservePlantLogRows(Arena *p_arena, PlantLogRows *p_rows, size_t req_n);
+
+
+/// Free the log rows of the power plant, slices of the shared row buffer are
+/// released with the arena
+void freePlantLogRows(Arena *p_arena, PlantLogRows *p_rows);
+
+
+/// Associate file read log data with its power plant instances and build the
+/// bitmap indexes
+/// Logs are reordered with a counting sort on their power plant, so that the logs
+/// of each power plant occupy a single date ordered range of the log array, and the
+/// rows of each power plant are a slice of one shared row buffer
+void associateLogData(PowerPlants *p_power_plants, PlantLogs *p_logs, IdMap *pow_map, 
+    IdMap *log_map);
 
 
 /// Overwrite existing power plant data instance value with given value
-/// NOTE: The given plant id has to be a valid key to value in hashmap, otherwise 
+/// NOTE: The given plant id has to be a valid key to value in id map, otherwise 
 /// an error will be thrown
-void overwritePlantData(PlantData *p_data, Hashmap *p_map);
+void overwritePlantData(PlantData *p_data, PowerPlants *p_plants, IdMap *p_map);
 
 
 /// Create a new power plant instance and push it to map
-void newPowerPlant(PlantData *p_data, PowerPlants *p_plants, Hashmap *p_map);
+/// The map holds row indices, so reallocating the power plant array needs no fix-up
+void newPowerPlant(PlantData *p_data, PowerPlants *p_plants, IdMap *p_map);
 
 
-/// Create a new power plant log entry for specific power plant
-void newPowerPlantLog(LogEntry *entry, PlantLogs *p_logs, Hashmap *p_map);
+/// Create a new power plant log entry in a deleted row or at the end of the log array
+/// The map holds row indices, so reallocating the log array needs no fix-up
+/// Returns the row of the new log entry
+uint32_t newPowerPlantLog(LogEntry *entry, PlantLogs *p_logs, IdMap *p_map);
 
 
 /// Handle duplicate power plant values according to the specified duplicate handling action
-/// mdup is the duplicate entry that exists in the map
-/// udup is the duplicate value that would be pushed to the map
-void handleDuplicatePowerPlantEntries(DuplicateEntryAction action, Hashmap *p_map,
-    PowerPlants *p_plants, PlantData *mdup, PlantData *udup, uint32_t key);
+/// mdup_row is the row of the duplicate entry that exists in the map
+/// udup_row is the row of the duplicate entry that would be mapped
+void handleDuplicatePowerPlantEntries(DuplicateEntryAction action, IdMap *p_map,
+    PowerPlants *p_plants, size_t mdup_row, size_t udup_row);
 
 
 /// Handle duplicate log values according to the specified duplicate handling action
-/// mdup is the duplicate entry that exists in the map
-/// udup is the duplicate value that would be pushed to the map
-void handleDuplicateLogEntries(DuplicateEntryAction action, Hashmap *p_map,
-    PlantLogs *p_logs, LogEntry *mdup, LogEntry *udup, uint32_t key);
+/// mdup_row is the row of the duplicate entry that exists in the map
+/// udup_row is the row of the duplicate entry that would be mapped
+void handleDuplicateLogEntries(DuplicateEntryAction action, IdMap *p_map,
+    PlantLogs *p_logs, size_t mdup_row, size_t udup_row);
 
 #endif
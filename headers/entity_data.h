@@ -32,27 +32,168 @@ typedef struct Date {
 
 
 /// Structure for containing log information about single day
+/// All fields are 4 bytes wide, so entries are packed without any padding
 typedef struct LogEntry {
     uint32_t log_id;
     uint32_t plant_no;
     float production;
     float avg_sale_price;
-    size_t ref_ind;
-    Date date;
+    int32_t date;               // days since 1970-01-01
 } LogEntry;
 
+_Static_assert(sizeof(LogEntry) == 20, "LogEntry must not contain padding");
+_Static_assert(_Alignof(LogEntry) == 4, "LogEntry must be 4 byte aligned");
+
+
+/// Log id of deleted log rows, which is never given to a log
+#define DEAD_LOG_ID                         UINT32_MAX
+
+
+/// Structure for containing log data in columnar layout, where each field
+/// is stored in its own 32 byte aligned array
+typedef struct LogColumns {
+    uint32_t *log_id;
+    uint32_t *plant_no;
+    float *production;
+    float *avg_sale_price;
+    int32_t *date;
+    size_t n;
+    size_t cap;
+} LogColumns;
+
+
+/// Structure for a single roaring bitmap container, which holds the low 16 bits
+/// of all values with the same high 16 bits
+/// Sparse containers keep the values in a sorted array, while dense containers
+/// keep a bitset of all 65536 possible values
+typedef struct RoaringContainer {
+    void *data;         // sorted uint16_t values or uint64_t bitset words
+    uint32_t n;         // cardinality
+    uint32_t cap;       // array capacity, unused for bitsets
+    uint16_t key;       // high 16 bits of the values
+    bool is_bitset;
+} RoaringContainer;
+
+
+/// Structure for compressed bitmap of 32 bit values, where containers are
+/// kept in increasing key order
+typedef struct RoaringBitmap {
+    RoaringContainer *conts;
+    size_t n;
+    size_t cap;
+} RoaringBitmap;
+
+
+/// Structure for a single bitmap index key and the bitmap of rows with that key
+typedef struct BitmapIndexEntry {
+    uint32_t key;
+    RoaringBitmap rows;
+} BitmapIndexEntry;
+
+
+/// Structure for bitmap index, which maps each key to the bitmap of row indices
+/// with that key, entries are kept in increasing key order
+typedef struct BitmapIndex {
+    BitmapIndexEntry *entries;
+    size_t n;
+    size_t cap;
+} BitmapIndex;
+
+
+/// Structure for a single id map slot, empty slots have the row ID_MAP_NONE
+typedef struct IdMapSlot {
+    uint32_t id;
+    uint32_t row;
+} IdMapSlot;
+
+
+/// Structure for hash map from 32 bit entity ids to their row indices with open
+/// addressing and linear probing, the capacity is always a power of two
+typedef struct IdMap {
+    IdMapSlot *slots;
+    size_t n;
+    size_t cap;
+} IdMap;
+
+
+/// Structure for the deleted rows of the log array, deleted rows have their bit set
+/// and are kept in the free list until they are reused by new logs or compacted away
+typedef struct LogTombstones {
+    uint64_t *bits;
+    size_t word_c;
+    uint32_t *free_rows;
+    size_t n;
+    size_t cap;
+} LogTombstones;
+
+
+/// Structure for a memory mapped data file, where log rows are used in place
+/// and power plants and archives are written into the file on sync
+typedef struct DataStore {
+    int fd;
+    uint8_t *map;
+    size_t size;                // file size in bytes
+    int64_t last_sync;          // seconds since 1970-01-01
+} DataStore;
+
 
 /// Structure for containing multiple daily log instances
+/// Columns are optional and if present, contain the same rows as entries
+/// Data store is optional and if present, entries are mapped from its file
+/// Bitmap indexes map plant numbers and log months to entry row indices
+/// Deleted rows stay in entries and columns as tombstones, but not in indexes
+/// Ids of archived logs are kept apart from the id map, so that they are not reused
 typedef struct PlantLogs {
     LogEntry *entries;
+    LogColumns *cols;
+    DataStore *store;
+    BitmapIndex plant_idx;
+    BitmapIndex month_idx;
+    LogTombstones tombs;
+    RoaringBitmap archived_ids;
     size_t max_id;
     size_t n;
     size_t cap;
 } PlantLogs;
 
 
-/// Structure for containing multiple log references accessed from
-/// PlantData structure
+/// Structure for containing the row indices of all logs of a power plant, which
+/// stay valid when the log array is reallocated
+/// Rows of loaded logs are a slice of one buffer shared by all power plants, which
+/// is moved into its own allocation when it needs to grow
+typedef struct PlantLogRows {
+    uint32_t *rows;
+    size_t n;
+    size_t cap;
+    bool is_slice;
+} PlantLogRows;
+
+
+/// Structure for a block of archived logs of a power plant, which are compressed
+/// into a single bit stream in date order
+/// Log ids and dates are delta-of-delta encoded, while production and sale price
+/// are XOR encoded against the previous value of the same field
+typedef struct ArchiveBlock {
+    uint8_t *data;
+    size_t size;        // bytes, including zero padding after the bit stream
+    uint32_t n;
+    int32_t first_date; // days since 1970-01-01
+    int32_t last_date;
+} ArchiveBlock;
+
+
+/// Structure for the archived logs of a power plant, blocks are kept in date order
+/// and do not overlap, except for logs with the same date
+typedef struct PlantArchive {
+    ArchiveBlock *blocks;
+    size_t n;
+    size_t cap;
+    size_t log_c;
+} PlantArchive;
+
+
+/// Structure for containing multiple log references, which are used for
+/// temporary views of logs
 typedef struct PlantLogRefs {
     LogEntry **p_entries;
     size_t n;
@@ -60,6 +201,63 @@ typedef struct PlantLogRefs {
 } PlantLogRefs;
 
 
+/// Structure for compensated running sum, where the low order bits lost
+/// in each addition are accumulated into a separate compensation term
+typedef struct KahanSum {
+    double sum;
+    double comp;
+} KahanSum;
+
+
+/// Structure for running aggregates over all logs of a power plant
+typedef struct PlantAggregates {
+    KahanSum production;    // MWh
+    KahanSum sale_price;
+    size_t n;
+} PlantAggregates;
+
+
+/// Structure for per month log aggregates of a power plant
+/// Buckets are stored densely, starting from the first logged month
+typedef struct PlantRollup {
+    PlantAggregates *months;
+    int32_t first_month;    // months since 1970-01
+    size_t n;
+    size_t cap;
+} PlantRollup;
+
+
+/// Structure for a single t-digest centroid, which summarises the given weight
+/// of values around the mean
+typedef struct TDigestCentroid {
+    float mean;
+    float weight;
+} TDigestCentroid;
+
+
+/// Structure for mergeable t-digest quantile sketch with bounded memory
+/// Compressed centroids are kept sorted by mean and new values are buffered
+/// after them until the buffer is full and compressed into centroids
+typedef struct TDigest {
+    TDigestCentroid *centroids;
+    size_t n;           // compressed centroid count
+    size_t buf_n;       // buffered centroid count after compressed centroids
+    double weight;
+    float min;
+    float max;
+} TDigest;
+
+
+/// Structure for quantile sketches over all logs of a power plant
+/// Sketches cannot remove values, so they are marked stale on log removal
+/// and rebuilt from the plant logs when queried
+typedef struct PlantSketches {
+    TDigest production;
+    TDigest sale_price;
+    bool is_stale;
+} PlantSketches;
+
+
 /// Structure for containing all power plant related information 
 typedef struct PlantData {
     uint32_t no;
@@ -68,13 +266,45 @@ typedef struct PlantData {
     float rated_cap; // MW
     float avg_cost;
     float avg_utilisation;
-    PlantLogRefs logs;
+    PlantAggregates agg;
+    PlantRollup rollup;
+    PlantSketches sketch;
+    PlantLogRows logs;          // date ordered
+    PlantArchive archive;       // logs older than the live logs
 } PlantData;
 
 
+/// Header of a chunk of arena memory, the allocations follow the header
+typedef struct ArenaBlock {
+    struct ArenaBlock *next;
+    size_t size;
+} ArenaBlock;
+
+
+/// Amount of power of two size classes in the arena, starting from 16 bytes
+#define ARENA_SIZE_CLASS_C                  32
+
+
+/// Structure for region allocator, where allocations are bumped from blocks and
+/// freed allocations are reused from per size class free lists
+/// All memory is released at once when the arena is destroyed
+typedef struct Arena {
+    ArenaBlock *blocks;
+    uint8_t *cur;
+    uint8_t *end;
+    void *free_lists[ARENA_SIZE_CLASS_C];
+    size_t reserved;        // bytes in blocks
+    size_t used;            // bytes in live allocations
+} Arena;
+
+
 /// Structure for containing all power plant instances
+/// Bitmap index maps fuel types to power plant row indices
+/// Power plant names and log rows are allocated from the arena
 typedef struct PowerPlants {
     PlantData *plants;
+    BitmapIndex fuel_idx;
+    Arena arena;
     size_t max_id;
     size_t cap;
     size_t n;
@@ -21,6 +21,9 @@
 #define FWRITE_ERR(file_name)                       fprintf(stderr, "Failed to write into file: %s\n", file_name), \
                                                     exit(EXIT_FAILURE)
 
+#define INVALID_STORE_ERR(file_name)                fprintf(stderr, "Invalid or corrupted data store file: %s\n", file_name), \
+                                                    exit(EXIT_FAILURE)
+
 
 /// Line parsing error macros
 #define LINE_LENGTH_ERR(file, lc)                   fprintf(stderr, "Error, too long line in file %s, line %d\n", file, lc), \
@@ -0,0 +1,106 @@
+/*
+ * File:        ext_sort.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-02
+ * Last edit:   2021-06-02
+ * Description: Function declarations for sorting log files that do not fit into memory
+ */
+
+
+#ifndef __EXT_SORT_H
+#define __EXT_SORT_H
+
+#ifdef __EXT_SORT_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <err_def.h>
+    #include <hashmap.h>
+    #include <entity_data.h>
+    #include <algo.h>
+    #include <act_impl.h>
+    #include <prompt.h>
+    #include <data_parser.h>
+    #include <mem_check.h>
+    #include <predicate.h>
+
+
+    /// Structure for containing information about a single sorted run that
+    /// is spilled into temporary file
+    typedef struct __SortRun {
+        size_t beg;         // index of the first run entry in the spill file
+        size_t n;           // total amount of entries in the run
+        size_t read_n;      // amount of entries read from the spill file
+        LogEntry *buf;
+        size_t buf_n;
+        size_t buf_i;
+    } __SortRun;
+
+
+    /// Loser tree structure for k-way merging sorted runs
+    /// nodes[0] contains the index of the current winner run and nodes[1..k - 1]
+    /// contain the losers of each match
+    typedef struct __LoserTree {
+        size_t *nodes;
+        uint32_t *keys;
+        bool *is_done;
+        size_t k;
+    } __LoserTree;
+
+
+    /// Check if run a should be merged before run b
+    static bool __runBeats(__LoserTree *p_tree, size_t a, size_t b);
+
+
+    /// Build the loser tree subtree and return its winner run index
+    static size_t __buildLoserTree(__LoserTree *p_tree, size_t node);
+
+
+    /// Replay the matches from the leaf of given run to the root
+    static void __replayLoserTree(__LoserTree *p_tree, size_t run);
+
+
+    /// Read the next buffered entries of a run from the spill file
+    /// Returns false if the run is exhausted
+    static bool __refillRun(FILE *spill, __SortRun *p_run, size_t buf_cap);
+
+
+    /// Write a single log entry as CSV line into the output stream
+    static void __writeSortedLogLine(FILE *file, LogEntry *p_entry);
+
+
+    /// Sort the in-memory run and write it into the spill file
+    static void __spillRun(FILE *spill, PlantLogs *p_run, ListSortMode smode, __SortRun *p_info);
+
+
+    /// Merge the sorted runs of the spill file with a loser tree in the given memory budget
+    /// If is_csv is true, the merged entries after skip entries are written into out as CSV
+    /// lines until left entries are written, otherwise all entries are appended into out
+    /// as a single run
+    static void __mergeRuns(FILE *spill, __SortRun *runs, size_t run_c, ListSortMode smode,
+        size_t mem_budget, FILE *out, bool is_csv, size_t skip, size_t left);
+
+
+    #define __MIN_SORT_MEM_BUDGET           (1 << 20)
+    // Runs are merged in multiple passes if each run would get a smaller buffer
+    #define __MIN_RUN_BUF_C                 64
+    #define __OUT_STREAM_BUF_SIZE           (1 << 16)
+    #define __MAX_LOG_LINE_SIZE             4096
+#endif
+
+
+/// Default memory budget for sorting in bytes
+#define DEFAULT_SORT_MEM_BUDGET             ((size_t) 64 << 20)
+
+
+/// Sort the logs CSV file into output CSV file in bounded amount of memory
+/// Input is streamed into sorted runs that are spilled into a temporary file and then
+/// k-way merged with a loser tree, in multiple passes if there are too many runs to fit
+/// their buffers into the memory budget. Only the first sort mode of the query is used,
+/// but the query offset, limit and where clause are respected
+void sortLogsFile(char *in_file, char *out_file, ListQuery *p_query, size_t mem_budget);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+ * File:        fleet_stats.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-07
+ * Last edit:   2021-06-07
+ * Description: Function declarations for computing fleet-wide statistics grouped by
+ *              power plant fuel type in a parallel reduction
+ */
+
+
+#ifndef __FLEET_STATS_H
+#define __FLEET_STATS_H
+
+#ifdef __FLEET_STATS_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <pthread.h>
+
+    #include <entity_data.h>
+#endif
+
+
+/// Amount of FuelType enumeral values, used as the size of per fuel tables
+#define FUEL_TYPE_C                 (FUEL_TYPE_GEOTHERMAL + 1)
+
+
+/// Structure for accumulated statistics of all power plants using the same fuel
+typedef struct FuelStats {
+    size_t plant_c;
+    double rated_cap;       // MW
+    KahanSum production;    // MWh
+    KahanSum sale_price;
+    KahanSum rated_prod;    // MWh, rated production over all logged days
+    size_t log_c;
+} FuelStats;
+
+
+#ifdef __FLEET_STATS_C
+    #include <algo.h>
+    #include <log_archive.h>
+
+
+    /// Structure for per plant values that are looked up for each log, indexed
+    /// by power plant number
+    typedef struct __PlantFuelInfo {
+        float day_cap;      // MWh
+        uint8_t fuel;
+        bool is_valid;
+    } __PlantFuelInfo;
+
+
+    /// Structure for the log range and partial accumulators of a single reduction thread
+    /// Each thread writes only into its own accumulators, which are padded to
+    /// separate cache lines
+    typedef struct __FuelStatsTask {
+        const PlantLogs *p_logs;
+        const __PlantFuelInfo *infos;
+        size_t info_c;
+        size_t *plant_log_c;    // amount of logs per power plant number
+        size_t beg;
+        size_t end;
+        FuelStats partial[FUEL_TYPE_C];
+    } __attribute__((aligned(64))) __FuelStatsTask;
+
+
+    /// Accumulate the task's log range into its partial per fuel statistics
+    static void *__reduceFuelStatsTask(void *p_arg);
+
+
+    /// Find the amount of threads to use for reducing n logs
+    static size_t __fuelStatsThreadCount(size_t n, size_t req_c);
+
+
+    #define __MAX_FUEL_STATS_THREAD_C       64
+    #define __MIN_FUEL_STATS_TASK_SIZE      (1 << 16)
+#endif
+
+
+/// Compute statistics per fuel type over all power plants and logs
+/// Logs are split into contiguous ranges, each reduced by its own thread into partial
+/// per fuel accumulators, which are combined at the end. If thread_c is 0, the amount
+/// of threads is chosen from the available cores and the amount of live logs
+/// Archived logs are decoded and reduced by the calling thread
+/// Returns the amount of threads that were used
+size_t calcFuelStats(PowerPlants *p_plants, PlantLogs *p_logs, size_t thread_c,
+    FuelStats stats[FUEL_TYPE_C]);
+
+#endif
@@ -0,0 +1,134 @@
+/*
+ * File:        group_by.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for grouping logs by a key and aggregating
+ *              their values in a parallel hash aggregation
+ */
+
+
+#ifndef __GROUP_BY_H
+#define __GROUP_BY_H
+
+#ifdef __GROUP_BY_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+    #include <unistd.h>
+    #include <pthread.h>
+
+    #include <hashmap.h>
+    #include <entity_data.h>
+    #include <act_impl.h>
+    #include <bitmap.h>
+    #include <indexes.h>
+    #include <date.h>
+    #include <algo.h>
+    #include <fleet_stats.h>
+    #include <predicate.h>
+    #include <log_archive.h>
+#endif
+
+
+/// Structure for the aggregated values of all logs with the same group key
+typedef struct GroupAggregate {
+    uint32_t key;
+    float min;
+    float max;
+    KahanSum sum;
+    size_t n;           // 0 marks an empty hash table slot
+} GroupAggregate;
+
+
+/// Structure for hash table of group aggregates with open addressing and linear
+/// probing, the capacity is always a power of two
+typedef struct GroupTable {
+    GroupAggregate *slots;
+    size_t n;
+    size_t cap;
+} GroupTable;
+
+
+#ifdef __GROUP_BY_C
+    /// Structure for per plant values that are looked up for each log, indexed
+    /// by power plant number
+    typedef struct __GroupPlantInfo {
+        uint8_t fuel;
+        bool is_valid;
+    } __GroupPlantInfo;
+
+
+    /// Structure for the log range and partial hash table of a single aggregation thread
+    /// Each thread writes only into its own table, which is padded to a separate cache line
+    typedef struct __GroupTask {
+        const PlantLogs *p_logs;
+        const RoaringBitmap *p_rows;
+        const __GroupPlantInfo *infos;
+        size_t info_c;
+        GroupKey key;
+        QuantileField field;
+        size_t beg;
+        size_t end;
+        GroupTable partial;
+    } __attribute__((aligned(64))) __GroupTask;
+
+
+    /// Find the hash table slot index of the key, which is either the slot with
+    /// the key or the first empty slot in its probe sequence
+    static size_t __groupTableProbe(const GroupTable *p_table, uint32_t key);
+
+
+    /// Double the capacity of the hash table and reinsert all aggregates
+    static void __groupTableGrow(GroupTable *p_table);
+
+
+    /// Find the aggregate of the key, the aggregate is created if it does not exist
+    static GroupAggregate *__groupTableGet(GroupTable *p_table, uint32_t key);
+
+
+    /// Find the group key of the log according to the grouping key
+    static uint32_t __logGroupKey(const __GroupTask *p_task, uint32_t plant_no, int32_t date);
+
+
+    /// Aggregate the value into the group aggregate
+    static void __aggregateValue(GroupAggregate *p_agg, float val);
+
+
+    /// Accumulate the task's log range into its partial hash table
+    static void *__reduceGroupTask(void *p_arg);
+
+
+    /// Find the amount of threads to use for aggregating n logs
+    static size_t __groupThreadCount(size_t n, size_t req_c);
+
+
+    #define __GROUP_TABLE_MIN_CAP           64
+    #define __MAX_GROUP_THREAD_C            64
+    #define __MIN_GROUP_TASK_SIZE           (1 << 16)
+#endif
+
+
+/// Group logs by the grouping key and aggregate the values of the log field in each
+/// group, logs of power plants that no longer exist are grouped under unknown fuel
+/// If the bitmap of rows is given, only logs in those rows are aggregated
+/// Logs are split into contiguous ranges, each aggregated by its own thread into a partial
+/// hash table, which are merged at the end. If thread_c is 0, the amount of threads is
+/// chosen from the available cores and the amount of live logs
+/// Archived logs are aggregated by the calling thread, if they match the predicate
+/// Returns the amount of threads that were used
+size_t groupLogs(PowerPlants *p_plants, PlantLogs *p_logs, GroupKey key, QuantileField field,
+    const RoaringBitmap *p_rows, const PredicateInstr *pred, size_t pred_c, size_t thread_c, 
+    GroupTable *p_out);
+
+
+/// Find the value of the aggregate function over the group aggregate
+double groupAggregateValue(GroupAggregate *p_agg, GroupAggFunc func);
+
+
+/// Free all memory allocated for the group table
+void destroyGroupTable(GroupTable *p_table);
+
+#endif
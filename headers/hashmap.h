@@ -17,6 +17,9 @@
     #include <string.h>
     #include <stdio.h>
     #include <limits.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
 #endif
 
 /// Map stored instance structure
@@ -0,0 +1,62 @@
+/*
+ * File:        id_map.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for mapping power plant and log ids to
+ *              their row indices
+ */
+
+
+#ifndef __ID_MAP_H
+#define __ID_MAP_H
+
+#ifdef __ID_MAP_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+
+
+    /// Find the slot index of the id, which is either the slot with the id or
+    /// the first empty slot in its probe sequence
+    static size_t __idMapProbe(const IdMap *p_map, uint32_t id);
+
+
+    /// Resize the map to the given capacity and reinsert all ids
+    static void __idMapResize(IdMap *p_map, size_t cap);
+
+
+    #define __ID_MAP_MIN_CAP            16
+#endif
+
+
+/// Row value of ids that are not in the map
+#define ID_MAP_NONE                     UINT32_MAX
+
+
+/// Create a new id map with capacity for at least the given amount of ids
+void newIdMap(IdMap *p_map, size_t id_c);
+
+
+/// Map the id to the row, previous row of the id is replaced
+void idMapPut(IdMap *p_map, uint32_t id, uint32_t row);
+
+
+/// Find the row of the id, ID_MAP_NONE is returned if the id is not in the map
+uint32_t idMapFind(const IdMap *p_map, uint32_t id);
+
+
+/// Remove the id from the map
+/// Returns the row of the removed id or ID_MAP_NONE if the id was not in the map
+uint32_t idMapRemove(IdMap *p_map, uint32_t id);
+
+
+/// Free all memory allocated for the id map
+void destroyIdMap(IdMap *p_map);
+
+#endif
@@ -0,0 +1,68 @@
+/*
+ * File:        indexes.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-11
+ * Last edit:   2021-06-11
+ * Description: Function declarations for maintaining bitmap indexes over power
+ *              plants and logs
+ */
+
+
+#ifndef __INDEXES_H
+#define __INDEXES_H
+
+#ifdef __INDEXES_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <bitmap.h>
+    #include <date.h>
+    #include <log_slab.h>
+#endif
+
+
+/// Convert months since 1970-01 into month index key, keys have the same order as months
+uint32_t monthIndexKey(int32_t month);
+
+
+/// Convert month index key back into months since 1970-01
+int32_t monthIndexKeyToMonth(uint32_t key);
+
+
+/// Add the log row into the plant and month indexes
+void addLogIndexes(PlantLogs *p_logs, size_t row);
+
+
+/// Remove the log row from the plant and month indexes, the entry must have
+/// the values the row was indexed with
+void removeLogIndexes(PlantLogs *p_logs, size_t row, LogEntry *p_entry);
+
+
+/// Rebuild the plant and month indexes from all log rows
+void rebuildLogIndexes(PlantLogs *p_logs);
+
+
+/// Free all memory allocated for the log indexes
+void destroyLogIndexes(PlantLogs *p_logs);
+
+
+/// Add the power plant row into the fuel index
+void addPlantIndexes(PowerPlants *p_plants, size_t row);
+
+
+/// Remove the power plant row with the given fuel type from the fuel index
+void removePlantIndexes(PowerPlants *p_plants, size_t row, FuelType fuel);
+
+
+/// Rebuild the fuel index from all power plant rows
+void rebuildPlantIndexes(PowerPlants *p_plants);
+
+
+/// Free all memory allocated for the power plant indexes
+void destroyPlantIndexes(PowerPlants *p_plants);
+
+#endif
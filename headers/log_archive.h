@@ -0,0 +1,145 @@
+/*
+ * File:        log_archive.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for moving old logs into compressed
+ *              per power plant archive blocks and decoding them
+ */
+
+
+#ifndef __LOG_ARCHIVE_H
+#define __LOG_ARCHIVE_H
+
+#ifdef __LOG_ARCHIVE_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+    #include <id_map.h>
+    #include <bitmap.h>
+    #include <log_slab.h>
+    #include <log_columns.h>
+
+
+    /// Structure for appending bits to a byte buffer, most significant bit first
+    typedef struct __BitWriter {
+        uint8_t *data;
+        size_t size;
+        size_t cap;
+        uint64_t acc;       // bits that do not fill a whole byte yet
+        uint32_t acc_n;
+    } __BitWriter;
+
+
+    /// Structure for reading bits from a zero padded byte buffer
+    typedef struct __BitReader {
+        const uint8_t *data;
+        size_t pos;         // bit position
+    } __BitReader;
+
+
+    /// Structure for the previous value and delta of a delta-of-delta encoded field
+    typedef struct __DeltaState {
+        int64_t prev;
+        int64_t delta;
+        bool has_prev;
+    } __DeltaState;
+
+
+    /// Structure for the previous value and meaningful bit window of a XOR encoded field
+    typedef struct __XorState {
+        uint32_t prev;
+        uint32_t lead;
+        uint32_t len;       // 0 if there is no previous window
+    } __XorState;
+
+
+    /// Append the n low bits of the value to the bit stream, n must be at most 32
+    static void __writeBits(__BitWriter *p_bw, uint64_t val, uint32_t n);
+
+
+    /// Read the next n bits from the bit stream, n must be at most 32
+    static uint64_t __readBits(__BitReader *p_br, uint32_t n);
+
+
+    /// Write the value as the difference between its delta and the previous delta
+    /// Zigzag encoded differences are prefixed with their bit width class, so that
+    /// evenly spaced values take a single bit
+    static void __writeDelta(__BitWriter *p_bw, __DeltaState *p_st, int64_t val);
+
+
+    /// Read the next delta-of-delta encoded value
+    static int64_t __readDelta(__BitReader *p_br, __DeltaState *p_st);
+
+
+    /// Write the value as XOR with the previous value, where only the meaningful bits
+    /// are stored and the bit window of the previous value is reused if it fits
+    static void __writeXor(__BitWriter *p_bw, __XorState *p_st, float val);
+
+
+    /// Read the next XOR encoded value
+    static float __readXor(__BitReader *p_br, __XorState *p_st);
+
+
+    /// Compress the date ordered logs into a new archive block
+    static void __encodeArchiveBlock(const LogEntry *entries, size_t n, ArchiveBlock *p_block);
+
+
+    /// Add the date ordered logs into the archive, blocks after the first log date are
+    /// decoded, merged with the logs and compressed again
+    static void __appendPlantArchive(PlantArchive *p_arch, uint32_t plant_no, const LogEntry *entries,
+        size_t n);
+
+
+    // Bit streams are padded, so that 8 bytes can always be read from any position
+    #define __ARCHIVE_PAD_SIZE          8
+    // Longest possible encoding of a single log in bytes
+    #define __ARCHIVE_MAX_LOG_SIZE      32
+#endif
+
+
+/// Maximum amount of logs in a single archive block
+#define ARCHIVE_BLOCK_LOG_C             1024
+
+
+/// Move the logs of each power plant dated before the cutoff day into its archive
+/// Archived logs are removed from log storage, indexes and the id map, but they stay
+/// in the aggregates, rollups and sketches of their power plant
+/// Logs of deleted power plants are not archived
+/// Returns the amount of archived logs
+size_t archiveLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *p_map, int32_t cutoff);
+
+
+/// Decode all logs of the archive block into the output array
+/// Returns the amount of decoded logs
+size_t decodeArchiveBlock(const ArchiveBlock *p_block, uint32_t plant_no, LogEntry *out);
+
+
+/// Decode the archived logs dated from day from to day to into the output array in date order
+/// Only the blocks overlapping the date range are decoded
+/// Returns the amount of logs written into out, which must fit plantArchiveRangeBound() logs
+size_t scanPlantArchive(const PlantArchive *p_arch, uint32_t plant_no, int32_t from, int32_t to,
+    LogEntry *out);
+
+
+/// Find the upper bound of the amount of archived logs dated from day from to day to
+size_t plantArchiveRangeBound(const PlantArchive *p_arch, int32_t from, int32_t to);
+
+
+/// Find the amount of archived logs of all power plants
+size_t archivedLogCount(const PowerPlants *p_plants);
+
+
+/// Find the amount of unused bytes in the archive block array
+size_t plantArchiveSlack(const PlantArchive *p_arch);
+
+
+/// Free all memory allocated for the archive
+void destroyPlantArchive(PlantArchive *p_arch);
+
+#endif
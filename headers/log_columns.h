@@ -0,0 +1,119 @@
+/*
+ * File:        log_columns.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-05
+ * Last edit:   2021-06-05
+ * Description: Function declarations for columnar log storage and vectorised 
+ *              column scanning kernels
+ */
+
+
+#ifndef __LOG_COLUMNS_H
+#define __LOG_COLUMNS_H
+
+#ifdef __LOG_COLUMNS_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+    #include <immintrin.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+    #include <log_slab.h>
+
+
+    /// Check if the CPU supports AVX2 instructions
+    static bool __hasAvx2();
+
+
+    /// Allocate 32 byte aligned column memory for cap elements of given size and copy 
+    /// n elements from the old column over to it
+    static void *__reallocColumn(void *col, size_t size, size_t n, size_t cap);
+
+
+    /// Make sure that the columns can hold at least req_n rows
+    static void __reserveLogColumns(LogColumns *p_cols, size_t req_n);
+
+
+    /// AVX2 variants of the column kernels
+    static double __columnSumfAvx2(const float *col, size_t n);
+    static float __columnMinfAvx2(const float *col, size_t n);
+    static float __columnMaxfAvx2(const float *col, size_t n);
+    static int32_t __columnMini32Avx2(const int32_t *col, size_t n);
+    static int32_t __columnMaxi32Avx2(const int32_t *col, size_t n);
+    static size_t __columnFilterRangefAvx2(const float *col, size_t n, float lo, float hi, uint32_t *out);
+    static size_t __columnFilterRangei32Avx2(const int32_t *col, size_t n, int32_t lo, int32_t hi, 
+        uint32_t *out);
+
+
+    #define __COLUMN_ALIGNMENT          32
+    #define __COLUMN_MIN_CAP            64
+#endif
+
+
+/// Amount of bytes that a single row takes in all columns
+#define LOG_COLUMNS_ROW_SIZE            (2 * sizeof(uint32_t) + 2 * sizeof(float) + sizeof(int32_t))
+
+
+/// Create columnar copy of all live log entries
+/// NOTE: Deleted rows are left out, so column rows match entry rows only if there
+/// are no deleted rows
+void newLogColumns(LogColumns *p_cols, PlantLogs *p_logs);
+
+
+/// Free all memory allocated for log columns
+void destroyLogColumns(LogColumns *p_cols);
+
+
+/// Append log entry as a new row to the end of columns
+void pushLogColumnsRow(LogColumns *p_cols, LogEntry *p_entry);
+
+
+/// Overwrite the row at given index with log entry values
+void setLogColumnsRow(LogColumns *p_cols, size_t i, LogEntry *p_entry);
+
+
+/// Remove the row at given index and shift all following rows to the left
+void removeLogColumnsRow(LogColumns *p_cols, size_t i);
+
+
+/// Create a row view of the log columns at given index
+LogEntry getLogColumnsRow(LogColumns *p_cols, size_t i);
+
+
+/********** Column kernels **********/
+/// The kernels use AVX2 instructions when they are supported by the CPU
+/// NOTE: Minimum and maximum kernels require at least one element
+
+/// Find the sum of floating point column values in double precision
+double columnSumf(const float *col, size_t n);
+
+
+/// Find the minimum floating point column value
+float columnMinf(const float *col, size_t n);
+
+
+/// Find the maximum floating point column value
+float columnMaxf(const float *col, size_t n);
+
+
+/// Find the minimum integer column value
+int32_t columnMini32(const int32_t *col, size_t n);
+
+
+/// Find the maximum integer column value
+int32_t columnMaxi32(const int32_t *col, size_t n);
+
+
+/// Write the indices of floating point column values in range [lo, hi] into out
+/// Returns the amount of written indices
+size_t columnFilterRangef(const float *col, size_t n, float lo, float hi, uint32_t *out);
+
+
+/// Write the indices of integer column values in range [lo, hi] into out
+/// Returns the amount of written indices
+size_t columnFilterRangei32(const int32_t *col, size_t n, int32_t lo, int32_t hi, uint32_t *out);
+
+#endif
@@ -0,0 +1,78 @@
+/*
+ * File:        log_slab.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function declarations for log row allocation with tombstones
+ *              and compaction of deleted rows
+ */
+
+
+#ifndef __LOG_SLAB_H
+#define __LOG_SLAB_H
+
+#ifdef __LOG_SLAB_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+    #include <id_map.h>
+    #include <bitmap.h>
+    #include <indexes.h>
+    #include <log_columns.h>
+    #include <data_store.h>
+
+
+    /// Make sure that the tombstone bits cover at least row_c rows
+    static void __reserveTombstoneBits(LogTombstones *p_tombs, size_t row_c);
+
+
+    // Compaction is triggered when at least a quarter of the rows are tombstones
+    #define __COMPACT_DEAD_RATIO            4
+    #define __MIN_COMPACT_ROW_C             64
+#endif
+
+
+/// Check if the log row is deleted
+bool isLogRowDead(const PlantLogs *p_logs, size_t row);
+
+
+/// Find the amount of logs that are not deleted
+size_t liveLogCount(const PlantLogs *p_logs);
+
+
+/// Allocate a row for a new log, deleted rows are reused before the log array is grown
+/// NOTE: Returned row may be a reused row, so columns must be set instead of pushed if
+/// the row is below the column count
+uint32_t allocLogRow(PlantLogs *p_logs);
+
+
+/// Mark the log row as deleted and put it into the free list
+/// Deleted rows are cleared and their log id is set to DEAD_LOG_ID
+/// NOTE: The row must be removed from the indexes and id map separately
+void freeLogRow(PlantLogs *p_logs, uint32_t row);
+
+
+/// Remove all deleted rows from the bitmap of rows
+void removeDeadLogRows(const PlantLogs *p_logs, RoaringBitmap *p_rows);
+
+
+/// Check if enough rows are deleted that the logs should be compacted
+bool shouldCompactLogs(const PlantLogs *p_logs);
+
+
+/// Move all live logs to the front of the log array in their current order and 
+/// remap the id map, power plant log rows, columns and indexes accordingly
+/// Unused log slots and tombstone memory are released afterwards
+/// Returns the amount of deleted rows that were removed
+size_t compactLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *p_map);
+
+
+/// Free all memory allocated for log tombstones
+void destroyLogTombstones(PlantLogs *p_logs);
+
+#endif
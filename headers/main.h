@@ -27,13 +27,52 @@
     #include <prompt.h>
     #include <log.h>
     #include <energy_manager.h>
+    #include <mem_check.h>
+    #include <ext_sort.h>
+    #include <log_columns.h>
+    #include <sketch.h>
+    #include <indexes.h>
+    #include <id_map.h>
+    #include <arena.h>
+    #include <log_slab.h>
+    #include <log_archive.h>
+    #include <bitmap.h>
+    #include <data_store.h>
+    #include <unistd.h>
     
     #define __DEFAULT_BUF_LEN   1024
+
+
+    /// Standalone log file sorting mode usage text
+    static const char *__sort_file_usage =
+        "usage: energy_manager sort-file <input> <output> [[i|d] <key>] [limit <N>] [offset <N>] [mem <MB>]\n"\
+        "       [where <expr>]\n"\
+        "  [i|d] -- sort by increasing or decreasing value (default: increasing)\n"\
+        "    log_id -- sort by log id\n"\
+        "    plant_id -- sort by plant id\n"\
+        "    production -- sort by production output\n"\
+        "    price -- sort by average price for that day\n"\
+        "    date -- sort by date\n"\
+        "  mem <MB> -- memory budget for sorting (default: 64MB)\n"\
+        "  where <expr> -- sort only the logs matching the expression (see 'list' in selected mode)\n";
+
+
+    /// Data store mode usage text
+    static const char *__store_usage =
+        "usage: energy_manager store <data file>\n"\
+        "  Power plants and logs are kept in the memory mapped data file, which is created from\n"\
+        "  the power plant and log files if it does not exist\n";
 #endif
 
 
 /// Poll user input
-void poll(char *pow_file, char *log_file, time_t start);
+/// If the store file is given, power plants and logs are kept in the data file, which
+/// is opened if no power plant and log files are given
+void poll(char *pow_file, char *log_file, char *store_file, time_t start);
+
+
+/// Run the program in standalone log file sorting mode
+int sortFileMode(int argc, char *argv[]);
 
 
 #endif
@@ -17,18 +17,117 @@
     #include <string.h>
     #include <stdbool.h>
     #include <stdlib.h>
+    #include <unistd.h>
+    #include <sys/resource.h>
 
     #include <entity_data.h>
 #endif
 
+
+/// Subsystems that allocated bytes are accounted under
+typedef enum MemTag {
+    MEM_TAG_PLANTS      = 0,    // power plant array, names and log rows in the arena
+    MEM_TAG_LOGS        = 1,    // log entries, columns and tombstones
+    MEM_TAG_REFS        = 2,    // reference and row index arrays for listings
+    MEM_TAG_MAPS        = 3,    // id maps, token hashmap and bitmap indexes
+    MEM_TAG_PARSER      = 4,    // csv file buffers and rows
+    MEM_TAG_SORT        = 5,    // sorting scratch memory
+    MEM_TAG_ARCHIVE     = 6,    // compressed archive blocks
+    MEM_TAG_STORE       = 7,    // log rows mapped from the data file, not heap memory
+    MEM_TAG_C           = 8
+} MemTag;
+
+
+/// Structure for allocation statistics of a single subsystem
+typedef struct MemTagStats {
+    size_t live;
+    size_t peak;
+    size_t alloc_c;
+} MemTagStats;
+
+
+#ifdef __MEM_CHECK_C
+    /// Allocation statistics of each subsystem
+    /// NOTE: Statistics are not updated atomically, so worker threads do not use tagged allocations
+    static MemTagStats __mem_tag_stats[MEM_TAG_C];
+#endif
+
 /// Round the 64 bit integer to the nearest base2 exponant
 size_t __roundToBase2(size_t k);
 
 
-/// Check if memory reallocation is necessary based on the required size and capacity
+/// Array capacity growth factor as a fraction, which can be overridden at compile time
+/// Smaller factors waste less memory on slack, bigger ones reallocate less often
+#ifndef ARRAY_GROWTH_NUM
+    #define ARRAY_GROWTH_NUM            3
+    #define ARRAY_GROWTH_DEN            2
+#endif
+
+/// Capacity of arrays that are grown from empty
+#define ARRAY_MIN_CAP                   4
+
+
+/// Check if memory reallocation is necessary based on the required element count and capacity
+/// The capacity is counted in elements and grown by the array growth factor until req_n elements fit
 void reallocCheck(void **p_data, size_t size, size_t req_n, size_t *p_cap);
 
 
+/// Shrink the capacity of the array to its element count, memory of empty arrays is released
+void shrinkToFit(void **p_data, size_t size, size_t n, size_t *p_cap);
+
+
+/// Account allocated bytes under the subsystem tag
+void memTrackAlloc(MemTag tag, size_t size);
+
+
+/// Account freed bytes under the subsystem tag
+void memTrackFree(MemTag tag, size_t size);
+
+
+/// Allocate memory and account it under the subsystem tag
+/// NULL is returned if the allocation fails
+void *memAlloc(MemTag tag, size_t size);
+
+
+/// Allocate zeroed memory and account it under the subsystem tag
+/// NULL is returned if the allocation fails
+void *memCalloc(MemTag tag, size_t n, size_t size);
+
+
+/// Resize memory that was accounted under the subsystem tag
+/// NULL is returned if the reallocation fails, in which case the old memory is kept
+void *memRealloc(MemTag tag, void *ptr, size_t old_size, size_t new_size);
+
+
+/// Free memory that was accounted under the subsystem tag with the given size
+void memFree(MemTag tag, void *ptr, size_t size);
+
+
+/// Same as reallocCheck, but the reallocated bytes are accounted under the subsystem tag
+void memReallocCheck(MemTag tag, void **p_data, size_t size, size_t req_n, size_t *p_cap);
+
+
+/// Same as shrinkToFit, but the released bytes are accounted under the subsystem tag
+void memShrinkToFit(MemTag tag, void **p_data, size_t size, size_t n, size_t *p_cap);
+
+
+/// Retrieve allocation statistics of the subsystem tag
+MemTagStats memTagStats(MemTag tag);
+
+
+/// Convert MemTag enumeral into appropriate string
+char *memTagToStr(MemTag tag);
+
+
+/// Find the current resident set size of the process in bytes
+/// Returns 0 if the resident set size is not available
+size_t residentSetSize();
+
+
+/// Find the peak resident set size of the process in bytes
+size_t peakResidentSetSize();
+
+
 /// Check if the given memory area contains only ascii numbers
 /// Returns 1 if the memory area contains only ascii numbers and 0 otherwise
 bool numcheck(char *data, size_t len);
@@ -0,0 +1,141 @@
+/*
+ * File:        predicate.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-10
+ * Last edit:   2021-06-10
+ * Description: Function declarations for evaluating compiled filter predicates over
+ *              power plants, log entries and log columns
+ */
+
+
+#ifndef __PREDICATE_H
+#define __PREDICATE_H
+
+#ifdef __PREDICATE_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <hashmap.h>
+    #include <entity_data.h>
+    #include <act_impl.h>
+    #include <date.h>
+    #include <bitmap.h>
+    #include <indexes.h>
+
+
+    /// Find the value of the predicate field of the power plant
+    static double __powerPlantFieldValue(void *p_row, PredicateField field);
+
+
+    /// Find the value of the predicate field of the log entry
+    static double __logEntryFieldValue(void *p_row, PredicateField field);
+
+
+    /// Structure for an archived log and the fuel type of its power plant, which is
+    /// evaluated as a single predicate row
+    typedef struct __ArchivedLogRow {
+        LogEntry *p_entry;
+        FuelType fuel;
+    } __ArchivedLogRow;
+
+
+    /// Find the value of the predicate field of the archived log
+    static double __archivedLogFieldValue(void *p_row, PredicateField field);
+
+
+    /// Evaluate the predicate for a single row, whose field values are found with
+    /// the given value function
+    /// If comparison bitmaps are given, comparisons on indexed fields are answered
+    /// by checking if the bitmap contains the row index
+    static bool __matchRow(void *p_row, double (*value)(void*, PredicateField),
+        const PredicateInstr *pred, size_t pred_c, const RoaringBitmap *bms, uint32_t row);
+
+
+    /// Compare the index key value with the constant of the comparison instruction
+    static bool __cmpKey(const PredicateInstr *p_instr, double key);
+
+
+    /// Add all rows of the index keys that match the comparison into the output bitmap
+    static void __indexCmp(BitmapIndex *p_idx, const PredicateInstr *p_instr, RoaringBitmap *p_out);
+
+
+    /// Add all log rows of the log months that match the year or month comparison
+    /// into the output bitmap
+    static void __indexMonthCmp(PlantLogs *p_logs, const PredicateInstr *p_instr, RoaringBitmap *p_out);
+
+
+    /// Add all log rows of the power plants, whose fuel type matches the comparison,
+    /// into the output bitmap
+    static void __indexLogFuelCmp(PowerPlants *p_plants, PlantLogs *p_logs, const PredicateInstr *p_instr,
+        RoaringBitmap *p_out);
+
+
+    /// Load the field values of n column rows starting from beg
+    static void __loadColumnBlock(LogColumns *p_cols, PredicateField field, size_t beg, size_t n,
+        double *vals);
+
+
+    /// Compare each block value with the constant and return the results as a bit mask
+    static uint64_t __cmpBlock(const double *vals, size_t n, PredicateOp op, double c);
+
+
+    #define __PREDICATE_BLOCK_SIZE      64
+#endif
+
+
+/// Check if comparisons on the predicate field can be answered from bitmap indexes
+bool isIndexedPredicateField(PredicateField field);
+
+
+/// Evaluate each comparison of the predicate on an indexed field into the bitmap of
+/// matching rows, bitmaps of the other instructions are left empty
+/// Log fields are evaluated over log rows and power plant fields over power plant rows
+/// Returns true if every comparison of the predicate is on an indexed field
+bool indexPredicate(PowerPlants *p_plants, PlantLogs *p_logs, const PredicateInstr *pred, 
+    size_t pred_c, RoaringBitmap *bms);
+
+
+/// Combine the comparison bitmaps of fully indexed predicate with bitmap operations into
+/// the bitmap of matching rows out of row_c rows
+/// NOTE: Comparison bitmaps are consumed by the evaluation
+void evalPredicateBitmaps(const PredicateInstr *pred, size_t pred_c, RoaringBitmap *bms, 
+    size_t row_c, RoaringBitmap *p_out);
+
+
+/// Free all comparison bitmaps of the predicate
+void destroyPredicateBitmaps(RoaringBitmap *bms, size_t pred_c);
+
+
+/// Check if the power plant matches the predicate
+bool matchPowerPlant(PlantData *p_plant, const PredicateInstr *pred, size_t pred_c);
+
+
+/// Check if the log entry matches the predicate
+/// NOTE: Comparisons on log fuel type can only be answered with matchLogRow()
+bool matchLogEntry(LogEntry *p_entry, const PredicateInstr *pred, size_t pred_c);
+
+
+/// Check if the archived log of the power plant with the given fuel type matches the predicate
+/// Archived logs are not in bitmap indexes, so all comparisons are evaluated on the log
+bool matchArchivedLog(LogEntry *p_entry, FuelType fuel, const PredicateInstr *pred, size_t pred_c);
+
+
+/// Check if the log row matches the predicate, comparisons on indexed fields are
+/// answered from the comparison bitmaps found with indexPredicate()
+bool matchLogRow(PlantLogs *p_logs, size_t row, const PredicateInstr *pred, size_t pred_c,
+    const RoaringBitmap *bms);
+
+
+/// Find the indices of all column rows that match the predicate
+/// Rows are evaluated in blocks of 64, where each instruction produces a bit mask
+/// for the whole block in a tight loop over the column values
+/// If comparison bitmaps are given, masks of comparisons on indexed fields are
+/// read from the bitmaps instead
+/// Returns the amount of matching rows written into out
+size_t filterLogColumns(LogColumns *p_cols, const PredicateInstr *pred, size_t pred_c,
+    const RoaringBitmap *bms, uint32_t *out);
+
+#endif
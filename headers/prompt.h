@@ -38,7 +38,21 @@ typedef enum UserInputAction {
     USER_INPUT_ACTION_S_UNSEL_POWER_PLANT       = 13,
     USER_INPUT_ACTION_EXIT                      = 14,
     USER_INPUT_ACTION_SAVE                      = 15,
-    USER_INPUT_ACTION_ENUM_C                    = 16
+    USER_INPUT_ACTION_U_SHOW_STATS              = 16,
+    USER_INPUT_ACTION_U_SHOW_ROLLUP             = 17,
+    USER_INPUT_ACTION_S_SHOW_ROLLUP             = 18,
+    USER_INPUT_ACTION_U_SHOW_FUEL_STATS         = 19,
+    USER_INPUT_ACTION_U_SHOW_QUANTILES          = 20,
+    USER_INPUT_ACTION_S_SHOW_QUANTILES          = 21,
+    USER_INPUT_ACTION_U_SHOW_ROLLING            = 22,
+    USER_INPUT_ACTION_S_SHOW_ROLLING            = 23,
+    USER_INPUT_ACTION_U_COUNT_LOGS              = 24,
+    USER_INPUT_ACTION_S_COUNT_LOGS              = 25,
+    USER_INPUT_ACTION_U_GROUP_LOGS              = 26,
+    USER_INPUT_ACTION_COMPACT                   = 27,
+    USER_INPUT_ACTION_MEM                       = 28,
+    USER_INPUT_ACTION_U_ARCHIVE_LOGS            = 29,
+    USER_INPUT_ACTION_ENUM_C                    = 30
 } UserInputAction;
 
 
@@ -54,9 +68,13 @@ typedef enum UserInputAction {
 
     #include <hashmap.h>
     #include <entity_data.h>
+    #include <date.h>
     #include <algo.h>
     #include <act_impl.h>
     #include <mem_check.h>
+    #include <id_map.h>
+    #include <arena.h>
+    #include <bitmap.h>
 
     /// Display the power plant entry data
     static void __displayPowerPlantEntry(PlantData *p_data);
@@ -97,6 +115,13 @@ typedef enum UserInputAction {
         { "edit"        UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_EDIT_POWER_PLANT },
         { "delete"      UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_DELETE_POWER_PLANT },
         { "select"      UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_SELECT_POWER_PLANT },
+        { "stats"       UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_SHOW_STATS },
+        { "rollup"      UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_SHOW_ROLLUP },
+        { "quantiles"   UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_SHOW_QUANTILES },
+        { "rolling"     UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_SHOW_ROLLING },
+        { "count"       UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_COUNT_LOGS },
+        { "group"       UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_GROUP_LOGS },
+        { "archive"     UNSEL_SPECIFIER,    USER_INPUT_ACTION_U_ARCHIVE_LOGS },
 
         // Selected mode tokens
         { "help"        SEL_SPECIFIER,      USER_INPUT_ACTION_S_SHOW_HELP },
@@ -105,8 +130,14 @@ typedef enum UserInputAction {
         { "edit"        SEL_SPECIFIER,      USER_INPUT_ACTION_S_EDIT_LOG },
         { "delete"      SEL_SPECIFIER,      USER_INPUT_ACTION_S_DELETE_LOG },
         { "unsel"       SEL_SPECIFIER,      USER_INPUT_ACTION_S_UNSEL_POWER_PLANT },
+        { "rollup"      SEL_SPECIFIER,      USER_INPUT_ACTION_S_SHOW_ROLLUP },
+        { "quantiles"   SEL_SPECIFIER,      USER_INPUT_ACTION_S_SHOW_QUANTILES },
+        { "rolling"     SEL_SPECIFIER,      USER_INPUT_ACTION_S_SHOW_ROLLING },
+        { "count"       SEL_SPECIFIER,      USER_INPUT_ACTION_S_COUNT_LOGS },
 
         // General purpose commands
+        { "compact",           USER_INPUT_ACTION_COMPACT },
+        { "mem",               USER_INPUT_ACTION_MEM },
         { "save",              USER_INPUT_ACTION_SAVE },
         { "exit",              USER_INPUT_ACTION_EXIT }
     };
@@ -126,6 +157,7 @@ typedef enum UserInputAction {
         { "rated_cap",      { LIST_SORT_MODE_POW_CAP_INCR,          LIST_SORT_MODE_POW_CAP_DECR } },
         { "avg_price",      { LIST_SORT_MODE_POW_COST_INCR,         LIST_SORT_MODE_POW_COST_DECR } },
         { "avg_util",       { LIST_SORT_MODE_POW_UTIL_INCR,         LIST_SORT_MODE_POW_UTIL_DECR } },
+        { "name",           { LIST_SORT_MODE_POW_NAME_INCR,         LIST_SORT_MODE_POW_NAME_DECR } },
     };
     
     /// Selected mode sort mode specifiers
@@ -138,6 +170,152 @@ typedef enum UserInputAction {
         { "date",           { LIST_SORT_MODE_LOG_DATE_INCR,         LIST_SORT_MODE_LOG_DATE_DECR } } 
     };
 
+
+    /// Structure for specifying a field that can be compared in where clauses
+    typedef struct __PredicateFieldDef {
+        char *str_field;
+        PredicateField field;
+    } __PredicateFieldDef;
+
+
+    /// Unselected mode power plant where clause fields
+    static const __PredicateFieldDef __plant_pred_fields[] = {
+        { "plant_id",       PREDICATE_FIELD_POW_ID },
+        { "fuel",           PREDICATE_FIELD_POW_FUEL },
+        { "rated_cap",      PREDICATE_FIELD_POW_RATED_CAP },
+        { "avg_price",      PREDICATE_FIELD_POW_AVG_PRICE },
+        { "avg_util",       PREDICATE_FIELD_POW_AVG_UTIL }
+    };
+
+    /// Log where clause fields
+    static const __PredicateFieldDef __log_pred_fields[] = {
+        { "log_id",         PREDICATE_FIELD_LOG_ID },
+        { "plant_id",       PREDICATE_FIELD_LOG_PLANT_ID },
+        { "production",     PREDICATE_FIELD_LOG_PRODUCTION },
+        { "price",          PREDICATE_FIELD_LOG_SALE_PRICE },
+        { "date",           PREDICATE_FIELD_LOG_DATE },
+        { "year",           PREDICATE_FIELD_LOG_YEAR },
+        { "month",          PREDICATE_FIELD_LOG_MONTH },
+        { "day",            PREDICATE_FIELD_LOG_DAY },
+        { "fuel",           PREDICATE_FIELD_LOG_FUEL }
+    };
+
+    /// Log file where clause fields, log files do not have access to power plant fuel types
+    static const __PredicateFieldDef __file_log_pred_fields[] = {
+        { "log_id",         PREDICATE_FIELD_LOG_ID },
+        { "plant_id",       PREDICATE_FIELD_LOG_PLANT_ID },
+        { "production",     PREDICATE_FIELD_LOG_PRODUCTION },
+        { "price",          PREDICATE_FIELD_LOG_SALE_PRICE },
+        { "date",           PREDICATE_FIELD_LOG_DATE },
+        { "year",           PREDICATE_FIELD_LOG_YEAR },
+        { "month",          PREDICATE_FIELD_LOG_MONTH },
+        { "day",            PREDICATE_FIELD_LOG_DAY }
+    };
+
+
+    /// Structure for specifying a key that logs can be grouped by
+    typedef struct __GroupKeyDef {
+        char *str_key;
+        GroupKey key;
+    } __GroupKeyDef;
+
+
+    /// Group by keys
+    static const __GroupKeyDef __group_keys[] = {
+        { "plant",          GROUP_KEY_PLANT },
+        { "fuel",           GROUP_KEY_FUEL },
+        { "month",          GROUP_KEY_MONTH },
+        { "year",           GROUP_KEY_YEAR },
+        { "weekday",        GROUP_KEY_WEEKDAY }
+    };
+
+
+    /// Structure for specifying an aggregate function of grouped logs
+    typedef struct __GroupFuncDef {
+        char *str_func;
+        GroupAggFunc func;
+    } __GroupFuncDef;
+
+
+    /// Group aggregate functions
+    static const __GroupFuncDef __group_funcs[] = {
+        { "sum",            GROUP_AGG_FUNC_SUM },
+        { "avg",            GROUP_AGG_FUNC_AVG },
+        { "min",            GROUP_AGG_FUNC_MIN },
+        { "max",            GROUP_AGG_FUNC_MAX },
+        { "count",          GROUP_AGG_FUNC_COUNT }
+    };
+
+
+    #define __MAX_WHERE_TOKEN_C         128
+    #define __MAX_WHERE_TOKEN_LEN       64
+
+    /// Structure for where clause tokens and the parsing position in them
+    typedef struct __WhereParser {
+        char tokens[__MAX_WHERE_TOKEN_C][__MAX_WHERE_TOKEN_LEN];
+        size_t token_c;
+        size_t pos;
+        const __PredicateFieldDef *fields;
+        size_t field_c;
+        ListQuery *p_query;
+    } __WhereParser;
+
+
+    /// Split the where clause arguments into tokens, where comparison operators and
+    /// parentheses form their own tokens even if they are not separated by spaces
+    /// Returns false if there are too many or too long tokens
+    static bool __lexWhereArgs(char **args, size_t arg_c, __WhereParser *p_parser);
+
+
+    /// Append the instruction to the compiled predicate of the query
+    static bool __emitPredicate(__WhereParser *p_parser, PredicateOp op, PredicateField field, double val);
+
+
+    /// Parse the comparison 'field op value' and emit the comparison instruction
+    static bool __parseWhereCmp(__WhereParser *p_parser);
+
+
+    /// Parse the comparison, negation or parenthesised expression
+    static bool __parseWhereUnary(__WhereParser *p_parser);
+
+
+    /// Parse the conjunction of unary expressions
+    static bool __parseWhereAnd(__WhereParser *p_parser);
+
+
+    /// Parse the disjunction of conjunctions
+    static bool __parseWhereOr(__WhereParser *p_parser);
+
+
+    /// Compile the where clause arguments into postfix predicate of the query
+    /// Returns false if the clause could not be parsed
+    static bool __parseWhereArgs(char **args, size_t arg_c, const __PredicateFieldDef *fields, 
+        size_t field_c, ListQuery *p_query);
+
+
+    /// Parse listing arguments into list query
+    /// Returns false if any of the arguments could not be parsed
+    /// Date range arguments are accepted only if allow_range is true and where clauses
+    /// only if the predicate fields are given
+    static bool __parseListArgs(char **args, size_t arg_c, const __SortDef *modes, size_t mode_c,
+        ListSortMode def_mode, bool allow_range, const __PredicateFieldDef *fields, size_t field_c,
+        ListQuery *p_query);
+
+
+    /// Parse rollup arguments into list query
+    /// Returns false if any of the arguments could not be parsed
+    static bool __parseRollupArgs(char **args, size_t arg_c, ListQuery *p_query);
+
+
+    /// Parse group by arguments 'by <key> agg <func>(<field>) [where <expr>]' into list query
+    /// Returns false if any of the arguments could not be parsed
+    static bool __parseGroupArgs(char **args, size_t arg_c, ListQuery *p_query);
+
+
+    /// Parse quantile arguments into list query
+    /// Returns false if any of the arguments could not be parsed
+    static bool __parseQuantileArgs(char **args, size_t arg_c, ListQuery *p_query);
+
     #define __DEFAULT_BUF_SIZE          4096
     #define __DEFAULT_SMALL_BUF_SIZE    64
     #define __DEFAULT_NAME_LEN          1024
@@ -153,14 +331,14 @@ typedef enum UserInputAction {
     FuelType __promptNewPowerPlantFuelType(FuelType *old);
 
 
-    /// Prompt the user about new power plant name
-    char *__promptNewPowerPlantNameValue(char *old);
+    /// Prompt the user about new power plant name, the new name is allocated from the arena
+    char *__promptNewPowerPlantNameValue(char *old, Arena *p_arena);
 
 
     /********** New log creation prompts **********/
 
     /// Prompt the user about log's date info
-    Date __promptNewLogDate(Date *old);
+    int32_t __promptNewLogDate(int32_t *old);
 
 
     /********** Generic prompts ***********/
@@ -170,7 +348,8 @@ typedef enum UserInputAction {
     
 
     /// Prompt the user until he enters correct id
-    uint32_t __promptIdValue(char *msg, size_t *p_max_id, Hashmap *p_map);
+    /// Ids in the optional reserved id bitmap are treated as used
+    uint32_t __promptIdValue(char *msg, size_t *p_max_id, IdMap *p_map, const RoaringBitmap *p_reserved);
 #endif
 
 
@@ -184,10 +363,14 @@ void displayLogData(PlantLogRefs *p_refs);
 void displayPowerPlants(PowerPlantRefs *p_refs);
 
 
-/// Format date from Date structure into string yyyy-mm-dd format
+/// Display monthly or yearly rollup buckets of the power plant
+void displayRollup(PlantData *p_plant, RollupPeriod period);
+
+
+/// Format date from epoch day into string yyyy-mm-dd format
 /// NOTE: This function returns a pointer to stack allocated memory area,
 /// which gets overwritten with every function call
-char *formatDate(Date *p_date);
+char *formatDate(int32_t day);
 
 
 /// Prompt the user about possible actions that can be taken, when
@@ -206,15 +389,20 @@ Hashmap tokeniseUserInput();
 
 /// Parse the user entry into enumeral
 UserInputAction parseUserInputAction(Hashmap *tokens, char *in_str, bool is_sel, 
-    ListSortMode *p_sort, uint32_t *out_arg);
+    ListQuery *p_query, uint32_t *out_arg);
+
+
+/// Parse log listing arguments into list query
+/// Returns false if any of the arguments could not be parsed
+bool parseLogListArgs(char **args, size_t arg_c, ListQuery *p_query);
 
 
 /// Prompt the user for information about a new power plant instance
-PlantData promptNewPowerPlant(size_t *p_max_id, Hashmap *p_map);
+PlantData promptNewPowerPlant(size_t *p_max_id, IdMap *p_map, Arena *p_arena);
 
 
 /// Prompt the user for information about editing a power plant instance
-void promptEditPowerPlant(PlantData *data);
+void promptEditPowerPlant(PlantData *data, Arena *p_arena);
 
 
 /// Prompt the user for information about editing a log instance
@@ -222,5 +410,6 @@ void promptEditLog(LogEntry *log);
 
 
 /// Prompt the user to create a new log entry
-LogEntry promptNewLogEntry(Hashmap *p_map, size_t *p_max_id, uint32_t sel_id);
+/// Ids of archived logs are not available for new logs
+LogEntry promptNewLogEntry(IdMap *p_map, const RoaringBitmap *archived_ids, size_t *p_max_id, uint32_t sel_id);
 #endif
@@ -0,0 +1,89 @@
+/*
+ * File:        rolling.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-09
+ * Last edit:   2021-06-09
+ * Description: Function declarations for sliding window sums and extremes over
+ *              daily value series
+ */
+
+
+#ifndef __ROLLING_H
+#define __ROLLING_H
+
+#ifdef __ROLLING_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <string.h>
+
+    #include <entity_data.h>
+#endif
+
+
+/// Structure for a single day value in the sliding window
+typedef struct RollingValue {
+    int32_t day;
+    double val;
+} RollingValue;
+
+
+/// Structure for double ended queue of day values with constant capacity
+typedef struct RollingDeque {
+    RollingValue *vals;
+    size_t beg;
+    size_t n;
+} RollingDeque;
+
+
+/// Structure for sliding window of the given amount of days over daily values
+/// Sum is updated in O(1) per pushed day, while the minimum and maximum are kept
+/// at the fronts of monotonic deques in amortised O(1) per pushed day
+typedef struct RollingWindow {
+    size_t days;
+    KahanSum sum;
+    RollingDeque vals;      // all values in the window
+    RollingDeque min_q;     // increasing values
+    RollingDeque max_q;     // decreasing values
+} RollingWindow;
+
+
+#ifdef __ROLLING_C
+    #include <algo.h>
+
+
+    /// Find the value at given position from the front of the deque
+    static RollingValue *__dequeAt(RollingDeque *p_q, size_t cap, size_t i);
+
+
+    /// Remove all values from the front of the deque that are older than the first window day
+    static void __dequeEvict(RollingDeque *p_q, size_t cap, int32_t first_day);
+#endif
+
+
+/// Create a sliding window of the given amount of days
+void newRollingWindow(RollingWindow *p_win, size_t days);
+
+
+/// Push the value of the next day into the window, days must be pushed in
+/// increasing order and values of older days are evicted from the window
+void pushRollingWindow(RollingWindow *p_win, int32_t day, double val);
+
+
+/// Find the sum of the values in the window
+double rollingSum(RollingWindow *p_win);
+
+
+/// Find the minimum value in the window
+double rollingMin(RollingWindow *p_win);
+
+
+/// Find the maximum value in the window
+double rollingMax(RollingWindow *p_win);
+
+
+/// Free all memory allocated for the window
+void destroyRollingWindow(RollingWindow *p_win);
+
+#endif
@@ -0,0 +1,80 @@
+/*
+ * File:        sketch.h
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-08
+ * Last edit:   2021-06-08
+ * Description: Function declarations for mergeable t-digest quantile sketches
+ */
+
+
+#ifndef __SKETCH_H
+#define __SKETCH_H
+
+#ifdef __SKETCH_C
+    #include <stdio.h>
+    #include <stdlib.h>
+    #include <stdint.h>
+    #include <stdbool.h>
+    #include <stddef.h>
+    #include <string.h>
+    #include <math.h>
+
+    #include <entity_data.h>
+    #include <mem_check.h>
+    #include <algo.h>
+    #include <log_archive.h>
+
+
+    /// Add a centroid into the buffer of the digest, the buffer is compressed when full
+    static void __tdigestPush(TDigest *p_td, float mean, float weight);
+
+
+    /// Find the quantile limit of a centroid that starts at quantile q0
+    /// The k1 scale function k(q) = d / 2pi * asin(2q - 1) is used, which allows each
+    /// centroid to span one unit of k, keeping the centroids near the tails small
+    static double __tdigestQuantileLimit(double q0);
+
+
+    /// Sort the buffered centroids together with compressed centroids and merge
+    /// the neighbouring centroids while they fit into the scale function limit
+    static void __tdigestCompress(TDigest *p_td);
+
+
+    #define __TDIGEST_CENTROID_CAP      (TDIGEST_COMPRESSION + 2)
+    #define __TDIGEST_BUFFER_C          (2 * TDIGEST_COMPRESSION)
+#endif
+
+
+/// Compression parameter of the t-digest, which bounds the amount of centroids
+#define TDIGEST_COMPRESSION             100
+
+
+/// Add a value into the digest
+void tdigestAdd(TDigest *p_td, float val);
+
+
+/// Merge all centroids of the source digest into the destination digest
+void tdigestMerge(TDigest *p_dst, TDigest *p_src);
+
+
+/// Estimate the value at quantile q (0 <= q <= 1) of the digest
+/// Returns NAN if the digest is empty
+double tdigestQuantile(TDigest *p_td, double q);
+
+
+/// Free all memory allocated for the digest
+void destroyTDigest(TDigest *p_td);
+
+
+/// Add the log entry values to quantile sketches of the power plant
+void addLogSketches(PlantData *p_plant, LogEntry *p_entry);
+
+
+/// Rebuild the quantile sketches of the power plant from its live and archived logs if they are stale
+void refreshPlantSketches(PlantData *p_plant, PlantLogs *p_logs);
+
+
+/// Free all memory allocated for the power plant quantile sketches
+void destroyPlantSketches(PlantSketches *p_sketch);
+
+#endif
@@ -12,183 +12,363 @@
 #include <act_impl.h>
 
 
-/// Perform sorting on power plant data according to the list sorting mode
-void __sortPowerPlantRefs(PowerPlantRefs *p_refs, ListSortMode smode) {
-    // If no plants are found return
-    if(!p_refs->n) return;
-
-    // Check if sorting should be done for power plants
-    switch(smode) {
-    case LIST_SORT_MODE_POW_UTIL_DECR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, avg_utilisation), sizeof(PlantData*),
-            true, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+/// Pack the key fields of the reference starting from field index beg_field of 
+/// its key field stream, where each numeric value takes a single field and each 
+/// string value takes as many fields as needed to hold it
+/// Returns true if the key field stream continues after the packed fields
+bool __packRefKey (
+    void *ref, 
+    ListSortMode *smodes, 
+    size_t smode_c, 
+    size_t beg_field,
+    PackedSortKey *p_key
+) {
+    const size_t end_field = beg_field + PACKED_SORT_KEY_MAX_FIELDS;
+    size_t field = 0;
+
+    for(size_t i = 0; i < smode_c; i++) {
+        const __SortKeyDef *def = __sort_key_defs + smodes[i];
+
+        // Numeric values are encoded into a single field
+        if(def->val_type != SORT_VALUE_TYPE_STRING) {
+            if(field >= end_field) return true;
+            if(field >= beg_field) {
+                packSortKeyField(p_key, field - beg_field, encodeSortField(ref + def->val_offset,
+                    def->val_type, def->is_decr));
+            }
+
+            field++;
+            continue;
+        }
 
-    case LIST_SORT_MODE_POW_UTIL_INCR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, avg_utilisation), sizeof(PlantData*),
-            false, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+        // String values are encoded in 4 byte chunks, skip the chunks that come
+        // before the first packed field
+        char *str = *(char**) (ref + def->val_offset);
+        size_t len = strlen(str);
+        size_t str_field_c = sortStringFieldCount(len);
+        size_t j = field < beg_field ? beg_field - field : 0;
+        if(j > str_field_c) j = str_field_c;
+
+        for(field += j; j < str_field_c; j++, field++) {
+            if(field >= end_field) return true;
+            packSortKeyField(p_key, field - beg_field, encodeSortStringField(str, len, j, def->is_decr));
+        }
+    }
 
-    case LIST_SORT_MODE_POW_ID_INCR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, no), sizeof(PlantData*),
-            false, SORT_VALUE_TYPE_UINT32, true, 0, p_refs->n - 1);
-        break;
+    return false;
+}
 
-    case LIST_SORT_MODE_POW_ID_DECR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, no), sizeof(PlantData*), 
-            true, SORT_VALUE_TYPE_UINT32, true, 0, p_refs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_POW_CAP_INCR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, rated_cap), sizeof(PlantData*), 
-            false, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+/// Sort generic references with packed keys built from given list sort modes
+/// starting from field index beg_field of the key field stream
+/// If k is not zero, only the first k references are guaranteed to be sorted
+void __sortRefsByModes (
+    void **refs, 
+    size_t n, 
+    ListSortMode *smodes, 
+    size_t smode_c, 
+    size_t k, 
+    size_t beg_field
+) {
+    // If nothing is sorted return
+    if(n < 2 || !smode_c) return;
+
+    // For each reference encode the sorted values into a single packed key
+    PackedSortKey *keys = (PackedSortKey*) memCalloc(MEM_TAG_SORT, n, sizeof(PackedSortKey));
+    bool is_trunc = false;
+    for(size_t i = 0; i < n; i++) {
+        keys[i].ord = i;
+        keys[i].ref = refs[i];
+        is_trunc |= __packRefKey(refs[i], smodes, smode_c, beg_field, keys + i);
+    }
 
-    case LIST_SORT_MODE_POW_CAP_DECR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, rated_cap), sizeof(PlantData*), 
-            true, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+    // Sort the keys as unsigned integers, since the direction is encoded into the key
+    // Ties are ordered by the reference position, so each window is a slice of the full sort
+    partialsort(keys, offsetof(PackedSortKey, hi), sizeof(PackedSortKey), false,
+        SORT_VALUE_TYPE_PACKED128, false, n, k);
+
+    // If the keys did not fit into packed keys, runs of equal keys are ordered
+    // further by the following key fields
+    size_t end = k && k < n ? k : n;
+    if(is_trunc && end < n) {
+        // Move the unsorted references that tie with the last sorted reference
+        // next to it, so that the last run is complete
+        for(size_t i = end; i < n; i++) {
+            if(keys[i].hi == keys[k - 1].hi && keys[i].lo == keys[k - 1].lo) {
+                PackedSortKey tmp = keys[i];
+                keys[i] = keys[end];
+                keys[end++] = tmp;
+            }
+        }
 
-    case LIST_SORT_MODE_POW_COST_INCR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, avg_cost), sizeof(PlantData*),
-            false, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+        // Moved references are put back into their original order, so that the run is
+        // sorted further in the same order as with a full sort
+        if(end - k > 1)
+            mergesort(keys, offsetof(PackedSortKey, hi), sizeof(PackedSortKey), false,
+                SORT_VALUE_TYPE_PACKED128, false, k, end - 1);
+    }
 
-    case LIST_SORT_MODE_POW_COST_DECR:
-        mergesort(p_refs->p_plants, offsetof(PlantData, avg_cost), sizeof(PlantData*), 
-            true, SORT_VALUE_TYPE_FLOAT32, true, 0, p_refs->n - 1);
-        break;
+    // Write the references back in sorted order
+    for(size_t i = 0; i < n; i++)
+        refs[i] = keys[i].ref;
 
-    default: 
-        break;
+    // Sort each run of equal keys by the next packed key fields
+    for(size_t i = 0, j = 0; is_trunc && i < end; i = j) {
+        for(j = i + 1; j < end && keys[j].hi == keys[i].hi && keys[j].lo == keys[i].lo; j++);
+
+        if(j - i > 1) {
+            __sortRefsByModes(refs + i, j - i, smodes, smode_c, k && j > k ? k - i : 0,
+                beg_field + PACKED_SORT_KEY_MAX_FIELDS);
+        }
     }
+
+    memFree(MEM_TAG_SORT, keys, n * sizeof(PackedSortKey));
+}
+
+
+/// Perform sorting on power plant data according to the list query sorting modes
+void __sortPowerPlantRefs(PowerPlantRefs *p_refs, ListQuery *p_query, size_t k) {
+    __sortRefsByModes((void**) p_refs->p_plants, p_refs->n, p_query->smodes, 
+        p_query->smode_c, k, 0);
 }
 
 
 /// Perform required sorting on logs according to the list sorting mode
 void __sortLogs(PlantLogs *p_logs, ListSortMode smode) {
-    // If no logs are found return
-    if(!p_logs->n) return;
+    // If no logs are found or the sort mode is not for logs return
+    if(!p_logs->n || smode < LIST_SORT_MODE_FIRST_SEL || smode > LIST_SORT_MODE_LOG_LAST_SEL) 
+        return;
 
-    switch(smode) {
-    case LIST_SORT_MODE_LOG_ID_INCR:
-        mergesort(p_logs->entries, offsetof(LogEntry, log_id), sizeof(LogEntry),
-            false, SORT_VALUE_TYPE_UINT32, false, 0, p_logs->n - 1);
-        break;
+    const __SortKeyDef *def = __sort_key_defs + smode;
+    mergesort(p_logs->entries, def->val_offset, sizeof(LogEntry), def->is_decr, def->val_type, 
+        false, 0, p_logs->n - 1);
+}
 
-    case LIST_SORT_MODE_LOG_ID_DECR:
-        mergesort(p_logs->entries, offsetof(LogEntry, log_id), sizeof(LogEntry),
-            true, SORT_VALUE_TYPE_UINT32, false, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_PLANT_ID_INCR:
-        mergesort(p_logs->entries, offsetof(LogEntry, plant_no), sizeof(LogEntry),
-            false, SORT_VALUE_TYPE_UINT32, false, 0, p_logs->n - 1);
-        break;
+/// Encode the log entry value that is sorted with given sort mode into order 
+/// preserving 32 bit unsigned integer
+uint32_t __sortLogKey(LogEntry *p_entry, ListSortMode smode) {
+    const __SortKeyDef *def = __sort_key_defs + smode;
+    return encodeSortField((void*) p_entry + def->val_offset, def->val_type, def->is_decr);
+}
 
-    case LIST_SORT_MODE_LOG_PLANT_ID_DECR:
-        mergesort(p_logs->entries, offsetof(LogEntry, plant_no), sizeof(LogEntry),
-            true, SORT_VALUE_TYPE_UINT32, false, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_PRODUCTION_INCR:
-        mergesort(p_logs->entries, offsetof(LogEntry, production), sizeof(LogEntry),
-            false, SORT_VALUE_TYPE_FLOAT32, false, 0, p_logs->n - 1);
-        break;
+/// Perform required sorting on logs according to the list query sorting modes
+void __sortLogRefs(PlantLogRefs *p_logs, ListQuery *p_query, size_t k) {
+    __sortRefsByModes((void**) p_logs->p_entries, p_logs->n, p_query->smodes, 
+        p_query->smode_c, k, 0);
+}
 
-    case LIST_SORT_MODE_LOG_PRODUCTION_DECR:
-        mergesort(p_logs->entries, offsetof(LogEntry, production), sizeof(LogEntry),
-            true, SORT_VALUE_TYPE_FLOAT32, false, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_SALE_PRICE_INCR:
-        mergesort(p_logs->entries, offsetof(LogEntry, avg_sale_price), sizeof(LogEntry),
-            false, SORT_VALUE_TYPE_FLOAT32, false, 0, p_logs->n - 1);
-        break;
+/// Find the index of the first log row with date not before the given day
+/// NOTE: Log rows must be in date order
+size_t __lowerBoundLogDate(PlantLogRows *p_rows, const LogEntry *entries, int32_t day) {
+    size_t lo = 0, hi = p_rows->n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(entries[p_rows->rows[mid]].date < day) lo = mid + 1;
+        else hi = mid;
+    }
 
-    case LIST_SORT_MODE_LOG_SALE_PRICE_DECR:
-        mergesort(p_logs->entries, offsetof(LogEntry, avg_sale_price), sizeof(LogEntry),
-            true, SORT_VALUE_TYPE_FLOAT32, false, 0, p_logs->n - 1);
-        break;
+    return lo;
+}
 
-    case LIST_SORT_MODE_LOG_DATE_INCR:
-        mergesort(p_logs->entries, offsetof(LogEntry, date), sizeof(LogEntry),
-            false, SORT_VALUE_TYPE_DATE, false, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_DATE_DECR:
-        mergesort(p_logs->entries, offsetof(LogEntry, date), sizeof(LogEntry),
-            true, SORT_VALUE_TYPE_DATE, false, 0, p_logs->n - 1);
-        break;
+/// Insert the log row into date ordered log rows after all rows with the same date
+void __insertLogRef(Arena *p_arena, PlantLogRows *p_rows, const LogEntry *entries, uint32_t row) {
+    int32_t date = entries[row].date;
+    size_t i = date == INT32_MAX ? p_rows->n : __lowerBoundLogDate(p_rows, entries, date + 1);
 
-    default: 
-        break;
+    reservePlantLogRows(p_arena, p_rows, p_rows->n + 1);
+    memmove(p_rows->rows + i + 1, p_rows->rows + i, (p_rows->n - i) * sizeof(uint32_t));
+    p_rows->rows[i] = row;
+    p_rows->n++;
+}
+
+
+/// Remove the log row from date ordered log rows, the day must be the date of
+/// the entry at the time it was inserted
+void __removeLogRef(PlantLogRows *p_rows, const LogEntry *entries, uint32_t row, int32_t day) {
+    // Search the row among the rows with the same date
+    size_t i = __lowerBoundLogDate(p_rows, entries, day);
+    while(i < p_rows->n && p_rows->rows[i] != row)
+        i++;
+    if(i == p_rows->n) return;
+
+    memmove(p_rows->rows + i, p_rows->rows + i + 1, (p_rows->n - i - 1) * sizeof(uint32_t));
+    p_rows->n--;
+}
+
+
+/// Append the date ordered log rows in query date range, which match the
+/// query predicate, to destination references
+void __collectLogDateRange (
+    PlantLogRows *p_src, 
+    ListQuery *p_query, 
+    PlantLogs *p_logs,
+    const RoaringBitmap *bms,
+    PlantLogRefs *p_dst
+) {
+    // Binary search the start of the range and scan until its end
+    for(size_t i = __lowerBoundLogDate(p_src, p_logs->entries, p_query->from); i < p_src->n; i++) {
+        LogEntry *p_entry = p_logs->entries + p_src->rows[i];
+        if(p_entry->date > p_query->to) break;
+        if(p_query->pred_c && !matchLogRow(p_logs, p_src->rows[i], p_query->pred, 
+           p_query->pred_c, bms))
+            continue;
+
+        memReallocCheck(MEM_TAG_REFS, (void**) &p_dst->p_entries, sizeof(LogEntry*), p_dst->n + 1, &p_dst->cap);
+        p_dst->p_entries[p_dst->n++] = p_entry;
     }
 }
 
 
-/// Perform required sorting on logs according to the list sorting mode
-void __sortLogRefs(PlantLogRefs *p_logs, ListSortMode smode) {
-    // If no logs are found return
-    if(!p_logs->n) return;
-
-    switch(smode) {
-    case LIST_SORT_MODE_LOG_ID_INCR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, log_id), sizeof(LogEntry*),
-            false, SORT_VALUE_TYPE_UINT32, true, 0, p_logs->n - 1);
-        break;
+/// Find the upper bound of the amount of archived logs of the power plants in the
+/// query date range
+size_t __archivedLogBound(PlantData *plants, size_t plant_c, ListQuery *p_query) {
+    int32_t from = p_query->has_range ? p_query->from : INT32_MIN;
+    int32_t to = p_query->has_range ? p_query->to : INT32_MAX;
 
-    case LIST_SORT_MODE_LOG_ID_DECR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, log_id), sizeof(LogEntry*),
-            true, SORT_VALUE_TYPE_UINT32, true, 0, p_logs->n - 1);
-        break;
+    size_t n = 0;
+    for(size_t i = 0; i < plant_c; i++)
+        n += plantArchiveRangeBound(&plants[i].archive, from, to);
 
-    case LIST_SORT_MODE_LOG_PLANT_ID_INCR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, plant_no), sizeof(LogEntry*),
-            false, SORT_VALUE_TYPE_UINT32, true, 0, p_logs->n - 1);
-        break;
+    return n;
+}
 
-    case LIST_SORT_MODE_LOG_PLANT_ID_DECR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, plant_no), sizeof(LogEntry*),
-            true, SORT_VALUE_TYPE_UINT32, true, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_PRODUCTION_INCR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, production), sizeof(LogEntry*),
-            false, SORT_VALUE_TYPE_FLOAT32, true, 0, p_logs->n - 1);
-        break;
+/// Decode the archived logs of the power plant in query date range into the buffer and
+/// append the references of the logs, which match the query predicate, to destination references
+/// NOTE: The buffer must fit all logs counted by __archivedLogBound()
+void __collectArchivedLogs (
+    PlantData *p_plant,
+    ListQuery *p_query,
+    LogEntry *buf,
+    size_t *p_buf_n,
+    PlantLogRefs *p_dst
+) {
+    int32_t from = p_query->has_range ? p_query->from : INT32_MIN;
+    int32_t to = p_query->has_range ? p_query->to : INT32_MAX;
+    size_t n = scanPlantArchive(&p_plant->archive, p_plant->no, from, to, buf + *p_buf_n);
 
-    case LIST_SORT_MODE_LOG_PRODUCTION_DECR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, production), sizeof(LogEntry*),
-            true, SORT_VALUE_TYPE_FLOAT32, true, 0, p_logs->n - 1);
-        break;
+    for(size_t i = 0; i < n; i++) {
+        LogEntry *p_entry = buf + *p_buf_n + i;
+        if(p_query->pred_c && !matchArchivedLog(p_entry, p_plant->fuel, p_query->pred, p_query->pred_c))
+            continue;
 
-    case LIST_SORT_MODE_LOG_SALE_PRICE_INCR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, avg_sale_price), sizeof(LogEntry*),
-            false, SORT_VALUE_TYPE_FLOAT32, true, 0, p_logs->n - 1);
-        break;
+        memReallocCheck(MEM_TAG_REFS, (void**) &p_dst->p_entries, sizeof(LogEntry*), p_dst->n + 1, &p_dst->cap);
+        p_dst->p_entries[p_dst->n++] = p_entry;
+    }
 
-    case LIST_SORT_MODE_LOG_SALE_PRICE_DECR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, avg_sale_price), sizeof(LogEntry*),
-            true, SORT_VALUE_TYPE_FLOAT32, true, 0, p_logs->n - 1);
-        break;
+    *p_buf_n += n;
+}
 
-    case LIST_SORT_MODE_LOG_DATE_INCR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, date), sizeof(LogEntry*),
-            false, SORT_VALUE_TYPE_DATE, true, 0, p_logs->n - 1);
-        break;
 
-    case LIST_SORT_MODE_LOG_DATE_DECR:
-        mergesort(p_logs->p_entries, offsetof(LogEntry, date), sizeof(LogEntry*),
-            true, SORT_VALUE_TYPE_DATE, true, 0, p_logs->n - 1);
-        break;
+/// Count the archived logs of the power plant, which match the query predicate
+size_t __countArchivedLogs(PlantData *p_plant, ListQuery *p_query) {
+    if(!p_query->pred_c)
+        return p_plant->archive.log_c;
 
-    default: 
-        break;
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    size_t n = 0;
+    for(size_t i = 0; i < p_plant->archive.n; i++) {
+        size_t block_n = decodeArchiveBlock(p_plant->archive.blocks + i, p_plant->no, block);
+        for(size_t j = 0; j < block_n; j++)
+            n += matchArchivedLog(block + j, p_plant->fuel, p_query->pred, p_query->pred_c);
+    }
+
+    return n;
+}
+
+
+/// Find the bitmap of all log rows that match the query predicate
+/// Fully indexed predicates are answered with bitmap operations only, while other
+/// predicates are evaluated over log columns in blocks, where comparisons on indexed
+/// fields are read from their comparison bitmaps
+void __matchingLogRows (
+    PlantLogs *p_logs, 
+    ListQuery *p_query, 
+    RoaringBitmap *bms, 
+    bool is_indexed,
+    RoaringBitmap *p_rows
+) {
+    // Negations are taken over all rows, which include deleted rows
+    if(is_indexed) {
+        evalPredicateBitmaps(p_query->pred, p_query->pred_c, bms, p_logs->n, p_rows);
+        removeDeadLogRows(p_logs, p_rows);
+        return;
+    }
+
+    // Matching rows are found in increasing order, so they are appended to the bitmap
+    if(p_logs->cols) {
+        size_t ind_cap = p_logs->n ? p_logs->n : 1;
+        uint32_t *inds = (uint32_t*) memAlloc(MEM_TAG_REFS, ind_cap * sizeof(uint32_t));
+        size_t n = filterLogColumns(p_logs->cols, p_query->pred, p_query->pred_c, bms, inds);
+        for(size_t i = 0; i < n; i++) {
+            if(!isLogRowDead(p_logs, inds[i]))
+                roaringAdd(p_rows, inds[i]);
+        }
+        memFree(MEM_TAG_REFS, inds, ind_cap * sizeof(uint32_t));
+        return;
+    }
+
+    for(size_t i = 0; i < p_logs->n; i++) {
+        if(!isLogRowDead(p_logs, i) && matchLogRow(p_logs, i, p_query->pred, p_query->pred_c, bms))
+            roaringAdd(p_rows, (uint32_t) i);
+    }
+}
+
+
+/// Display the log references in the query window and the aggregates of all
+/// references if the query has a date range or a predicate
+void __displayLogQuery(PlantLogRefs *p_refs, ListQuery *p_query) {
+    PlantAggregates agg = { 0 };
+    if(p_query->has_range || p_query->pred_c) {
+        for(size_t i = 0; i < p_refs->n; i++) {
+            kahanAdd(&agg.production, p_refs->p_entries[i]->production);
+            kahanAdd(&agg.sale_price, p_refs->p_entries[i]->avg_sale_price);
+            agg.n++;
+        }
+    }
+
+    // Sort data only up to the end of the query window
+    size_t k = __queryRowCount(p_query, p_refs->n);
+    __sortLogRefs(p_refs, p_query, k);
+
+    // Display only the rows in the query window
+    PlantLogRefs view = { 0 };
+    if(p_query->offset < p_refs->n) {
+        view.p_entries = p_refs->p_entries + p_query->offset;
+        view.n = k ? p_query->limit : p_refs->n - p_query->offset;
+    }
+    displayLogData(&view);
+
+    if(p_query->has_range) {
+        char from[__DEFAULT_SMALL_BUF_SIZE] = { 0 };
+        strcpy(from, p_query->from == INT32_MIN ? "-" : formatDate(p_query->from));
+        printf("Logs from %s to %s: ", from, p_query->to == INT32_MAX ? "-" : formatDate(p_query->to));
+    }
+    else if(p_query->pred_c)
+        printf("Matching logs: ");
+
+    if(p_query->has_range || p_query->pred_c) {
+        printf("%zu, total production %0.2fMWh, average sale price %0.4f€\n\n", agg.n,
+            kahanValue(&agg.production), agg.n ? kahanValue(&agg.sale_price) / agg.n : 0);
     }
 }
 
 
+/// Find the count of rows that should be sorted to display the query window
+/// Returns 0 if all rows must be sorted
+size_t __queryRowCount(ListQuery *p_query, size_t n) {
+    // No limit was given or the window reaches the end of the data
+    if(!p_query->limit || p_query->offset >= n || p_query->limit >= n - p_query->offset)
+        return 0;
+
+    return p_query->offset + p_query->limit;
+}
+
+
 /// Print out help text
 void showHelp(bool is_sel) {
     // Check if selected mode text or unselected mode text should be shown
@@ -199,8 +379,8 @@ void showHelp(bool is_sel) {
 
 /// Ask information about the new power plant instance from the user
 /// and create a new instance
-void createNewPowerPlant(PowerPlants *p_plants, uint32_t *arg, Hashmap *p_map) {
-    PlantData user_data = promptNewPowerPlant(&p_plants->max_id, p_map);
+void createNewPowerPlant(PowerPlants *p_plants, uint32_t *arg, IdMap *p_map) {
+    PlantData user_data = promptNewPowerPlant(&p_plants->max_id, p_map, &p_plants->arena);
     newPowerPlant(&user_data, p_plants, p_map);
     
     // Set the id argument accordingly
@@ -208,57 +388,221 @@ void createNewPowerPlant(PowerPlants *p_plants, uint32_t *arg, Hashmap *p_map) {
 }
 
 
-/// List all currently available power plants according to
-/// the average utilisation percentage
-void listPowerPlants(PowerPlants *p_plants, ListSortMode smode) {
+/// List all currently available power plants according to specified list query
+void listPowerPlants(PowerPlants *p_plants, ListQuery *p_query) {
     // Allocate memory for power plant references
-    PowerPlantRefs refs = { .n = p_plants->n, .cap = p_plants->cap };
-    refs.p_plants = (PlantData**) calloc(p_plants->cap, sizeof(PlantData*));
+    PowerPlantRefs refs = { .n = 0, .cap = p_plants->cap };
+    refs.p_plants = (PlantData**) memCalloc(MEM_TAG_REFS, p_plants->cap, sizeof(PlantData*));
+
+    // Predicates on indexed fields only are answered from the fuel type index
+    RoaringBitmap bms[LIST_MAX_PREDICATE_C];
+    if(p_query->pred_c && indexPredicate(p_plants, NULL, p_query->pred, p_query->pred_c, bms)) {
+        RoaringBitmap rows = { 0 };
+        size_t ind_cap = p_plants->n ? p_plants->n : 1;
+        uint32_t *inds = (uint32_t*) memAlloc(MEM_TAG_REFS, ind_cap * sizeof(uint32_t));
+        evalPredicateBitmaps(p_query->pred, p_query->pred_c, bms, p_plants->n, &rows);
+
+        refs.n = roaringToArray(&rows, inds);
+        for(size_t i = 0; i < refs.n; i++)
+            refs.p_plants[i] = p_plants->plants + inds[i];
+
+        destroyRoaring(&rows);
+        memFree(MEM_TAG_REFS, inds, ind_cap * sizeof(uint32_t));
+    }
+
+    // Copy pointers of all power plants that match the where clause to newly 
+    // allocated power plant reference array
+    else {
+        for(size_t i = 0; i < p_plants->n; i++) {
+            if(!p_query->pred_c || matchPowerPlant(p_plants->plants + i, p_query->pred, p_query->pred_c))
+                refs.p_plants[refs.n++] = p_plants->plants + i;
+        }
+    }
 
-    // Copy all pointers to newly allocated power plant reference array
-    for(size_t i = 0; i < refs.n; i++)
-        refs.p_plants[i] = p_plants->plants + i;
+    if(p_query->pred_c)
+        destroyPredicateBitmaps(bms, p_query->pred_c);
 
-    // Sort power plants if necessary
-    __sortPowerPlantRefs(&refs, smode);
-    displayPowerPlants(&refs);
+    // Sort power plants if necessary, only rows up to the end of the query window
+    // need to be in order
+    size_t k = __queryRowCount(p_query, refs.n);
+    __sortPowerPlantRefs(&refs, p_query, k);
+
+    // Display only the rows in the query window
+    PowerPlantRefs view = { 0 };
+    if(p_query->offset < refs.n) {
+        view.p_plants = refs.p_plants + p_query->offset;
+        view.n = k ? p_query->limit : refs.n - p_query->offset;
+    }
+    displayPowerPlants(&view);
 
     // Free allocated memory
-    free(refs.p_plants);
+    memFree(MEM_TAG_REFS, refs.p_plants, refs.cap * sizeof(PlantData*));
 }
 
 
-/// List all written logs according to specified sort mode
-void listAllLogs(PlantLogs *p_logs, ListSortMode smode) {
-    // Allocate memory for log references
+/// List all written logs according to specified list query
+/// Date range queries are answered from the date ordered power plant log references
+/// Archived logs are decoded from the blocks that overlap the date range
+void listAllLogs(PowerPlants *p_plants, PlantLogs *p_logs, ListQuery *p_query) {
     PlantLogRefs refs = { 0 };
-    refs.cap = p_logs->cap;
-    refs.n = p_logs->n;
-    refs.p_entries = (LogEntry**) calloc(p_logs->cap, sizeof(LogEntry*));
 
-    // Populate references' array with new log data
-    for(size_t i = 0; i < refs.n; i++)
-        refs.p_entries[i] = p_logs->entries + i;
+    // Comparisons on indexed fields are evaluated into bitmaps of matching rows
+    RoaringBitmap bms[LIST_MAX_PREDICATE_C];
+    bool is_indexed = p_query->pred_c && indexPredicate(p_plants, p_logs, p_query->pred, 
+        p_query->pred_c, bms);
 
-    // Sort all data according to the given sort mode
-    __sortLogRefs(&refs, smode);
-    displayLogData(&refs);
+    // References point into the archive buffer, so it is never reallocated
+    size_t arch_cap = __archivedLogBound(p_plants->plants, p_plants->n, p_query);
+    LogEntry *arch_buf = (LogEntry*) memAlloc(MEM_TAG_REFS, (arch_cap ? arch_cap : 1) * sizeof(LogEntry));
+    size_t arch_n = 0;
 
-    // Free the reference buffer
-    free(refs.p_entries);
+    // Collect the logs in date range from each power plant, archived logs are older
+    // than live logs, so they come first
+    if(p_query->has_range) {
+        for(size_t i = 0; i < p_plants->n; i++) {
+            __collectArchivedLogs(p_plants->plants + i, p_query, arch_buf, &arch_n, &refs);
+            __collectLogDateRange(&p_plants->plants[i].logs, p_query, p_logs, bms, &refs);
+        }
+    }
+
+    // Find the bitmap of matching rows, bitmap rows have the same indices as entries
+    else if(p_query->pred_c) {
+        RoaringBitmap rows = { 0 };
+        __matchingLogRows(p_logs, p_query, bms, is_indexed, &rows);
+
+        size_t ind_cap = p_logs->n ? p_logs->n : 1;
+        uint32_t *inds = (uint32_t*) memAlloc(MEM_TAG_REFS, ind_cap * sizeof(uint32_t));
+        refs.n = roaringToArray(&rows, inds);
+        refs.cap = refs.n ? refs.n : 1;
+        refs.p_entries = (LogEntry**) memAlloc(MEM_TAG_REFS, refs.cap * sizeof(LogEntry*));
+        for(size_t i = 0; i < refs.n; i++)
+            refs.p_entries[i] = p_logs->entries + inds[i];
+
+        destroyRoaring(&rows);
+        memFree(MEM_TAG_REFS, inds, ind_cap * sizeof(uint32_t));
+    }
+
+    // Populate references' array with all log data
+    else {
+        refs.cap = p_logs->cap;
+        refs.p_entries = (LogEntry**) memCalloc(MEM_TAG_REFS, p_logs->cap, sizeof(LogEntry*));
+        for(size_t i = 0; i < p_logs->n; i++) {
+            if(!isLogRowDead(p_logs, i))
+                refs.p_entries[refs.n++] = p_logs->entries + i;
+        }
+    }
+
+    // Archived logs follow the live logs, unless they were collected by date range
+    if(!p_query->has_range) {
+        for(size_t i = 0; i < p_plants->n; i++)
+            __collectArchivedLogs(p_plants->plants + i, p_query, arch_buf, &arch_n, &refs);
+    }
+
+    __displayLogQuery(&refs, p_query);
+
+    // Free the reference and archive buffers and comparison bitmaps
+    memFree(MEM_TAG_REFS, refs.p_entries, refs.cap * sizeof(LogEntry*));
+    memFree(MEM_TAG_REFS, arch_buf, (arch_cap ? arch_cap : 1) * sizeof(LogEntry));
+    if(p_query->pred_c)
+        destroyPredicateBitmaps(bms, p_query->pred_c);
 }
 
 
 /// List all logs that belong to the power plant
-void listPowerPlantLogs(PlantData *plant, ListSortMode smode) {
-    // Sort data and display it to stdout
-    __sortLogRefs(&plant->logs, smode);
-    displayLogData(&plant->logs);
+/// The power plant log references are kept in date order, so the listing is
+/// sorted on a copy of them
+void listPowerPlantLogs(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *plant, ListQuery *p_query) {
+    PlantLogRefs refs = { 0 };
+
+    RoaringBitmap bms[LIST_MAX_PREDICATE_C];
+    if(p_query->pred_c)
+        indexPredicate(p_plants, p_logs, p_query->pred, p_query->pred_c, bms);
+
+    // Archived logs are older than live logs, so they come first
+    size_t arch_cap = __archivedLogBound(plant, 1, p_query);
+    LogEntry *arch_buf = (LogEntry*) memAlloc(MEM_TAG_REFS, (arch_cap ? arch_cap : 1) * sizeof(LogEntry));
+    size_t arch_n = 0;
+
+    if(p_query->has_range) {
+        __collectArchivedLogs(plant, p_query, arch_buf, &arch_n, &refs);
+        __collectLogDateRange(&plant->logs, p_query, p_logs, bms, &refs);
+    }
+    else {
+        refs.cap = plant->logs.n + arch_cap ? plant->logs.n + arch_cap : 1;
+        refs.p_entries = (LogEntry**) memAlloc(MEM_TAG_REFS, refs.cap * sizeof(LogEntry*));
+        __collectArchivedLogs(plant, p_query, arch_buf, &arch_n, &refs);
+        for(size_t i = 0; i < plant->logs.n; i++) {
+            uint32_t row = plant->logs.rows[i];
+            if(!p_query->pred_c || matchLogRow(p_logs, row, p_query->pred, p_query->pred_c, bms))
+                refs.p_entries[refs.n++] = p_logs->entries + row;
+        }
+    }
+
+    __displayLogQuery(&refs, p_query);
+    memFree(MEM_TAG_REFS, refs.p_entries, refs.cap * sizeof(LogEntry*));
+    memFree(MEM_TAG_REFS, arch_buf, (arch_cap ? arch_cap : 1) * sizeof(LogEntry));
+    if(p_query->pred_c)
+        destroyPredicateBitmaps(bms, p_query->pred_c);
+}
+
+
+/// Count the logs that match the query predicate, if no power plant is given,
+/// logs of the whole fleet are counted
+/// Fully indexed predicates are counted from the cardinality of the combined bitmaps,
+/// while archived logs are counted from their block headers or decoded if filtered
+void countLogs(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *p_plant, ListQuery *p_query) {
+    struct timespec beg, end;
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+
+    size_t n = p_plant ? p_plant->logs.n : liveLogCount(p_logs);
+    const char *method = "row count";
+    if(p_query->pred_c) {
+        RoaringBitmap bms[LIST_MAX_PREDICATE_C];
+        bool is_indexed = indexPredicate(p_plants, p_logs, p_query->pred, p_query->pred_c, bms);
+
+        // Logs of a single power plant are scanned from its references, unless
+        // the predicate can be answered from bitmaps
+        if(p_plant && !is_indexed) {
+            n = 0;
+            for(size_t i = 0; i < p_plant->logs.n; i++)
+                n += matchLogRow(p_logs, p_plant->logs.rows[i], p_query->pred, p_query->pred_c, bms);
+            method = "reference scan";
+        }
+
+        else {
+            RoaringBitmap rows = { 0 };
+            __matchingLogRows(p_logs, p_query, bms, is_indexed, &rows);
+            if(p_plant) {
+                RoaringBitmap *p_plant_rows = bitmapIndexFind(&p_logs->plant_idx, p_plant->no);
+                if(p_plant_rows) roaringAnd(&rows, p_plant_rows);
+                else destroyRoaring(&rows);
+            }
+
+            n = roaringCardinality(&rows);
+            method = is_indexed ? "bitmap index" : "column scan";
+            destroyRoaring(&rows);
+        }
+
+        destroyPredicateBitmaps(bms, p_query->pred_c);
+    }
+
+    size_t arch_c = 0;
+    if(p_plant) arch_c = __countArchivedLogs(p_plant, p_query);
+    else {
+        for(size_t i = 0; i < p_plants->n; i++)
+            arch_c += __countArchivedLogs(p_plants->plants + i, p_query);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    if(arch_c)
+        printf("Matching logs: %zu, %zu of them archived (%s in %.2fms)\n\n", n + arch_c, arch_c, method, ms);
+    else printf("Matching logs: %zu (%s in %.2fms)\n\n", n, method, ms);
 }
 
 
 /// Edit power plant properties
-void editPowerPlant(Hashmap *plant_map, uint32_t index) {
+void editPowerPlant(PowerPlants *p_plants, IdMap *plant_map, uint32_t index) {
     // Check if id parsing failed
     if(index == UINT32_MAX) {
         printf("Invalid index given for power plants\n");
@@ -267,7 +611,7 @@ void editPowerPlant(Hashmap *plant_map, uint32_t index) {
     }
 
     // Find the PlantData reference
-    PlantData *data = (PlantData*) findValue(plant_map, &index, sizeof(uint32_t));
+    PlantData *data = findPowerPlant(p_plants, plant_map, index);
         
     // Check if data exists
     if(!data) {
@@ -276,75 +620,60 @@ void editPowerPlant(Hashmap *plant_map, uint32_t index) {
         return;
     }
 
-    promptEditPowerPlant(data);
+    FuelType old_fuel = data->fuel;
+    promptEditPowerPlant(data, &p_plants->arena);
+
+    // Move the power plant row into its new fuel type bitmap
+    if(old_fuel != data->fuel) {
+        removePlantIndexes(p_plants, data - p_plants->plants, old_fuel);
+        addPlantIndexes(p_plants, data - p_plants->plants);
+    }
 }
 
 
 /// Create a new log for certain power plant instance
+/// Power plant log rows and the id map hold row indices, so growing the log array
+/// needs no fix-up
 void newLog (
-    Hashmap *pow_map, 
-    Hashmap *log_map, 
+    IdMap *pow_map, 
+    IdMap *log_map, 
     PowerPlants *p_plants, 
     PlantLogs *p_logs, 
     uint32_t *arg,
     uint32_t sel_id
 ) {
-    LogEntry log = promptNewLogEntry(log_map, &p_logs->max_id, sel_id);
-
-    // Check if value popping is needed for hashmap
-    if(p_logs->n + 1 < p_logs->cap) {
-        for(size_t i = 0; i < p_logs->n; i++)
-            popFromHashmap(log_map, &p_logs->entries[i].log_id, sizeof(uint32_t));
-    }
+    LogEntry log = promptNewLogEntry(log_map, &p_logs->archived_ids, &p_logs->max_id, sel_id);
+    uint32_t row = newPowerPlantLog(&log, p_logs, log_map);
 
-    // Push the log entry to PlantLogs array
-    LogEntry *prev_val = p_logs->entries;
-    reallocCheck((void**) &p_logs->entries, sizeof(LogEntry), p_logs->n + 1,
-        &p_logs->cap); 
+    // Deleted rows are reused, so the row may already be in columns
+    if(p_logs->cols && row < p_logs->cols->n)
+        setLogColumnsRow(p_logs->cols, row, p_logs->entries + row);
+    else if(p_logs->cols)
+        pushLogColumnsRow(p_logs->cols, p_logs->entries + row);
+    addLogIndexes(p_logs, row);
 
-    // Check if reallocation happended and memory addresses should be adjusted
-    if(p_logs->entries - prev_val) {
-        size_t delta = p_logs->entries - prev_val;
-        // For each power plant entry adjust its log memory addresses
-        for(size_t i = 0; i < p_plants->n; i++) {
-            for(size_t j = 0; j < p_plants->plants[i].logs.n; j++)
-                p_plants->plants[i].logs.p_entries[j] += delta;
-        }
-
-        // For each log replace its value in hashmap
-        for(size_t i = 0; i < p_logs->n; i++) {
-            pushToHashmap(log_map, &p_logs->entries[i].log_id, sizeof(uint32_t),
-                p_logs->entries + i);
-        }
-    }
-    
-    p_logs->entries[p_logs->n] = log;
-    p_logs->n++;
-
-    // Push log entry to hashmap
-    pushToHashmap(log_map, &p_logs->entries[p_logs->n - 1].log_id, sizeof(uint32_t), 
-        p_logs->entries + p_logs->n - 1);
-
-    // Retrieve associated power plant instance and push new LogEntry value
+    // Retrieve associated power plant instance and insert the new log row
     // to power plant logs' data
-    PlantData *p_pow_data = (PlantData*) findValue(pow_map, &sel_id, sizeof(uint32_t));
-
-    reallocCheck((void**) &p_pow_data->logs.p_entries, sizeof(LogEntry*), p_pow_data->logs.n,
-        &p_pow_data->logs.cap);
-    p_pow_data->logs.p_entries[p_pow_data->logs.n] = p_logs->entries + p_logs->n - 1;
-    p_pow_data->logs.n++;
+    PlantData *p_pow_data = findPowerPlant(p_plants, pow_map, sel_id);
+    __insertLogRef(&p_plants->arena, &p_pow_data->logs, p_logs->entries, row);
 
-    // Recalculate average cost and utilisation
-    calcAvgCost(p_pow_data);
-    calcAvgUtilisation(p_pow_data);
+    // Update the running aggregates with the new log
+    addLogAggregates(p_pow_data, p_logs->entries + row);
 
     // Set the id argument value accordingly
-    *arg = p_logs->entries[p_logs->n - 1].log_id;
+    *arg = p_logs->entries[row].log_id;
 }
 
 
 /// Edit the power plant log data
-void editLog(Hashmap *plant_map, Hashmap *log_map, uint32_t sel_id, uint32_t index) {
+void editLog (
+    PowerPlants *p_plants, 
+    PlantLogs *p_logs, 
+    IdMap *plant_map, 
+    IdMap *log_map, 
+    uint32_t sel_id, 
+    uint32_t index
+) {
     // Check if the id was given
     if(index == UINT32_MAX) {
         printf("Invalid index given for power plant logs\n");
@@ -353,7 +682,7 @@ void editLog(Hashmap *plant_map, Hashmap *log_map, uint32_t sel_id, uint32_t ind
     }
 
     // Retrieve the LogEntry reference from the map 
-    LogEntry *log = findValue(log_map, &index, sizeof(uint32_t));
+    LogEntry *log = findLog(p_logs, log_map, index);
 
     // Check if the retrieval was successful
     if(!log || log->plant_no != sel_id) {
@@ -362,18 +691,36 @@ void editLog(Hashmap *plant_map, Hashmap *log_map, uint32_t sel_id, uint32_t ind
         return;
     }
 
-    promptEditLog(log);
-
-    // Find the associated plant data and update its average cost 
-    // and utilisation
-    PlantData *plant = (PlantData*) findValue(plant_map, &log->plant_no, sizeof(uint32_t));
-    calcAvgUtilisation(plant);
-    calcAvgCost(plant);
+    // A copy is edited, since the row must be removed from the date ordered log rows
+    // while its date is still the old date
+    LogEntry old = *log;
+    LogEntry edited = old;
+    uint32_t row = (uint32_t) (log - p_logs->entries);
+    promptEditLog(&edited);
+
+    PlantData *plant = findPowerPlant(p_plants, plant_map, old.plant_no);
+    if(old.date != edited.date)
+        __removeLogRef(&plant->logs, p_logs->entries, row, old.date);
+
+    *log = edited;
+    if(p_logs->cols)
+        setLogColumnsRow(p_logs->cols, row, log);
+
+    // Replace the old log values in the running aggregates of the power plant
+    removeLogAggregates(plant, &old);
+    addLogAggregates(plant, log);
+
+    // Keep the power plant log rows in date order and the row in the bitmap of its month
+    if(old.date != log->date) {
+        __insertLogRef(&p_plants->arena, &plant->logs, p_logs->entries, row);
+        removeLogIndexes(p_logs, row, &old);
+        addLogIndexes(p_logs, row);
+    }
 }
 
 
 /// Delete a power plant entry
-void deletePowerPlant(PowerPlants *p_plants, Hashmap *plant_map, uint32_t index) {
+void deletePowerPlant(PowerPlants *p_plants, IdMap *plant_map, uint32_t index) {
     // Check if the id was given
     if(index == UINT32_MAX) {
         printf("Invalid delete index given for power plants\n");
@@ -381,40 +728,50 @@ void deletePowerPlant(PowerPlants *p_plants, Hashmap *plant_map, uint32_t index)
         return;
     }
 
-    PlantData *p_pop_plant = (PlantData*) popFromHashmap(plant_map, &index, sizeof(uint32_t));
+    uint32_t a_ind = idMapRemove(plant_map, index);
 
     // Check if no elements were found in the map
-    if(!p_pop_plant) {
+    if(a_ind == ID_MAP_NONE) {
         printf("Cannot delete power plant entry with id %u\n"\
                "Power plant not available\n\n", index);
         return;
     }
 
-    // Free memory allocated for log instances
-    free(p_pop_plant->logs.p_entries);
-    // Free memory allocated for plant name
-    free(p_pop_plant->name);
-
-    // Find the memory area index in array
-    size_t a_ind = p_pop_plant - p_plants->plants; 
-
-    // For each element after the popped plant instance, shift the elements in array to left
+    // Free memory allocated for log rows, archive, rollups and sketches
+    PlantData *p_pop_plant = p_plants->plants + a_ind;
+    freePlantLogRows(&p_plants->arena, &p_pop_plant->logs);
+    destroyPlantArchive(&p_pop_plant->archive);
+    destroyPlantRollup(&p_pop_plant->rollup);
+    destroyPlantSketches(&p_pop_plant->sketch);
+    // Return the plant name to the arena
+    arenaFree(&p_plants->arena, p_pop_plant->name, strlen(p_pop_plant->name) + 1);
+
+    // For each element after the popped plant instance, shift the elements in array 
+    // to left and map their new rows
     for(size_t i = a_ind + 1; i < p_plants->n; i++) {
-        // Pop the previous reference from the map and push the new one
-        PlantData *data = (PlantData*) popFromHashmap(plant_map, &p_plants->plants[i].no,
-            sizeof(uint32_t));
         p_plants->plants[i - 1] = p_plants->plants[i];
-        pushToHashmap(plant_map, &p_plants->plants[i - 1].no, sizeof(uint32_t),
-            p_plants->plants + i - 1);
+        idMapPut(plant_map, p_plants->plants[i - 1].no, (uint32_t) (i - 1));
     }
 
     memset(p_plants->plants + p_plants->n - 1, 0, sizeof(PlantData));
     p_plants->n--;
+
+    // Power plant rows after the deleted one were shifted
+    rebuildPlantIndexes(p_plants);
 }
 
 
 /// Delete a log entry
-void deleteLog(PlantLogs *p_logs, Hashmap *pow_map, Hashmap *log_map, uint32_t sel_id, uint32_t index) {
+/// The row is tombstoned instead of shifting the following rows, and the logs are
+/// compacted once enough rows are deleted
+void deleteLog (
+    PowerPlants *p_plants, 
+    PlantLogs *p_logs, 
+    IdMap *pow_map, 
+    IdMap *log_map, 
+    uint32_t sel_id, 
+    uint32_t index
+) {
     // Check if delete index was correct
     if(index == UINT32_MAX) {
         printf("Invalid delete index given for power plants\n");
@@ -422,7 +779,7 @@ void deleteLog(PlantLogs *p_logs, Hashmap *pow_map, Hashmap *log_map, uint32_t s
         return;
     }
 
-    LogEntry *del_entry = (LogEntry*) findValue(log_map, &index, sizeof(uint32_t));
+    LogEntry *del_entry = findLog(p_logs, log_map, index);
 
     // Check if no entries were found in the map
     if(!del_entry || del_entry->plant_no != sel_id) {
@@ -431,42 +788,149 @@ void deleteLog(PlantLogs *p_logs, Hashmap *pow_map, Hashmap *log_map, uint32_t s
         return;
     }
     
-    // Find the memory area index in array
-    size_t a_ind = del_entry - p_logs->entries;
+    // Find the row of the entry in array
+    uint32_t a_ind = (uint32_t) (del_entry - p_logs->entries);
 
     // Retrieve the associated plant data instance
-    PlantData *p_data = (PlantData*) findValue(pow_map, &del_entry->plant_no, sizeof(uint32_t));
-
-    // For each element after the popped value, shift elements to the left
-    for(size_t i = a_ind + 1; i < p_logs->n; i++) {
-        // Pop the previous reference from the hashmap and push it back with
-        // correct pointer value
-        LogEntry *p_entry = (LogEntry*) popFromHashmap(log_map, &p_logs->entries[i].log_id, sizeof(uint32_t));
-        p_logs->entries[i - 1] = p_logs->entries[i];
-        pushToHashmap(log_map, &p_logs->entries[i - 1].log_id, sizeof(uint32_t), 
-            p_logs->entries + i - 1);
-    }
-       
-    
+    PlantData *p_data = findPowerPlant(p_plants, pow_map, del_entry->plant_no);
+    removeLogAggregates(p_data, del_entry);
+    __removeLogRef(&p_data->logs, p_logs->entries, a_ind, del_entry->date);
+    removeLogIndexes(p_logs, a_ind, del_entry);
+    idMapRemove(log_map, index);
+    freeLogRow(p_logs, a_ind);
+
+    if(shouldCompactLogs(p_logs))
+        compactLogs(p_plants, p_logs, log_map);
+}
 
-    // For each log entry check and select new value for associated PowerPlant instance
-    for(size_t i = 0, j = 0; i < p_logs->n; i++) {
-        if(p_logs->entries[i].plant_no == p_data->no) {
-            p_data->logs.p_entries[j] = p_logs->entries + i;
-            j++;
-        }
+
+/// Remove all deleted log rows from the log array
+void compactLogArray(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *log_map) {
+    struct timespec beg, end;
+    size_t row_c = p_logs->n;
+
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+    size_t dead_c = compactLogs(p_plants, p_logs, log_map);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    printf("Removed %zu deleted log row(s) out of %zu in %.2fms\n\n", dead_c, row_c, ms);
+}
+
+
+/// Move all logs older than the given amount of days before the latest log date
+/// into the compressed archives of their power plants
+void archiveOldLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *log_map, size_t days) {
+    // Date ordered rows give the latest log date of each power plant
+    int32_t last_day = INT32_MIN;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantLogRows *p_rows = &p_plants->plants[i].logs;
+        if(p_rows->n && p_logs->entries[p_rows->rows[p_rows->n - 1]].date > last_day)
+            last_day = p_logs->entries[p_rows->rows[p_rows->n - 1]].date;
     }
 
-    // Set the deprecated log data value to zero
-    memset(p_logs->entries + p_logs->n - 1, 0, sizeof(LogEntry));
-    p_logs->n--;
-    memset(p_data->logs.p_entries + p_data->logs.n - 1, 0, sizeof(LogEntry*));
-    p_data->logs.n--;
+    if(last_day == INT32_MIN) {
+        printf("No live logs available\n\n");
+        return;
+    }
+
+    // Logs dated before the cutoff day are archived
+    int64_t cutoff_day = (int64_t) last_day - (int64_t) days;
+    int32_t cutoff = cutoff_day < INT32_MIN ? INT32_MIN : (int32_t) cutoff_day;
+
+    struct timespec beg, end;
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+    size_t arch_c = archiveLogs(p_plants, p_logs, log_map, cutoff);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    printf("Archived %zu log(s) dated before %s in %.2fms, %zu log(s) archived in total\n\n", arch_c, 
+        formatDate(cutoff), ms, archivedLogCount(p_plants));
+}
+
+
+/// Display live, peak and slack bytes of each subsystem
+/// Slack is found from the capacities of the long lived arrays, temporary
+/// listing, parser and sorting memory has no slack between commands
+void showMemoryUsage(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *pow_map, IdMap *log_map) {
+    size_t slack[MEM_TAG_C] = { 0 };
+
+    // Unused power plant slots, arena memory and log row and rollup capacities
+    slack[MEM_TAG_PLANTS] = (p_plants->cap - p_plants->n) * sizeof(PlantData) + 
+        (p_plants->arena.reserved - p_plants->arena.used);
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        if(!p_plant->logs.is_slice)
+            slack[MEM_TAG_PLANTS] += (p_plant->logs.cap - p_plant->logs.n) * sizeof(uint32_t);
+        slack[MEM_TAG_PLANTS] += (p_plant->rollup.cap - p_plant->rollup.n) * sizeof(PlantAggregates);
+    }
+
+    // Deleted rows take as much memory as unused log slots
+    slack[p_logs->store ? MEM_TAG_STORE : MEM_TAG_LOGS] = (p_logs->cap - liveLogCount(p_logs)) * sizeof(LogEntry);
+    slack[MEM_TAG_LOGS] += (p_logs->tombs.cap - p_logs->tombs.n) * sizeof(uint32_t);
+    if(p_logs->cols)
+        slack[MEM_TAG_LOGS] += (p_logs->cols->cap - p_logs->cols->n) * LOG_COLUMNS_ROW_SIZE;
+
+    slack[MEM_TAG_MAPS] = (pow_map->cap - pow_map->n) * sizeof(IdMapSlot) + 
+        (log_map->cap - log_map->n) * sizeof(IdMapSlot) + bitmapIndexSlack(&p_plants->fuel_idx) +
+        bitmapIndexSlack(&p_logs->plant_idx) + bitmapIndexSlack(&p_logs->month_idx);
+
+    for(size_t i = 0; i < p_plants->n; i++)
+        slack[MEM_TAG_ARCHIVE] += plantArchiveSlack(&p_plants->plants[i].archive);
+
+    printf("%-12s %14s %14s %14s %12s\n", "Subsystem", "Live", "Peak", "Slack", "Allocations");
+    MemTagStats total = { 0 };
+    size_t total_slack = 0;
+    for(MemTag tag = 0; tag < MEM_TAG_C; tag++) {
+        MemTagStats stats = memTagStats(tag);
+        printf("%-12s %12zuB %12zuB %12zuB %12zu\n", memTagToStr(tag), stats.live, stats.peak, 
+            slack[tag], stats.alloc_c);
+
+        // Mapped log rows are paged from the data file, so they are not counted into heap totals
+        if(tag == MEM_TAG_STORE) continue;
+
+        // Peaks of subsystems are not simultaneous, so the total peak is an upper bound
+        total.live += stats.live;
+        total.peak += stats.peak;
+        total.alloc_c += stats.alloc_c;
+        total_slack += slack[tag];
+    }
+    printf("%-12s %12zuB %12zuB %12zuB %12zu\n", "total", total.live, total.peak, total_slack, 
+        total.alloc_c);
+
+    printf("Arena: %zuB reserved, %zuB used\n", p_plants->arena.reserved, p_plants->arena.used);
+
+    // Mapped log rows are paged from the data file and only the touched pages are resident
+    if(p_logs->store) {
+        printf("Data store: %zuB file, %zuB mapped log rows\n", p_logs->store->size, 
+            p_logs->cap * sizeof(LogEntry));
+    }
+
+    // Peak resident set size is sampled by the kernel, so it can lag behind the current size
+    size_t rss = residentSetSize(), peak_rss = peakResidentSetSize();
+    printf("Resident set: %zuKiB current, %zuKiB peak\n", rss >> 10, (peak_rss > rss ? peak_rss : rss) >> 10);
+
+    // Bytes per log are the figure to extrapolate memory usage for bigger log files from
+    size_t log_c = liveLogCount(p_logs);
+    MemTagStats log_stats = memTagStats(MEM_TAG_LOGS);
+    MemTagStats map_stats = memTagStats(MEM_TAG_MAPS);
+    printf("Live logs: %zu\n", log_c);
+    if(log_c) {
+        printf("Bytes per log: %.2fB total, %.2fB in log storage, %.2fB in maps\n", 
+            (double) total.live / log_c, (double) log_stats.live / log_c, (double) map_stats.live / log_c);
+    }
+
+    size_t arch_c = archivedLogCount(p_plants);
+    if(arch_c) {
+        MemTagStats arch_stats = memTagStats(MEM_TAG_ARCHIVE);
+        printf("Archived logs: %zu, %.2fB per archived log\n", arch_c, (double) arch_stats.live / arch_c);
+    }
+    printf("\n");
 }
 
 
 /// Check if the user provided selection id is available for selection
-void selectionCheck(uint32_t *p_sel_val, uint32_t arg, Hashmap *p_map) {
+void selectionCheck(uint32_t *p_sel_val, uint32_t arg, IdMap *p_map) {
     // Check if the id is valid
     if(arg == UINT32_MAX) {
         printf("Invalid selection id given\n");
@@ -475,7 +939,7 @@ void selectionCheck(uint32_t *p_sel_val, uint32_t arg, Hashmap *p_map) {
     }
 
     // Check if argument value is a valid key value in the given map
-    if(!findValue(p_map, &arg, sizeof(uint32_t))) {
+    if(idMapFind(p_map, arg) == ID_MAP_NONE) {
         printf("Cannot select power plant with id %u\n"
                "Power plant not available\n\n", arg);
     }
@@ -484,7 +948,493 @@ void selectionCheck(uint32_t *p_sel_val, uint32_t arg, Hashmap *p_map) {
 }
 
 
+/// Display fleet-wide statistics over all logs
+/// Live logs are reduced from log columns, while archived logs are decoded block by block
+void showLogStats(PowerPlants *p_plants, PlantLogs *p_logs) {
+    const size_t arch_c = archivedLogCount(p_plants);
+    if(!liveLogCount(p_logs) && !arch_c) {
+        printf("No logs available\n\n");
+        return;
+    }
+
+    // Use a temporary columnar copy if the logs are not stored in columns or
+    // the columns contain deleted rows
+    LogColumns tmp = { 0 };
+    LogColumns *p_cols = p_logs->cols;
+    if(!p_cols || p_logs->tombs.n) {
+        newLogColumns(&tmp, p_logs);
+        p_cols = &tmp;
+    }
+
+    const size_t live_n = p_cols->n;
+    double total_prod = 0, total_price = 0;
+    float min_prod = INFINITY, max_prod = -INFINITY, min_price = INFINITY, max_price = -INFINITY;
+    int32_t first_day = INT32_MAX, last_day = INT32_MIN;
+    if(live_n) {
+        total_prod = columnSumf(p_cols->production, live_n);
+        total_price = columnSumf(p_cols->avg_sale_price, live_n);
+        min_prod = columnMinf(p_cols->production, live_n);
+        max_prod = columnMaxf(p_cols->production, live_n);
+        min_price = columnMinf(p_cols->avg_sale_price, live_n);
+        max_price = columnMaxf(p_cols->avg_sale_price, live_n);
+        first_day = columnMini32(p_cols->date, live_n);
+        last_day = columnMaxi32(p_cols->date, live_n);
+    }
+
+    // Archived logs are decoded one block at a time, block headers give the date range
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantArchive *p_arch = &p_plants->plants[i].archive;
+        for(size_t j = 0; j < p_arch->n; j++) {
+            size_t block_n = decodeArchiveBlock(p_arch->blocks + j, p_plants->plants[i].no, block);
+            for(size_t k = 0; k < block_n; k++) {
+                total_prod += block[k].production;
+                total_price += block[k].avg_sale_price;
+                if(block[k].production < min_prod) min_prod = block[k].production;
+                if(block[k].production > max_prod) max_prod = block[k].production;
+                if(block[k].avg_sale_price < min_price) min_price = block[k].avg_sale_price;
+                if(block[k].avg_sale_price > max_price) max_price = block[k].avg_sale_price;
+            }
+
+            if(p_arch->blocks[j].first_date < first_day) first_day = p_arch->blocks[j].first_date;
+            if(p_arch->blocks[j].last_date > last_day) last_day = p_arch->blocks[j].last_date;
+        }
+    }
+
+    const size_t n = live_n + arch_c;
+    printf("Fleet-wide log statistics (%zu logs)\n", n);
+    if(arch_c)
+        printf("  Archived logs: %zu\n", arch_c);
+    printf("  Total production: %.2fMWh\n", total_prod);
+    printf("  Production per log: %.2fMWh avg, %.2fMWh min, %.2fMWh max\n", total_prod / n,
+        min_prod, max_prod);
+    printf("  Average sale price: %.4f€ avg, %.4f€ min, %.4f€ max\n", total_price / n,
+        min_price, max_price);
+    printf("  First log date: %s\n", formatDate(first_day));
+    printf("  Last log date: %s\n", formatDate(last_day));
+
+    // Find the rows with the maximum production and display them
+    size_t ind_cap = live_n ? live_n : 1;
+    uint32_t *inds = (uint32_t*) memAlloc(MEM_TAG_REFS, ind_cap * sizeof(uint32_t));
+    size_t ind_c = live_n ? columnFilterRangef(p_cols->production, live_n, max_prod, max_prod, inds) : 0;
+
+    LogEntry *rows = NULL;
+    size_t row_c = 0, row_cap = 0;
+    for(size_t i = 0; i < ind_c; i++) {
+        memReallocCheck(MEM_TAG_REFS, (void**) &rows, sizeof(LogEntry), row_c + 1, &row_cap);
+        rows[row_c++] = getLogColumnsRow(p_cols, inds[i]);
+    }
+
+    // Archived logs with the maximum production are found by decoding the blocks again
+    for(size_t i = 0; i < p_plants->n && arch_c; i++) {
+        PlantArchive *p_arch = &p_plants->plants[i].archive;
+        for(size_t j = 0; j < p_arch->n; j++) {
+            size_t block_n = decodeArchiveBlock(p_arch->blocks + j, p_plants->plants[i].no, block);
+            for(size_t k = 0; k < block_n; k++) {
+                if(block[k].production != max_prod) continue;
+                memReallocCheck(MEM_TAG_REFS, (void**) &rows, sizeof(LogEntry), row_c + 1, &row_cap);
+                rows[row_c++] = block[k];
+            }
+        }
+    }
+
+    PlantLogRefs refs = { .n = row_c, .cap = row_c };
+    refs.p_entries = (LogEntry**) memAlloc(MEM_TAG_REFS, (row_c ? row_c : 1) * sizeof(LogEntry*));
+    for(size_t i = 0; i < row_c; i++)
+        refs.p_entries[i] = rows + i;
+
+    printf("Logs with the highest production:\n");
+    displayLogData(&refs);
+
+    memFree(MEM_TAG_REFS, refs.p_entries, (row_c ? row_c : 1) * sizeof(LogEntry*));
+    memFree(MEM_TAG_REFS, rows, row_cap * sizeof(LogEntry));
+    memFree(MEM_TAG_REFS, inds, ind_cap * sizeof(uint32_t));
+    if(p_cols == &tmp)
+        destroyLogColumns(&tmp);
+}
+
+
+/// Display fleet-wide statistics grouped by power plant fuel type
+/// If thread_c is 0, the amount of threads is chosen automatically
+void showFuelStats(PowerPlants *p_plants, PlantLogs *p_logs, size_t thread_c) {
+    FuelStats stats[FUEL_TYPE_C];
+    struct timespec beg, end;
+
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+    thread_c = calcFuelStats(p_plants, p_logs, thread_c, stats);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    printf("Statistics per fuel type: \n"\
+           "%-12s %8s %16s %19s %16s %15s\n", "Fuel", "Plants", "Rated capacity", 
+           "Total production", "Avg utilisation", "Avg sale price");
+
+    for(size_t i = 0; i < FUEL_TYPE_C; i++) {
+        FuelStats *p_stats = stats + i;
+        if(!p_stats->plant_c && !p_stats->log_c)
+            continue;
+
+        char *fuel = fuelTypeToStr((FuelType) i);
+        double rated_prod = kahanValue(&p_stats->rated_prod);
+        double util = rated_prod > 0 ? kahanValue(&p_stats->production) / rated_prod * 100 : 0;
+        double price = p_stats->log_c ? kahanValue(&p_stats->sale_price) / p_stats->log_c : 0;
+
+        printf("%-12s %8zu %14.2fMW %16.2fMWh %15.2f%% %14.4f€\n", fuel ? fuel : "unknown",
+            p_stats->plant_c, p_stats->rated_cap, kahanValue(&p_stats->production), util, price);
+    }
+
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    printf("Reduced %zu logs with %zu thread(s) in %.2fms\n\n", liveLogCount(p_logs), thread_c, ms);
+}
+
+
+/// Display a single row of estimated quantiles from the digest
+void __displayQuantileRow(const char *label, TDigest *p_td, ListQuery *p_query) {
+    // Pad the values so that units line up with the 15 character wide headers
+    bool is_prod = p_query->qfield == QUANTILE_FIELD_PRODUCTION;
+    printf("%-16s %10.0f", label, p_td->weight);
+    for(size_t i = 0; i < p_query->quantile_c; i++)
+        printf(" %*.4f%s", is_prod ? 12 : 14, tdigestQuantile(p_td, p_query->quantiles[i]), 
+            is_prod ? "MWh" : "€");
+    printf("\n");
+}
+
+
+/// Display estimated quantiles of the log field for the given power plant, if no plant
+/// is given, quantiles for the whole fleet and each fuel type are displayed
+void showQuantiles(PowerPlants *p_plants, PlantLogs *p_logs, PlantData *p_plant, ListQuery *p_query) {
+    printf("%s quantiles: \n%-16s %10s", p_query->qfield == QUANTILE_FIELD_PRODUCTION ? 
+        "Production" : "Sale price", "", "Logs");
+    for(size_t i = 0; i < p_query->quantile_c; i++) {
+        char head[__DEFAULT_SMALL_BUF_SIZE] = { 0 };
+        sprintf(head, "p%g", p_query->quantiles[i] * 100);
+        printf(" %15s", head);
+    }
+    printf("\n");
+
+    if(p_plant) {
+        refreshPlantSketches(p_plant, p_logs);
+        TDigest *p_td = p_query->qfield == QUANTILE_FIELD_PRODUCTION ? 
+            &p_plant->sketch.production : &p_plant->sketch.sale_price;
+        __displayQuantileRow(p_plant->name, p_td, p_query);
+        printf("\n");
+        return;
+    }
+
+    // Fuel type and fleet sketches are merged from the power plant sketches
+    TDigest fuel_tds[FUEL_TYPE_C] = { 0 };
+    TDigest fleet_td = { 0 };
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_data = p_plants->plants + i;
+        FuelType fuel = p_data->fuel < FUEL_TYPE_C ? p_data->fuel : FUEL_TYPE_UNKNOWN;
+
+        refreshPlantSketches(p_data, p_logs);
+        tdigestMerge(fuel_tds + fuel, p_query->qfield == QUANTILE_FIELD_PRODUCTION ? 
+            &p_data->sketch.production : &p_data->sketch.sale_price);
+    }
+
+    for(size_t i = 0; i < FUEL_TYPE_C; i++)
+        tdigestMerge(&fleet_td, fuel_tds + i);
+
+    __displayQuantileRow("fleet", &fleet_td, p_query);
+    for(size_t i = 0; i < FUEL_TYPE_C; i++) {
+        if(!fuel_tds[i].weight) continue;
+
+        char *fuel = fuelTypeToStr((FuelType) i);
+        __displayQuantileRow(fuel ? fuel : "unknown", fuel_tds + i, p_query);
+        destroyTDigest(fuel_tds + i);
+    }
+
+    destroyTDigest(&fleet_td);
+    printf("\n");
+}
+
+
+/// Copy all logs of the power plant into a new array in date order, where archived
+/// logs are decoded and merged with the live logs
+/// Returns the amount of logs in the array
+size_t __plantLogsByDate(PlantLogs *p_logs, PlantData *p_plant, LogEntry **p_out) {
+    const size_t live_n = p_plant->logs.n, arch_n = p_plant->archive.log_c;
+    LogEntry *out = (LogEntry*) memAlloc(MEM_TAG_REFS, (live_n + arch_n ? live_n + arch_n : 1) * sizeof(LogEntry));
+    if(!out) {
+        fprintf(stderr, "Failed to allocate memory for power plant logs\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Decode the archive after the space of live logs and merge forward, which never
+    // overwrites an archived log that is not merged yet
+    LogEntry *arch = out + live_n;
+    scanPlantArchive(&p_plant->archive, p_plant->no, INT32_MIN, INT32_MAX, arch);
+
+    size_t i = 0, j = 0, k = 0;
+    while(i < arch_n || j < live_n) {
+        LogEntry *p_live = j < live_n ? p_logs->entries + p_plant->logs.rows[j] : NULL;
+        if(!p_live || (i < arch_n && arch[i].date <= p_live->date))
+            out[k++] = arch[i++];
+        else out[k++] = *p_live, j++;
+    }
+
+    *p_out = out;
+    return live_n + arch_n;
+}
+
+
+/// Display the rolling utilisation of the power plant for each day, where
+/// utilisation is the production of the last given amount of days relative to
+/// the rated production of those days
+/// Days without logs count as days without production
+void showRolling(PlantLogs *p_logs, PlantData *p_plant, size_t days) {
+    if(!days || days > __MAX_ROLLING_DAYS) {
+        printf("Invalid rolling window length, must be between 1 and %d days\n\n", __MAX_ROLLING_DAYS);
+        return;
+    }
+
+    if(!p_plant->logs.n && !p_plant->archive.log_c) {
+        printf("No logs available\n\n");
+        return;
+    }
+
+    // Date ordered logs give the first and the last logged day
+    LogEntry *entries;
+    const size_t n = __plantLogsByDate(p_logs, p_plant, &entries);
+    const int32_t first_day = entries[0].date;
+    const int32_t last_day = entries[n - 1].date;
+    if((int64_t) last_day - first_day + 1 < (int64_t) days) {
+        printf("Logs span only %d day(s), which is less than the %zu day window\n\n", 
+            last_day - first_day + 1, days);
+        memFree(MEM_TAG_REFS, entries, n * sizeof(LogEntry));
+        return;
+    }
+
+    const double rated_prod = p_plant->rated_cap * 24.0 * days;
+    printf("%zu-day rolling utilisation for power plant nr %u (%s): \n"\
+           "%-10s %16s %19s %12s %16s %16s\n", days, p_plant->no, p_plant->name, "Day", 
+           "Production", "Window production", "Utilisation", "Window min", "Window max");
+
+    RollingWindow win;
+    newRollingWindow(&win, days);
+
+    double min_util = INFINITY, max_util = -INFINITY;
+    int32_t min_day = first_day, max_day = first_day;
+    size_t ref_i = 0;
+    for(int32_t day = first_day; day <= last_day; day++) {
+        // Sum the production of all logs of the day
+        double prod = 0;
+        for(; ref_i < n && entries[ref_i].date == day; ref_i++)
+            prod += entries[ref_i].production;
+
+        pushRollingWindow(&win, day, prod);
+        if(day - first_day + 1 < (int32_t) days)
+            continue;
+
+        double util = rated_prod > 0 ? rollingSum(&win) / rated_prod * 100 : 0;
+        if(util < min_util) min_util = util, min_day = day;
+        if(util > max_util) max_util = util, max_day = day;
+
+        printf("%-10s %13.2fMWh %16.2fMWh %11.2f%% %13.2fMWh %13.2fMWh\n", formatDate(day), prod,
+            rollingSum(&win), util, rollingMin(&win), rollingMax(&win));
+    }
+
+    printf("Lowest utilisation %.2f%% in the window ending at %s\n", min_util, formatDate(min_day));
+    printf("Highest utilisation %.2f%% in the window ending at %s\n\n", max_util, formatDate(max_day));
+    destroyRollingWindow(&win);
+    memFree(MEM_TAG_REFS, entries, n * sizeof(LogEntry));
+}
+
+
+/// Write the display label of the group key into the buffer
+void __formatGroupKey(GroupKey key, uint32_t val, PowerPlants *p_plants, char *buf) {
+    switch(key) {
+    case GROUP_KEY_PLANT: {
+        // Show the power plant name next to its number if the plant still exists
+        char *name = NULL;
+        for(size_t i = 0; i < p_plants->n && !name; i++) {
+            if(p_plants->plants[i].no == val)
+                name = p_plants->plants[i].name;
+        }
+        snprintf(buf, __DEFAULT_SMALL_BUF_SIZE, "%u %s", val, name ? name : "(deleted)");
+        break;
+    }
+
+    case GROUP_KEY_FUEL: {
+        char *fuel = fuelTypeToStr((FuelType) val);
+        snprintf(buf, __DEFAULT_SMALL_BUF_SIZE, "%s", fuel ? fuel : "unknown");
+        break;
+    }
+
+    case GROUP_KEY_MONTH: {
+        int32_t month = monthIndexKeyToMonth(val);
+        int32_t year = (month >= 0 ? month : month - 11) / 12;
+        snprintf(buf, __DEFAULT_SMALL_BUF_SIZE, "%04d-%02d", 1970 + year, month - year * 12 + 1);
+        break;
+    }
+
+    case GROUP_KEY_WEEKDAY:
+        snprintf(buf, __DEFAULT_SMALL_BUF_SIZE, "%s", val < 7 ? __weekday_names[val] : "unknown");
+        break;
+
+    default:
+        snprintf(buf, __DEFAULT_SMALL_BUF_SIZE, "%u", val);
+        break;
+    }
+}
+
+
+/// Display the aggregate of the log field for each group of logs, where logs are
+/// grouped by the query group key and filtered by the query predicate
+void showGroupAggregates(PowerPlants *p_plants, PlantLogs *p_logs, ListQuery *p_query) {
+    struct timespec beg, end;
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+
+    // Only the rows matching the predicate are aggregated
+    RoaringBitmap rows = { 0 };
+    if(p_query->pred_c) {
+        RoaringBitmap bms[LIST_MAX_PREDICATE_C];
+        bool is_indexed = indexPredicate(p_plants, p_logs, p_query->pred, p_query->pred_c, bms);
+        __matchingLogRows(p_logs, p_query, bms, is_indexed, &rows);
+        destroyPredicateBitmaps(bms, p_query->pred_c);
+    }
+
+    GroupTable table;
+    size_t thread_c = groupLogs(p_plants, p_logs, p_query->group_key, p_query->qfield, 
+        p_query->pred_c ? &rows : NULL, p_query->pred, p_query->pred_c, 0, &table);
+    destroyRoaring(&rows);
+
+    // Collect the used hash table slots and order them by group key
+    size_t agg_cap = table.n ? table.n : 1;
+    GroupAggregate *aggs = (GroupAggregate*) memAlloc(MEM_TAG_SORT, agg_cap * sizeof(GroupAggregate));
+    size_t n = 0;
+    for(size_t i = 0; i < table.cap; i++) {
+        if(table.slots[i].n)
+            aggs[n++] = table.slots[i];
+    }
+
+    if(n) {
+        mergesort(aggs, offsetof(GroupAggregate, key), sizeof(GroupAggregate), false,
+            SORT_VALUE_TYPE_UINT32, false, 0, n - 1);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    char head[__DEFAULT_SMALL_BUF_SIZE] = { 0 };
+    bool is_count = p_query->agg_func == GROUP_AGG_FUNC_COUNT;
+    sprintf(head, "%s(%s)", __group_func_names[p_query->agg_func], is_count ? "*" :
+        p_query->qfield == QUANTILE_FIELD_PRODUCTION ? "production" : "price");
+    printf("Logs grouped by %s: \n%-40s %10s %20s\n", __group_key_names[p_query->group_key], 
+        __group_key_names[p_query->group_key], "Logs", head);
+
+    size_t log_c = 0;
+    for(size_t i = 0; i < n; i++) {
+        char label[__DEFAULT_SMALL_BUF_SIZE] = { 0 };
+        __formatGroupKey(p_query->group_key, aggs[i].key, p_plants, label);
+        printf("%-40s %10zu %20.*f\n", label, aggs[i].n, is_count ? 0 : 4, 
+            groupAggregateValue(aggs + i, p_query->agg_func));
+        log_c += aggs[i].n;
+    }
+
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    printf("Aggregated %zu logs into %zu group(s) with %zu thread(s) in %.2fms\n\n", log_c, n, 
+        thread_c, ms);
+
+    memFree(MEM_TAG_SORT, aggs, agg_cap * sizeof(GroupAggregate));
+    destroyGroupTable(&table);
+}
+
+
+/// Display power plants ranked by the increasing utilisation of the given amount
+/// of days up to the latest log date of the fleet
+void showRollingRanking(PowerPlants *p_plants, PlantLogs *p_logs, size_t days) {
+    if(!days || days > __MAX_ROLLING_DAYS) {
+        printf("Invalid rolling window length, must be between 1 and %d days\n\n", __MAX_ROLLING_DAYS);
+        return;
+    }
+
+    // Find the latest log date of the fleet, which is the end of the current window
+    int32_t last_day = INT32_MIN;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantLogRows *p_rows = &p_plants->plants[i].logs;
+        PlantArchive *p_arch = &p_plants->plants[i].archive;
+        if(p_rows->n && p_logs->entries[p_rows->rows[p_rows->n - 1]].date > last_day)
+            last_day = p_logs->entries[p_rows->rows[p_rows->n - 1]].date;
+        if(p_arch->n && p_arch->blocks[p_arch->n - 1].last_date > last_day)
+            last_day = p_arch->blocks[p_arch->n - 1].last_date;
+    }
+
+    if(last_day == INT32_MIN) {
+        printf("No logs available\n\n");
+        return;
+    }
+
+    // Sum the window production of each plant from its date ordered rows
+    const int32_t first_day = last_day - (int32_t) days + 1;
+    size_t rank_cap = p_plants->n ? p_plants->n : 1;
+    __RollingRank *ranks = (__RollingRank*) memAlloc(MEM_TAG_SORT, rank_cap * sizeof(__RollingRank));
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        PlantLogRows *p_rows = &p_plant->logs;
+
+        double prod = 0;
+        for(size_t j = __lowerBoundLogDate(p_rows, p_logs->entries, first_day); j < p_rows->n; j++)
+            prod += p_logs->entries[p_rows->rows[j]].production;
+
+        // Only the archive blocks reaching into the window are decoded
+        LogEntry block[ARCHIVE_BLOCK_LOG_C];
+        for(size_t j = 0; j < p_plant->archive.n; j++) {
+            if(p_plant->archive.blocks[j].last_date < first_day) continue;
+            size_t block_n = decodeArchiveBlock(p_plant->archive.blocks + j, p_plant->no, block);
+            for(size_t k = 0; k < block_n; k++)
+                prod += block[k].date >= first_day ? block[k].production : 0;
+        }
+
+        double rated_prod = p_plant->rated_cap * 24.0 * days;
+        ranks[i].util = rated_prod > 0 ? (float) (prod / rated_prod * 100) : 0;
+        ranks[i].production = (float) prod;
+        ranks[i].p_plant = p_plant;
+    }
+
+    if(p_plants->n) {
+        mergesort(ranks, offsetof(__RollingRank, util), sizeof(__RollingRank), false, 
+            SORT_VALUE_TYPE_FLOAT32, false, 0, p_plants->n - 1);
+    }
+
+    printf("Power plants by %zu-day utilisation from %s ", days, formatDate(first_day));
+    printf("to %s: \n%-6s %-6s %-32s %-12s %16s %12s\n", formatDate(last_day), "Rank", "ID", 
+        "Name", "Fuel", "Production", "Utilisation");
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = ranks[i].p_plant;
+        char *fuel = fuelTypeToStr(p_plant->fuel);
+        printf("%-6zu %-6u %-32s %-12s %13.2fMWh %11.2f%%\n", i + 1, p_plant->no, p_plant->name,
+            fuel ? fuel : "unknown", ranks[i].production, ranks[i].util);
+    }
+
+    printf("\n");
+    memFree(MEM_TAG_SORT, ranks, rank_cap * sizeof(__RollingRank));
+}
+
+
+/// Display monthly or yearly rollups for the given power plant, if no plant
+/// is given, rollups for all power plants are displayed
+void showRollup(PowerPlants *p_plants, PlantData *p_plant, ListQuery *p_query) {
+    if(p_plant) {
+        displayRollup(p_plant, p_query->period);
+        return;
+    }
+
+    for(size_t i = 0; i < p_plants->n; i++)
+        displayRollup(p_plants->plants + i, p_query->period);
+}
+
+
 /// Save all edited data into a file
+/// Write the log entry as a csv line into the file using the given buffer
+void __writeLogLine(FILE *file, char *buf, LogEntry *p_ent) {
+    // Write csv line data into buffer
+    sprintf(buf, "%d,%d,%f,%f,\"%s\"\n", p_ent->log_id, p_ent->plant_no, p_ent->production, 
+        p_ent->avg_sale_price, formatDate(p_ent->date));
+
+    // Write the log data to file
+    fwrite(buf, sizeof(char), strlen(buf), file);
+}
+
+
 void saveData (
     PowerPlants *p_plants, 
     PlantLogs *p_logs, 
@@ -515,8 +1465,8 @@ void saveData (
     size_t log_buf_len = __MAX_LOG_LINE * (!log_len ? 1 : log_len);
 
     // Allocate memory for csv buffers
-    char *plant_buf = (char*) calloc(plant_buf_len, sizeof(char));
-    char *log_buf = (char*) calloc(log_buf_len, sizeof(char));
+    char *plant_buf = (char*) memCalloc(MEM_TAG_PARSER, plant_buf_len, sizeof(char));
+    char *log_buf = (char*) memCalloc(MEM_TAG_PARSER, log_buf_len, sizeof(char));
 
     // For each power plant instance write data and log data to their buffers
     for(size_t i = 0; i < p_plants->n; i++) {
@@ -528,38 +1478,27 @@ void saveData (
         // Write the power plant data instance into its file
         fwrite(plant_buf, sizeof(char), strlen(plant_buf), plant_file);
 
-        // For each log entry in power plant entry, write it to the buffer
-        for(size_t j = 0; j < p_plants->plants[i].logs.n; j++) {
-            LogEntry *p_ent = p_plants->plants[i].logs.p_entries[j];
-
-            char month[8] = { 0 };
-            char day[8] = { 0 };
-
-            // Check if additional zero paddings should be added when formating month
-            if(p_ent->date.month < 10) sprintf(month, "0%d", p_ent->date.month);
-            else sprintf(month, "%d", p_ent->date.month);
-
-            // Check if additional zero paddings should be added when formating day
-            if(p_ent->date.day < 10) sprintf(day, "0%d", p_ent->date.day);
-            else sprintf(day, "%d", p_ent->date.day);
-              
-            // Write csv line data into buffer
-            sprintf(log_buf, "%d,%d,%f,%f,\"%d-%s-%s\"\n",
-                p_ent->log_id, p_plants->plants[i].no, p_ent->production, 
-                p_ent->avg_sale_price, p_ent->date.year, month, day);
-
-            // Write the log data to file
-            fwrite(log_buf, sizeof(char), strlen(log_buf), log_file);
+        // Archived logs are older than the live logs, so they are written first
+        LogEntry block[ARCHIVE_BLOCK_LOG_C];
+        for(size_t j = 0; j < p_plants->plants[i].archive.n; j++) {
+            size_t block_n = decodeArchiveBlock(p_plants->plants[i].archive.blocks + j, 
+                p_plants->plants[i].no, block);
+            for(size_t k = 0; k < block_n; k++)
+                __writeLogLine(log_file, log_buf, block + k);
         }
 
+        // For each log entry in power plant entry, write it to the buffer
+        for(size_t j = 0; j < p_plants->plants[i].logs.n; j++)
+            __writeLogLine(log_file, log_buf, p_logs->entries + p_plants->plants[i].logs.rows[j]);
+
         // Set the buffer datas to zero
         memset(plant_buf, 0x00, plant_buf_len);
         memset(log_buf, 0x00, log_buf_len);
     }
 
     // Free all buffers allocated
-    free(plant_buf);
-    free(log_buf);
+    memFree(MEM_TAG_PARSER, plant_buf, plant_buf_len);
+    memFree(MEM_TAG_PARSER, log_buf, log_buf_len);
 
     // Close file streams
     fclose(plant_file);
@@ -567,3 +1506,15 @@ void saveData (
 
     printf("Saved to files '%s' and '%s'!\n", plants_file, logs_file);
 }
+
+
+/// Write power plants and archives into the data file and flush the mapped log rows
+void syncStoreData(DataStore *p_store, PowerPlants *p_plants, PlantLogs *p_logs) {
+    struct timespec beg, end;
+    clock_gettime(CLOCK_MONOTONIC, &beg);
+    syncDataStore(p_store, p_plants, p_logs);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double ms = (end.tv_sec - beg.tv_sec) * 1e3 + (end.tv_nsec - beg.tv_nsec) / 1e6;
+    printf("Synced data store in %.2fms\n", ms);
+}
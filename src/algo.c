@@ -11,306 +11,581 @@
 #include <algo.h>
 
 
-/// Check if the data sorting should set data to destination buffer
-void iswap (
-    bool is_decr, 
-    uint32_t lval, 
-    uint32_t rval, 
-    void *dst, 
-    void *la, 
-    void *ra, 
-    size_t stride, 
-    size_t *p_i, 
-    size_t *p_j
-) {
-    // Sorting order is not decreasing and left subarray value is greater than
-    // corresponding right subarray value
-    if(!is_decr && lval <= rval) {
-        memcpy(dst, la, stride);
-        (*p_i)++;
+/// Check if the left element must be sorted strictly before the right element
+bool __sortsBefore(__SortCtx *p_ctx, void *l, void *r) {
+    int cmp = __sortValueCmp(l, r, p_ctx->val_offset, p_ctx->val_type, p_ctx->is_ref);
+    return p_ctx->is_decr ? cmp > 0 : cmp < 0;
+}
+
+
+/// Count the elements at the beginning of the sorted array that are sorted before
+/// the key element, if is_incl is true the elements equal to key are also counted
+/// The boundary is found with exponential search followed by binary search
+size_t __gallop(__SortCtx *p_ctx, void *key, void *base, size_t n, bool is_incl) {
+    const size_t stride = p_ctx->stride;
+    #define __COUNTED(i)    (is_incl ? !__sortsBefore(p_ctx, key, base + (i) * stride) : \
+                                        __sortsBefore(p_ctx, base + (i) * stride, key))
+
+    // Double the step until the boundary is passed, all elements before lo are counted
+    size_t lo = 0, step = 1;
+    while(lo + step <= n && __COUNTED(lo + step - 1)) {
+        lo += step;
+        step <<= 1;
     }
 
-    // Sorting order is not decreasing and right subarray value is greater than
-    // corresponding left subarray value
-    else if(!is_decr && lval > rval) {
-        memcpy(dst, ra, stride);
-        (*p_j)++;
+    // Binary search the boundary from the last step range
+    size_t hi = lo + step - 1 < n ? lo + step - 1 : n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(__COUNTED(mid)) lo = mid + 1;
+        else hi = mid;
     }
 
-    // Sorting order is decreasing and left subarray value is greater than
-    // corresponding right subarray value
-    else if(is_decr && lval >= rval) {
-        memcpy(dst, la, stride);
-        (*p_i)++;
+    #undef __COUNTED
+    return lo;
+}
+
+
+/// Find the natural run starting from the beginning of the array and return
+/// its length, strictly descending runs are reversed in place
+size_t __findRun(__SortCtx *p_ctx, void *arr, size_t n) {
+    const size_t stride = p_ctx->stride;
+    if(n < 2) return n;
+
+    size_t run_n = 2;
+
+    // Check for strictly descending run, equal elements would break stability
+    // when reversed
+    if(__sortsBefore(p_ctx, arr + stride, arr)) {
+        while(run_n < n && __sortsBefore(p_ctx, arr + run_n * stride, arr + (run_n - 1) * stride))
+            run_n++;
+
+        // Reverse the run
+        for(size_t i = 0, j = run_n - 1; i < j; i++, j--)
+            __swapElements(arr + i * stride, arr + j * stride, stride);
     }
 
-    // Sorting order is decreasing and right subarray value is greater than
-    // corresponding left subarray value
-    else if(is_decr && lval < rval) {
-        memcpy(dst, ra, stride);
-        (*p_j)++;
+    // Ascending run
+    else {
+        while(run_n < n && !__sortsBefore(p_ctx, arr + run_n * stride, arr + (run_n - 1) * stride))
+            run_n++;
     }
+
+    return run_n;
 }
 
 
-/// Check if the data sorting should set for floating point integer to 
-/// destination buffe
-void fswap (
-    bool is_decr, 
-    float lval, 
-    float rval, 
-    void *dst, 
-    void *la, 
-    void *ra, 
-    size_t stride, 
-    size_t *p_i, 
-    size_t *p_j
-) {
-    // Sorting order is not decreasing and left subarray value is greater than
-    // corresponding right subarray value
-    if(!is_decr && lval <= rval) {
-        memcpy(dst, la, stride);
-        (*p_i)++;
+/// Extend the sorted prefix of sorted_n elements to n elements with binary 
+/// insertion sort
+void __insertionSort(__SortCtx *p_ctx, void *arr, size_t sorted_n, size_t n) {
+    const size_t stride = p_ctx->stride;
+    char tmp[stride];
+
+    for(size_t i = sorted_n; i < n; i++) {
+        // Find the position after all equal elements, which keeps the sort stable
+        size_t pos = __gallop(p_ctx, arr + i * stride, arr, i, true);
+        if(pos == i) continue;
+
+        memcpy(tmp, arr + i * stride, stride);
+        memmove(arr + (pos + 1) * stride, arr + pos * stride, (i - pos) * stride);
+        memcpy(arr + pos * stride, tmp, stride);
     }
+}
+
 
-    // Sorting order is not decreasing and right subarray value is greater than
-    // corresponding left subarray value
-    else if(!is_decr && lval > rval) {
-        memcpy(dst, ra, stride);
-        (*p_j)++;
+/// Find the minimum run length, that makes the run count close to, but not 
+/// greater than a power of two
+size_t __minRunLength(size_t n) {
+    size_t r = 0;
+    while(n >= 64) {
+        r |= n & 1;
+        n >>= 1;
     }
 
-    // Sorting order is decreasing and left subarray value is greater than
-    // corresponding right subarray value
-    else if(is_decr && lval >= rval) {
-        memcpy(dst, la, stride);
-        (*p_i)++;
+    return n + r;
+}
+
+
+/// Find the merge tree node power between two adjacent runs in array of n elements
+/// The power is the first bit where the binary fractions of the run midpoints
+/// relative to n differ
+uint32_t __nodePower(size_t beg1, size_t n1, size_t n2, size_t n) {
+    // Midpoints are doubled to avoid fractions
+    size_t a = 2 * beg1 + n1;
+    size_t b = a + n1 + n2;
+    uint32_t power = 0;
+
+    while(true) {
+        power++;
+        if(a >= n) {
+            a -= n;
+            b -= n;
+        } else if(b >= n) break;
+
+        a <<= 1;
+        b <<= 1;
     }
 
-    // Sorting order is decreasing and right subarray value is greater than
-    // corresponding left subarray value
-    else if(is_decr && lval < rval) {
-        memcpy(dst, ra, stride);
-        (*p_j)++;
+    return power;
+}
+
+
+/// Merge the adjacent sorted runs arr[0, n1) and arr[n1, n1 + n2) with galloping
+/// Scratch buffer must be able to hold n1 elements
+void __mergeRuns(__SortCtx *p_ctx, void *arr, void *scratch, size_t n1, size_t n2) {
+    const size_t stride = p_ctx->stride;
+    void *ra = arr + n1 * stride;
+
+    // Elements of the left run that are sorted before the first right run element
+    // are already in place
+    size_t skip = __gallop(p_ctx, ra, arr, n1, true);
+    arr += skip * stride;
+    n1 -= skip;
+    if(!n1) return;
+
+    // Elements of the right run that are sorted after the last left run element
+    // are already in place
+    n2 = __gallop(p_ctx, arr + (n1 - 1) * stride, ra, n2, false);
+    if(!n2) return;
+
+    // Copy the left run into scratch buffer and merge both runs forward
+    memcpy(scratch, arr, n1 * stride);
+    void *la = scratch;
+    size_t i = 0, j = 0, k = 0;
+    size_t l_wins = 0, r_wins = 0;
+
+    while(i < n1 && j < n2) {
+        // Take the right element only if it is strictly before, which keeps the merge stable
+        if(__sortsBefore(p_ctx, ra + j * stride, la + i * stride)) {
+            memcpy(arr + k++ * stride, ra + j++ * stride, stride);
+            r_wins++;
+            l_wins = 0;
+        } else {
+            memcpy(arr + k++ * stride, la + i++ * stride, stride);
+            l_wins++;
+            r_wins = 0;
+        }
+
+        // When one run keeps winning, copy its elements in bulk
+        if(l_wins >= __MIN_GALLOP && j < n2) {
+            size_t c = __gallop(p_ctx, ra + j * stride, la + i * stride, n1 - i, true);
+            memcpy(arr + k * stride, la + i * stride, c * stride);
+            i += c;
+            k += c;
+            l_wins = 0;
+        } else if(r_wins >= __MIN_GALLOP && i < n1) {
+            size_t c = __gallop(p_ctx, la + i * stride, ra + j * stride, n2 - j, false);
+            memmove(arr + k * stride, ra + j * stride, c * stride);
+            j += c;
+            k += c;
+            r_wins = 0;
+        }
     }
+
+    // Remaining right run elements are already in place
+    if(i < n1)
+        memcpy(arr + k * stride, la + i * stride, (n1 - i) * stride);
 }
 
 
-/// Check how the subarray element sorting should be done for sorting
-/// float values
-void __sortCheckf (
-    bool is_decr, 
-    bool is_ref,
-    void *dst, 
-    void *la, 
-    void *ra, 
+/// Perform stable merge sort on generic structure with specified stride and value
+/// offset
+/// Natural ascending and descending runs are detected and merged, so already
+/// sorted and reversed data is sorted in linear time
+/// NOTE: The scratch memory for merging is allocated from heap, since the
+/// sorted arrays can be much larger than the stack
+void mergesort (
+    void *arr, 
+    size_t val_offset, 
     size_t stride, 
-    size_t val_offset,
-    size_t *p_i,
-    size_t *p_j
+    bool is_decr,
+    SortValueType val_type,
+    bool is_ref,
+    size_t beg,
+    size_t end
 ) {
-    // Find the compare values
-    float lval = is_ref ? *(float*) (*((void**) la) + val_offset) :
-        *(float*) (la + val_offset);
+    if(beg >= end) return;
+
+    __SortCtx ctx = { val_offset, stride, is_decr, val_type, is_ref };
+    const size_t n = end - beg + 1;
+    const size_t min_run = __minRunLength(n);
+    arr += beg * stride;
+
+    // Check if the whole array is a single natural run
+    size_t first_n = __findRun(&ctx, arr, n);
+    if(first_n == n) return;
+
+    // Allocate scratch memory for merging the runs
+    void *scratch = memAlloc(MEM_TAG_SORT, n * stride);
+    if(!scratch) {
+        fprintf(stderr, "Failed to allocate memory for sorting\n");
+        exit(EXIT_FAILURE);
+    }
+
+    __MergeRun stack[__MAX_MERGE_STACK];
+    size_t stack_n = 0;
+
+    // For each natural run, extended to minimum run length when needed, merge the 
+    // runs on the stack with larger node power than the new run
+    for(size_t i = 0; i < n;) {
+        __MergeRun run = { .beg = i, .n = i ? __findRun(&ctx, arr + i * stride, n - i) : first_n };
+        if(run.n < min_run) {
+            size_t ext_n = n - i < min_run ? n - i : min_run;
+            __insertionSort(&ctx, arr + i * stride, run.n, ext_n);
+            run.n = ext_n;
+        }
+
+        if(stack_n) {
+            uint32_t power = __nodePower(stack[stack_n - 1].beg, stack[stack_n - 1].n, run.n, n);
+            while(stack_n > 1 && stack[stack_n - 2].power > power) {
+                __MergeRun *p_l = stack + stack_n - 2;
+                __MergeRun *p_r = stack + stack_n - 1;
+                __mergeRuns(&ctx, arr + p_l->beg * stride, scratch, p_l->n, p_r->n);
+                p_l->n += p_r->n;
+                stack_n--;
+            }
+            stack[stack_n - 1].power = power;
+        }
+
+        stack[stack_n++] = run;
+        i += run.n;
+    }
 
-    float rval = is_ref ? *(float*) (*((void**) ra) + val_offset) :
-        *(float*) (ra + val_offset);
+    // Merge all remaining runs from the top of the stack
+    for(; stack_n > 1; stack_n--) {
+        __MergeRun *p_l = stack + stack_n - 2;
+        __MergeRun *p_r = stack + stack_n - 1;
+        __mergeRuns(&ctx, arr + p_l->beg * stride, scratch, p_l->n, p_r->n);
+        p_l->n += p_r->n;
+    }
 
-    fswap(is_decr, lval, rval, dst, la, ra, stride, p_i, p_j);
+    memFree(MEM_TAG_SORT, scratch, n * stride);
 }
 
 
-/// Check how the subarray element sorting should be done for sorting
-/// integer values
-void __sortChecki (
-    bool is_decr, 
-    bool is_ref,
-    void *dst, 
-    void *la, 
-    void *ra, 
-    size_t stride, 
+/// Compare two sortable values
+/// Returns negative value if the left value is smaller, positive value if the
+/// left value is bigger and zero if the values are equal
+int __sortValueCmp (
+    void *l,
+    void *r,
     size_t val_offset,
-    size_t *p_i,
-    size_t *p_j
+    SortValueType val_type,
+    bool is_ref
 ) {
-    // Find the compare values
-    uint32_t lval = is_ref ? *(uint32_t*) (*((void**) la) + val_offset) :
-        *(uint32_t*) (la + val_offset);
+    // Find the value addresses
+    void *lval = (is_ref ? *(void**) l : l) + val_offset;
+    void *rval = (is_ref ? *(void**) r : r) + val_offset;
+
+    switch(val_type) {
+    case SORT_VALUE_TYPE_UINT32:
+        return (*(uint32_t*) lval > *(uint32_t*) rval) - (*(uint32_t*) lval < *(uint32_t*) rval);
+
+    case SORT_VALUE_TYPE_FLOAT32:
+        return (*(float*) lval > *(float*) rval) - (*(float*) lval < *(float*) rval);
+
+    case SORT_VALUE_TYPE_DATE:
+        return (*(int32_t*) lval > *(int32_t*) rval) - (*(int32_t*) lval < *(int32_t*) rval);
+
+    case SORT_VALUE_TYPE_PACKED128: {
+        uint64_t *lk = (uint64_t*) lval;
+        uint64_t *rk = (uint64_t*) rval;
+
+        // Compare the most significant half first and the ordinal last
+        if(lk[0] != rk[0])
+            return lk[0] < rk[0] ? -1 : 1;
+        if(lk[1] != rk[1])
+            return lk[1] < rk[1] ? -1 : 1;
+        return (lk[2] > rk[2]) - (lk[2] < rk[2]);
+    }
+
+    default:
+        return 0;
+    }
+}
 
-    uint32_t rval = is_ref ? *(uint32_t*) (*((void**) ra) + val_offset) :
-        *(uint32_t*) (ra + val_offset);
 
-    iswap(is_decr, lval, rval, dst, la, ra, stride, p_i, p_j);
+/// Swap two generic array elements with specified stride
+void __swapElements(void *a, void *b, size_t stride) {
+    char tmp[stride];
+    memcpy(tmp, a, stride);
+    memcpy(a, b, stride);
+    memcpy(b, tmp, stride);
 }
 
 
-/// Check how the subarray element sorting should be done for sorting
-/// by date
-void __sortCheckDate (
-    bool is_decr, 
-    bool is_ref, 
-    void *dst, 
-    void *la, 
-    void *ra, 
+/// Restore the heap property for the subtree starting at given root
+/// The heap is ordered so that the element that would be sorted last is at the root
+void __siftDown (
+    void *heap,
+    size_t root,
+    size_t n,
+    size_t val_offset,
     size_t stride,
-    size_t val_offset, 
-    size_t *p_i, 
-    size_t *p_j
+    bool is_decr,
+    SortValueType val_type,
+    bool is_ref
 ) {
-    uint32_t lval = 0, rval = 0;
-    char buf[__DEFAULT_BUF_SIZE] = { 0 };
+    const int sign = is_decr ? -1 : 1;
 
-    // Check if the date data is referenced
-    if(!is_ref) {
-        // Find the appropriate date data
-        sprintf(buf, "%d%d%d", (*(Date*) (la + val_offset)).year, (*(Date*) (la + val_offset)).month,
-            (*(Date*) (la + val_offset)).day);
-        lval = atoi(buf);
+    // Move the root element down until both of its children are sorted before it
+    while(2 * root + 1 < n) {
+        size_t child = 2 * root + 1;
 
-        // Clear the buffer
-        memset(buf, 0, __DEFAULT_BUF_SIZE);
+        // Select the child that would be sorted later
+        if(child + 1 < n && sign * __sortValueCmp(heap + (child + 1) * stride, heap + child * stride,
+           val_offset, val_type, is_ref) > 0)
+            child++;
 
-        // Read right date data
-        sprintf(buf, "%d%d%d", (*(Date*) (ra + val_offset)).year, (*(Date*) (ra + val_offset)).month,
-            (*(Date*) (ra + val_offset)).day);
+        // Check if the heap property is satisfied
+        if(sign * __sortValueCmp(heap + root * stride, heap + child * stride, val_offset,
+           val_type, is_ref) >= 0)
+            break;
 
-        rval = atoi(buf);
+        __swapElements(heap + root * stride, heap + child * stride, stride);
+        root = child;
     }
+}
 
-    else {
-        // Find the appropriate date data
-        sprintf(buf, "%d%d%d", (*(Date*) ((*(void**) (la)) + val_offset)).year, (*(Date*) ((*(void**) (la)) + val_offset)).month,
-            (*(Date*) ((*(void**) (la)) + val_offset)).day);
-        lval = atoi(buf);
-
-        // Clear the buffer
-        memset(buf, 0, __DEFAULT_BUF_SIZE);
-
-        // Read right date data
-        sprintf(buf, "%d%d%d", (*(Date*) ((*(void**) (ra)) + val_offset)).year, (*(Date*) ((*(void**) (ra)) + val_offset)).month,
-            (*(Date*) ((*(void**) (ra)) + val_offset)).day);
 
-        rval = atoi(buf);
+/// Move the first k elements in sorting order to the beginning of the generic array
+/// and sort them. The selection is done with a bounded heap of k elements, so the
+/// complexity is O(n log k) instead of O(n log n)
+/// NOTE: The order of the remaining n - k elements is unspecified
+void heapselect (
+    void *arr,
+    size_t val_offset,
+    size_t stride,
+    bool is_decr,
+    SortValueType val_type,
+    bool is_ref,
+    size_t n,
+    size_t k
+) {
+    const int sign = is_decr ? -1 : 1;
+    if(!k) return;
+    if(k > n) k = n;
+
+    // Build the bounded heap from the first k elements
+    for(size_t i = k / 2; i > 0; i--)
+        __siftDown(arr, i - 1, k, val_offset, stride, is_decr, val_type, is_ref);
+
+    // For each remaining element check if it should replace the heap root
+    for(size_t i = k; i < n; i++) {
+        if(sign * __sortValueCmp(arr + i * stride, arr, val_offset, val_type, is_ref) < 0) {
+            __swapElements(arr + i * stride, arr, stride);
+            __siftDown(arr, 0, k, val_offset, stride, is_decr, val_type, is_ref);
+        }
     }
 
-    iswap(is_decr, lval, rval, dst, la, ra, stride, p_i, p_j);
+    // Sort the selected elements by repeatedly moving the heap root to the end
+    for(size_t i = k - 1; i > 0; i--) {
+        __swapElements(arr, arr + i * stride, stride);
+        __siftDown(arr, 0, i, val_offset, stride, is_decr, val_type, is_ref);
+    }
 }
 
 
-/// Merge the subarrays in sorted order
-void __merge ( 
+/// Sort the first k elements of the generic array, when k is zero or not smaller
+/// than the element count, the whole array is sorted with stable merge sort
+void partialsort (
     void *arr,
     size_t val_offset,
     size_t stride,
     bool is_decr,
     SortValueType val_type,
     bool is_ref,
-    size_t end
+    size_t n,
+    size_t k
 ) {
-    // Find the sizes of both subarrays
-    size_t n1 = end / 2 + 1;
-    size_t n2 = end - (end / 2);
+    if(!n) return;
 
-    if(!n1 || !n2) return;
- 
-    // Create sub arrays
-    char la[n1 * stride];
-    char ra[n2 * stride];
+    if(!k || k >= n)
+        mergesort(arr, val_offset, stride, is_decr, val_type, is_ref, 0, n - 1);
+    else heapselect(arr, val_offset, stride, is_decr, val_type, is_ref, n, k);
+}
 
-    // Copy all given data over to the temporarely created arrays
-    memcpy(la, arr, n1 * stride);
-    memcpy(ra, arr + (n1 * stride), n2 * stride);
 
-    // Index of the first subarray
-    size_t i = 0;
+/// Convert a sortable value into 32 bit unsigned integer, which preserves the
+/// sorting order of given value type when compared as unsigned integer
+/// If is_decr is true, the bits are inverted so that the order is reversed
+uint32_t encodeSortField(void *p_val, SortValueType type, bool is_decr) {
+    uint32_t field = 0;
+
+    switch(type) {
+    case SORT_VALUE_TYPE_UINT32:
+        field = *(uint32_t*) p_val;
+        break;
+
+    case SORT_VALUE_TYPE_FLOAT32:
+        // Negative values have all bits flipped, positive values only the sign bit,
+        // so that IEEE-754 values compare correctly as unsigned integers
+        // Negative zero is encoded as zero, since the values compare equal
+        memcpy(&field, p_val, sizeof(uint32_t));
+        if(field == 0x80000000) field = 0;
+        field = (field & 0x80000000) ? ~field : field | 0x80000000;
+        break;
+
+    case SORT_VALUE_TYPE_DATE:
+        // Flip the sign bit of epoch day, so that dates before 1970 compare correctly
+        field = (uint32_t) *(int32_t*) p_val ^ 0x80000000;
+        break;
+
+    default:
+        break;
+    }
 
-    // Index of the second subarray
-    size_t j = 0;
+    return is_decr ? ~field : field;
+}
 
-    // Index of the main array
-    size_t k = 0;
 
-    // For each element in the sub arrays check if they are sorted appropriately
-    while(i < n1 && j < n2) {
-        // Check the ValueType and sort the data correctly 
-        switch(val_type) {
-        case SORT_VALUE_TYPE_FLOAT32:
-            __sortCheckf(is_decr, is_ref, arr + k * stride, la + i * stride, ra + j * stride,
-                stride, val_offset, &i, &j);
-            break;
+/// Set the 32 bit field with index field_i in the packed sort key
+void packSortKeyField(PackedSortKey *p_key, size_t field_i, uint32_t field) {
+    // Fields 0 and 1 are placed into the most significant half
+    if(field_i < 2)
+        p_key->hi |= (uint64_t) field << (field_i ? 0 : 32);
+    else p_key->lo |= (uint64_t) field << (field_i == 2 ? 32 : 0);
+}
 
-        case SORT_VALUE_TYPE_UINT32:
-            __sortChecki(is_decr, is_ref, arr + k * stride, la + i * stride, ra + j * stride,
-                stride, val_offset, &i, &j);
-            break;
 
-        case SORT_VALUE_TYPE_DATE:
-            __sortCheckDate(is_decr, is_ref, arr + k * stride, la + i * stride, ra + j * stride,
-                stride, val_offset, &i, &j);
-            break;
-        }
-        k++;
-    }
+/// Find the amount of 32 bit key fields that the string of given length is 
+/// encoded into, including the null terminator
+size_t sortStringFieldCount(size_t len) {
+    return len / 4 + 1;
+}
 
 
-    // Write any left over data from first subarray to the main array
-    if(i < n1)
-        memcpy(arr + k * stride, (la + i * stride), (n1 - i) * stride);
+/// Encode the 4 byte chunk with index field_i of the string into 32 bit order
+/// preserving key field
+/// Bytes are packed in big-endian order as unsigned values, so UTF-8 strings are
+/// collated by their byte order
+uint32_t encodeSortStringField(char *str, size_t len, size_t field_i, bool is_decr) {
+    unsigned char *bytes = (unsigned char*) str;
+    uint32_t field = 0;
 
-    // Write any left over data from second subarray to the main array
-    if(j < n2)
-        memcpy(arr + k * stride, (ra + j * stride), (n2 - j) * stride);
+    // Bytes after the end of string are padded with zeros, which makes shorter
+    // strings sort before longer strings with the same prefix
+    for(size_t i = field_i * 4; i < field_i * 4 + 4; i++)
+        field = (field << 8) | (i < len ? bytes[i] : 0);
+
+    return is_decr ? ~field : field;
 }
 
 
-/// Perform merge sort on generic array with 32 bit floating point
-/// values for comparison
-void mergesort (
-    void *arr, 
-    size_t val_offset, 
-    size_t stride, 
-    bool is_decr,
-    SortValueType val_type,
-    bool is_ref,
-    size_t beg,
-    size_t end
-) {
-    if(beg < end) {
-        size_t mid = beg + (end - beg) / 2;
-        mergesort(arr, val_offset, stride, is_decr, val_type, is_ref, beg, mid);
-        mergesort(arr, val_offset, stride, is_decr, val_type, is_ref, mid + 1, end);
-        __merge(arr + beg * stride, val_offset, stride, is_decr, val_type, is_ref, 
-            end - beg);
+/// Add value to the compensated sum
+/// Neumaier's variant is used, which stays accurate also when the added value
+/// is larger than the sum
+void kahanAdd(KahanSum *p_sum, double val) {
+    double t = p_sum->sum + val;
+    if(fabs(p_sum->sum) >= fabs(val))
+        p_sum->comp += (p_sum->sum - t) + val;
+    else p_sum->comp += (val - t) + p_sum->sum;
+
+    p_sum->sum = t;
+}
+
+
+/// Find the value of the compensated sum
+double kahanValue(KahanSum *p_sum) {
+    return p_sum->sum + p_sum->comp;
+}
+
+
+/// Add value to aggregates
+void __aggregatesAdd(PlantAggregates *p_agg, LogEntry *p_entry) {
+    kahanAdd(&p_agg->production, p_entry->production);
+    kahanAdd(&p_agg->sale_price, p_entry->avg_sale_price);
+    p_agg->n++;
+}
+
+
+/// Remove value from aggregates
+void __aggregatesRemove(PlantAggregates *p_agg, LogEntry *p_entry) {
+    // Reset the sums once the last value is removed, so that no rounding error is left over
+    if(p_agg->n <= 1) {
+        *p_agg = (PlantAggregates) { 0 };
+        return;
     }
+
+    kahanAdd(&p_agg->production, -p_entry->production);
+    kahanAdd(&p_agg->sale_price, -p_entry->avg_sale_price);
+    p_agg->n--;
 }
 
 
-/// Calculate the average utilisation for a power plant based on its daily logs
-void calcAvgUtilisation(PlantData *p_plant) {
-    const float max_day_produc = p_plant->rated_cap * 24;
-    float total_production = 0.0f;
+/// Find the rollup bucket for the given month, buckets are added as needed
+PlantAggregates *__rollupBucket(PlantRollup *p_rollup, int32_t month) {
+    // First bucket
+    if(!p_rollup->n) {
+        memReallocCheck(MEM_TAG_PLANTS, (void**) &p_rollup->months, sizeof(PlantAggregates), 1, &p_rollup->cap);
+        p_rollup->months[0] = (PlantAggregates) { 0 };
+        p_rollup->first_month = month;
+        p_rollup->n = 1;
+        return p_rollup->months;
+    }
+
+    // Month is before the first bucket, shift the buckets to the right
+    if(month < p_rollup->first_month) {
+        size_t shift = (size_t) (p_rollup->first_month - month);
+        memReallocCheck(MEM_TAG_PLANTS, (void**) &p_rollup->months, sizeof(PlantAggregates), p_rollup->n + shift, 
+            &p_rollup->cap);
+        memmove(p_rollup->months + shift, p_rollup->months, p_rollup->n * sizeof(PlantAggregates));
+        memset(p_rollup->months, 0, shift * sizeof(PlantAggregates));
+        p_rollup->first_month = month;
+        p_rollup->n += shift;
+    }
 
-    // For each log in the plant instance add its production stat to
-    // total production
-    for(size_t i = 0; i < p_plant->logs.n; i++)
-        total_production += p_plant->logs.p_entries[i]->production;
+    // Month is after the last bucket, add empty buckets to the end
+    size_t i = (size_t) (month - p_rollup->first_month);
+    if(i >= p_rollup->n) {
+        memReallocCheck(MEM_TAG_PLANTS, (void**) &p_rollup->months, sizeof(PlantAggregates), i + 1, &p_rollup->cap);
+        memset(p_rollup->months + p_rollup->n, 0, (i + 1 - p_rollup->n) * sizeof(PlantAggregates));
+        p_rollup->n = i + 1;
+    }
 
-    if(p_plant->logs.n)
-        p_plant->avg_utilisation = total_production / (p_plant->logs.n * max_day_produc) * 100;
-    else p_plant->avg_cost = 0;
+    return p_rollup->months + i;
 }
 
 
-/// Calculate the average cost for the power plant based on its daily logs
-void calcAvgCost(PlantData *p_plant) {
-    float total_cost = 0.0f;
+/// Add the log entry values to the running aggregates, monthly rollup and 
+/// quantile sketches of the power plant and update its averages
+void addLogAggregates(PlantData *p_plant, LogEntry *p_entry) {
+    __aggregatesAdd(&p_plant->agg, p_entry);
+    __aggregatesAdd(__rollupBucket(&p_plant->rollup, epochDayToMonth(p_entry->date)), p_entry);
+    addLogSketches(p_plant, p_entry);
+    calcPlantAverages(p_plant);
+}
+
 
-    // For each log in the plant instance add its cost stat to 
-    // total cost
-    for(size_t i = 0; i < p_plant->logs.n; i++)
-        total_cost += p_plant->logs.p_entries[i]->avg_sale_price;
+/// Remove the log entry values from the running aggregates and monthly rollup
+/// of the power plant and update its averages
+/// Quantile sketches are marked stale, since values cannot be removed from them
+void removeLogAggregates(PlantData *p_plant, LogEntry *p_entry) {
+    __aggregatesRemove(&p_plant->agg, p_entry);
+    __aggregatesRemove(__rollupBucket(&p_plant->rollup, epochDayToMonth(p_entry->date)), p_entry);
+    p_plant->sketch.is_stale = true;
+    calcPlantAverages(p_plant);
+}
+
+
+/// Free all memory allocated for the rollup buckets
+void destroyPlantRollup(PlantRollup *p_rollup) {
+    memFree(MEM_TAG_PLANTS, p_rollup->months, p_rollup->cap * sizeof(PlantAggregates));
+    memset(p_rollup, 0, sizeof(PlantRollup));
+}
+
+
+/// Calculate the average cost and utilisation for the power plant from its
+/// running log aggregates
+void calcPlantAverages(PlantData *p_plant) {
+    if(!p_plant->agg.n) {
+        p_plant->avg_cost = 0;
+        p_plant->avg_utilisation = 0;
+        return;
+    }
 
-    if(p_plant->logs.n)
-        p_plant->avg_cost = total_cost / p_plant->logs.n;
-    else p_plant->avg_cost = 0;
+    const double max_day_produc = p_plant->rated_cap * 24;
+    p_plant->avg_cost = (float) (kahanValue(&p_plant->agg.sale_price) / p_plant->agg.n);
+    p_plant->avg_utilisation = (float) (kahanValue(&p_plant->agg.production) / 
+        (p_plant->agg.n * max_day_produc) * 100);
 }
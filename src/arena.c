@@ -0,0 +1,131 @@
+/*
+ * File:        arena.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for region allocator, which is used for
+ *              power plant names and log row arrays
+ */
+
+
+#define __ARENA_C
+#include <arena.h>
+
+
+/// Find the size class of the allocation size
+static size_t __arenaSizeClass(size_t size) {
+    size_t cls = 0;
+    while(((size_t) __ARENA_MIN_ALLOC << cls) < size)
+        cls++;
+
+    return cls;
+}
+
+
+/// Allocate a new block of the given size and link it to the arena
+static uint8_t *__arenaNewBlock(Arena *p_arena, size_t size) {
+    // Arena blocks hold power plant data, so they are accounted under plants
+    ArenaBlock *p_block = (ArenaBlock*) memAlloc(MEM_TAG_PLANTS, sizeof(ArenaBlock) + size);
+    if(!p_block) {
+        fprintf(stderr, "Failed to allocate memory for arena block\n");
+        exit(EXIT_FAILURE);
+    }
+
+    p_block->next = p_arena->blocks;
+    p_block->size = size;
+    p_arena->blocks = p_block;
+    p_arena->reserved += size;
+    return (uint8_t*) (p_block + 1);
+}
+
+
+/// Split the unused tail of the bump block into free list allocations
+static void __arenaRetireTail(Arena *p_arena) {
+    // The tail is a multiple of the minimum allocation, so it splits into power of two classes
+    while((size_t) (p_arena->end - p_arena->cur) >= __ARENA_MIN_ALLOC) {
+        size_t cls = __arenaSizeClass((size_t) (p_arena->end - p_arena->cur));
+        if(((size_t) __ARENA_MIN_ALLOC << cls) > (size_t) (p_arena->end - p_arena->cur))
+            cls--;
+
+        *(void**) p_arena->cur = p_arena->free_lists[cls];
+        p_arena->free_lists[cls] = p_arena->cur;
+        p_arena->cur += (size_t) __ARENA_MIN_ALLOC << cls;
+    }
+}
+
+
+/// Allocate memory from the arena, the size is rounded up to its size class
+/// NOTE: The memory is not zeroed
+void *arenaAlloc(Arena *p_arena, size_t size) {
+    size_t cls = __arenaSizeClass(size);
+    size_t cls_size = (size_t) __ARENA_MIN_ALLOC << cls;
+    p_arena->used += cls_size;
+
+    // Reuse previously freed allocation of the same size class
+    if(p_arena->free_lists[cls]) {
+        void *ptr = p_arena->free_lists[cls];
+        p_arena->free_lists[cls] = *(void**) ptr;
+        return ptr;
+    }
+
+    // Large allocations get a block of their own, so that they do not waste the bump block
+    if(cls_size > __ARENA_BLOCK_SIZE / 4)
+        return __arenaNewBlock(p_arena, cls_size);
+
+    if((size_t) (p_arena->end - p_arena->cur) < cls_size) {
+        __arenaRetireTail(p_arena);
+        p_arena->cur = __arenaNewBlock(p_arena, __ARENA_BLOCK_SIZE);
+        p_arena->end = p_arena->cur + __ARENA_BLOCK_SIZE;
+    }
+
+    void *ptr = p_arena->cur;
+    p_arena->cur += cls_size;
+    return ptr;
+}
+
+
+/// Return the allocation to the free list of its size class, the size must be
+/// the same as was used for allocating it
+void arenaFree(Arena *p_arena, void *ptr, size_t size) {
+    if(!ptr) return;
+
+    size_t cls = __arenaSizeClass(size);
+    *(void**) ptr = p_arena->free_lists[cls];
+    p_arena->free_lists[cls] = ptr;
+    p_arena->used -= (size_t) __ARENA_MIN_ALLOC << cls;
+}
+
+
+/// Resize the allocation, the contents are kept up to the smaller of the sizes
+/// Allocations that stay in the same size class are not moved
+void *arenaRealloc(Arena *p_arena, void *ptr, size_t old_size, size_t new_size) {
+    if(!ptr) return arenaAlloc(p_arena, new_size);
+    if(__arenaSizeClass(old_size) == __arenaSizeClass(new_size))
+        return ptr;
+
+    void *new_ptr = arenaAlloc(p_arena, new_size);
+    memcpy(new_ptr, ptr, old_size < new_size ? old_size : new_size);
+    arenaFree(p_arena, ptr, old_size);
+    return new_ptr;
+}
+
+
+/// Copy the string into arena memory
+char *arenaStrdup(Arena *p_arena, const char *str) {
+    size_t len = strlen(str) + 1;
+    char *new_str = (char*) arenaAlloc(p_arena, len);
+    memcpy(new_str, str, len);
+    return new_str;
+}
+
+
+/// Release all memory of the arena at once
+void destroyArena(Arena *p_arena) {
+    while(p_arena->blocks) {
+        ArenaBlock *p_next = p_arena->blocks->next;
+        memFree(MEM_TAG_PLANTS, p_arena->blocks, sizeof(ArenaBlock) + p_arena->blocks->size);
+        p_arena->blocks = p_next;
+    }
+
+    memset(p_arena, 0, sizeof(Arena));
+}
@@ -0,0 +1,665 @@
+/*
+ * File:        bitmap.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-11
+ * Last edit:   2021-06-11
+ * Description: Function definitions for roaring compressed bitmaps and bitmap
+ *              indexes built from them
+ */
+
+
+#define __BITMAP_C
+#include <bitmap.h>
+
+
+/// Find the index of the first container with key not smaller than the given key
+static size_t __roaringLowerBound(const RoaringBitmap *p_bm, uint16_t key) {
+    size_t lo = 0, hi = p_bm->n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(p_bm->conts[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+
+/// Find the container with the given key, NULL is returned if it does not exist
+static RoaringContainer *__roaringFind(const RoaringBitmap *p_bm, uint16_t key) {
+    // Rows are mostly added and scanned in increasing order, so the last container
+    // is checked before searching
+    if(p_bm->n && p_bm->conts[p_bm->n - 1].key == key)
+        return p_bm->conts + p_bm->n - 1;
+
+    size_t i = __roaringLowerBound(p_bm, key);
+    return i < p_bm->n && p_bm->conts[i].key == key ? p_bm->conts + i : NULL;
+}
+
+
+/// Find the container with the given key, the container is created if it does not exist
+static RoaringContainer *__roaringGet(RoaringBitmap *p_bm, uint16_t key) {
+    RoaringContainer *p_cont = __roaringFind(p_bm, key);
+    if(p_cont) return p_cont;
+
+    size_t i = __roaringLowerBound(p_bm, key);
+    memReallocCheck(MEM_TAG_MAPS, (void**) &p_bm->conts, sizeof(RoaringContainer), p_bm->n + 1, &p_bm->cap);
+    memmove(p_bm->conts + i + 1, p_bm->conts + i, (p_bm->n - i) * sizeof(RoaringContainer));
+    p_bm->conts[i] = (RoaringContainer) { .key = key };
+    p_bm->n++;
+
+    return p_bm->conts + i;
+}
+
+
+/// Find the amount of bytes allocated for the container data
+static size_t __containerSize(const RoaringContainer *p_cont) {
+    return p_cont->is_bitset ? __ROARING_BITSET_WORD_C * sizeof(uint64_t) : p_cont->cap * sizeof(uint16_t);
+}
+
+
+/// Free the data of the container
+static void __containerDestroy(RoaringContainer *p_cont) {
+    memFree(MEM_TAG_MAPS, p_cont->data, __containerSize(p_cont));
+    p_cont->data = NULL;
+    p_cont->n = 0;
+    p_cont->cap = 0;
+    p_cont->is_bitset = false;
+}
+
+
+/// Find the index of the first array container value not smaller than the given value
+static size_t __arrayLowerBound(const uint16_t *vals, size_t n, uint16_t val) {
+    size_t lo = 0, hi = n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(vals[mid] < val) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+
+/// Check if the container contains the value
+static bool __containerContains(const RoaringContainer *p_cont, uint16_t val) {
+    if(p_cont->is_bitset)
+        return (((uint64_t*) p_cont->data)[val >> 6] >> (val & 63)) & 1;
+
+    size_t i = __arrayLowerBound(p_cont->data, p_cont->n, val);
+    return i < p_cont->n && ((uint16_t*) p_cont->data)[i] == val;
+}
+
+
+/// Convert the array container into bitset container
+static void __containerToBitset(RoaringContainer *p_cont) {
+    uint64_t *words = (uint64_t*) memCalloc(MEM_TAG_MAPS, __ROARING_BITSET_WORD_C, sizeof(uint64_t));
+    if(!words) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const uint16_t *vals = (uint16_t*) p_cont->data;
+    for(size_t i = 0; i < p_cont->n; i++)
+        words[vals[i] >> 6] |= (uint64_t) 1 << (vals[i] & 63);
+
+    memFree(MEM_TAG_MAPS, p_cont->data, __containerSize(p_cont));
+    p_cont->data = words;
+    p_cont->cap = 0;
+    p_cont->is_bitset = true;
+}
+
+
+/// Convert the bitset container into array container if its cardinality allows it
+static void __containerNormalize(RoaringContainer *p_cont) {
+    if(!p_cont->is_bitset || p_cont->n > __ROARING_ARRAY_MAX_C)
+        return;
+
+    uint16_t *vals = (uint16_t*) memAlloc(MEM_TAG_MAPS, (p_cont->n ? p_cont->n : 1) * sizeof(uint16_t));
+    if(!vals) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    const uint64_t *words = (uint64_t*) p_cont->data;
+    size_t n = 0;
+    for(size_t i = 0; i < __ROARING_BITSET_WORD_C; i++) {
+        for(uint64_t word = words[i]; word; word &= word - 1)
+            vals[n++] = (uint16_t) (i * 64 + __builtin_ctzll(word));
+    }
+
+    memFree(MEM_TAG_MAPS, p_cont->data, __containerSize(p_cont));
+    p_cont->data = vals;
+    p_cont->cap = p_cont->n ? p_cont->n : 1;
+    p_cont->is_bitset = false;
+}
+
+
+/// Recalculate the cardinality of the bitset container from its words
+static void __containerRecount(RoaringContainer *p_cont) {
+    const uint64_t *words = (uint64_t*) p_cont->data;
+    uint32_t n = 0;
+    for(size_t i = 0; i < __ROARING_BITSET_WORD_C; i++)
+        n += (uint32_t) __builtin_popcountll(words[i]);
+
+    p_cont->n = n;
+}
+
+
+/// Add the value into the container
+static void __containerAdd(RoaringContainer *p_cont, uint16_t val) {
+    if(p_cont->is_bitset) {
+        uint64_t *p_word = (uint64_t*) p_cont->data + (val >> 6);
+        uint64_t bit = (uint64_t) 1 << (val & 63);
+        p_cont->n += !(*p_word & bit);
+        *p_word |= bit;
+        return;
+    }
+
+    // Appending to the end of the array is checked before searching
+    uint16_t *vals = (uint16_t*) p_cont->data;
+    size_t i = p_cont->n && vals[p_cont->n - 1] < val ? p_cont->n :
+        __arrayLowerBound(vals, p_cont->n, val);
+    if(i < p_cont->n && vals[i] == val)
+        return;
+
+    // Full array container is converted into bitset
+    if(p_cont->n == __ROARING_ARRAY_MAX_C) {
+        __containerToBitset(p_cont);
+        __containerAdd(p_cont, val);
+        return;
+    }
+
+    if(p_cont->n == p_cont->cap) {
+        size_t old_cap = p_cont->cap;
+        p_cont->cap = p_cont->cap ? p_cont->cap << 1 : 4;
+        if(p_cont->cap > __ROARING_ARRAY_MAX_C)
+            p_cont->cap = __ROARING_ARRAY_MAX_C;
+
+        vals = (uint16_t*) memRealloc(MEM_TAG_MAPS, p_cont->data, old_cap * sizeof(uint16_t),
+            p_cont->cap * sizeof(uint16_t));
+        if(!vals) {
+            fprintf(stderr, "Failed to allocate memory for bitmap\n");
+            exit(EXIT_FAILURE);
+        }
+        p_cont->data = vals;
+    }
+
+    memmove(vals + i + 1, vals + i, (p_cont->n - i) * sizeof(uint16_t));
+    vals[i] = val;
+    p_cont->n++;
+}
+
+
+/// Remove the value from the container
+/// Returns true if the value was in the container
+static bool __containerRemove(RoaringContainer *p_cont, uint16_t val) {
+    if(!__containerContains(p_cont, val))
+        return false;
+
+    if(p_cont->is_bitset) {
+        ((uint64_t*) p_cont->data)[val >> 6] &= ~((uint64_t) 1 << (val & 63));
+        p_cont->n--;
+        __containerNormalize(p_cont);
+        return true;
+    }
+
+    uint16_t *vals = (uint16_t*) p_cont->data;
+    size_t i = __arrayLowerBound(vals, p_cont->n, val);
+    memmove(vals + i, vals + i + 1, (p_cont->n - i - 1) * sizeof(uint16_t));
+    p_cont->n--;
+    return true;
+}
+
+
+/// Copy the source container into uninitialised destination container
+static void __containerCopy(RoaringContainer *p_dst, const RoaringContainer *p_src) {
+    *p_dst = *p_src;
+    size_t size = p_src->is_bitset ? __ROARING_BITSET_WORD_C * sizeof(uint64_t) :
+        (p_src->n ? p_src->n : 1) * sizeof(uint16_t);
+
+    p_dst->data = memAlloc(MEM_TAG_MAPS, size);
+    if(!p_dst->data) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(p_dst->data, p_src->data, p_src->is_bitset ? size : p_src->n * sizeof(uint16_t));
+    p_dst->cap = p_src->is_bitset ? 0 : (p_src->n ? p_src->n : 1);
+}
+
+
+/// Perform union of the containers into the destination container
+static void __containerOr(RoaringContainer *p_dst, const RoaringContainer *p_src) {
+    if(p_src->is_bitset && !p_dst->is_bitset)
+        __containerToBitset(p_dst);
+
+    if(p_dst->is_bitset) {
+        if(p_src->is_bitset) {
+            uint64_t *words = (uint64_t*) p_dst->data;
+            const uint64_t *src_words = (uint64_t*) p_src->data;
+            for(size_t i = 0; i < __ROARING_BITSET_WORD_C; i++)
+                words[i] |= src_words[i];
+            __containerRecount(p_dst);
+        }
+        else {
+            const uint16_t *src_vals = (uint16_t*) p_src->data;
+            for(size_t i = 0; i < p_src->n; i++)
+                __containerAdd(p_dst, src_vals[i]);
+        }
+        return;
+    }
+
+    // Merge both sorted arrays, the result is converted into bitset if it grows too big
+    const uint16_t *a = (uint16_t*) p_dst->data;
+    const uint16_t *b = (uint16_t*) p_src->data;
+    size_t cap = p_dst->n + p_src->n ? p_dst->n + p_src->n : 1;
+    uint16_t *vals = (uint16_t*) memAlloc(MEM_TAG_MAPS, cap * sizeof(uint16_t));
+    if(!vals) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t i = 0, j = 0, n = 0;
+    while(i < p_dst->n && j < p_src->n) {
+        if(a[i] < b[j]) vals[n++] = a[i++];
+        else if(b[j] < a[i]) vals[n++] = b[j++];
+        else {
+            vals[n++] = a[i++];
+            j++;
+        }
+    }
+
+    for(; i < p_dst->n; i++) vals[n++] = a[i];
+    for(; j < p_src->n; j++) vals[n++] = b[j];
+
+    memFree(MEM_TAG_MAPS, p_dst->data, __containerSize(p_dst));
+    p_dst->data = vals;
+    p_dst->n = (uint32_t) n;
+    p_dst->cap = (uint32_t) cap;
+    if(n > __ROARING_ARRAY_MAX_C)
+        __containerToBitset(p_dst);
+}
+
+
+/// Perform intersection of the containers into the destination container
+static void __containerAnd(RoaringContainer *p_dst, const RoaringContainer *p_src) {
+    // Array values are filtered in place
+    if(!p_dst->is_bitset) {
+        uint16_t *vals = (uint16_t*) p_dst->data;
+        size_t n = 0;
+        for(size_t i = 0; i < p_dst->n; i++) {
+            if(__containerContains(p_src, vals[i]))
+                vals[n++] = vals[i];
+        }
+
+        p_dst->n = (uint32_t) n;
+        return;
+    }
+
+    // Intersection of bitset and array is at most as big as the array
+    if(!p_src->is_bitset) {
+        const uint16_t *src_vals = (uint16_t*) p_src->data;
+        size_t cap = p_src->n ? p_src->n : 1;
+        uint16_t *vals = (uint16_t*) memAlloc(MEM_TAG_MAPS, cap * sizeof(uint16_t));
+        if(!vals) {
+            fprintf(stderr, "Failed to allocate memory for bitmap\n");
+            exit(EXIT_FAILURE);
+        }
+
+        size_t n = 0;
+        for(size_t i = 0; i < p_src->n; i++) {
+            if(__containerContains(p_dst, src_vals[i]))
+                vals[n++] = src_vals[i];
+        }
+
+        memFree(MEM_TAG_MAPS, p_dst->data, __containerSize(p_dst));
+        p_dst->data = vals;
+        p_dst->n = (uint32_t) n;
+        p_dst->cap = (uint32_t) cap;
+        p_dst->is_bitset = false;
+        return;
+    }
+
+    uint64_t *words = (uint64_t*) p_dst->data;
+    const uint64_t *src_words = (uint64_t*) p_src->data;
+    for(size_t i = 0; i < __ROARING_BITSET_WORD_C; i++)
+        words[i] &= src_words[i];
+
+    __containerRecount(p_dst);
+    __containerNormalize(p_dst);
+}
+
+
+/// Remove all values of the source container from the destination container
+static void __containerAndNot(RoaringContainer *p_dst, const RoaringContainer *p_src) {
+    // Array values are filtered in place
+    if(!p_dst->is_bitset) {
+        uint16_t *vals = (uint16_t*) p_dst->data;
+        size_t n = 0;
+        for(size_t i = 0; i < p_dst->n; i++) {
+            if(!__containerContains(p_src, vals[i]))
+                vals[n++] = vals[i];
+        }
+
+        p_dst->n = (uint32_t) n;
+        return;
+    }
+
+    uint64_t *words = (uint64_t*) p_dst->data;
+    if(p_src->is_bitset) {
+        const uint64_t *src_words = (uint64_t*) p_src->data;
+        for(size_t i = 0; i < __ROARING_BITSET_WORD_C; i++)
+            words[i] &= ~src_words[i];
+    }
+    else {
+        const uint16_t *src_vals = (uint16_t*) p_src->data;
+        for(size_t i = 0; i < p_src->n; i++)
+            words[src_vals[i] >> 6] &= ~((uint64_t) 1 << (src_vals[i] & 63));
+    }
+
+    __containerRecount(p_dst);
+    __containerNormalize(p_dst);
+}
+
+
+/// Remove the empty containers from the bitmap
+static void __roaringCompact(RoaringBitmap *p_bm) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_bm->n; i++) {
+        if(p_bm->conts[i].n) p_bm->conts[n++] = p_bm->conts[i];
+        else __containerDestroy(p_bm->conts + i);
+    }
+
+    p_bm->n = n;
+}
+
+
+/// Add the value into the bitmap
+/// Values are appended in constant time when they are added in increasing order
+void roaringAdd(RoaringBitmap *p_bm, uint32_t val) {
+    __containerAdd(__roaringGet(p_bm, (uint16_t) (val >> 16)), (uint16_t) val);
+}
+
+
+/// Add all values in range [beg, end) into the bitmap
+void roaringAddRange(RoaringBitmap *p_bm, uint32_t beg, uint32_t end) {
+    while(beg < end) {
+        // Find the end of the range in the current container
+        uint64_t cont_end = ((uint64_t) (beg >> 16) + 1) << 16;
+        uint32_t stop = cont_end < end ? (uint32_t) cont_end : end;
+
+        RoaringContainer *p_cont = __roaringGet(p_bm, (uint16_t) (beg >> 16));
+        if(!p_cont->is_bitset)
+            __containerToBitset(p_cont);
+
+        // Set the bits of the range one word at a time
+        uint64_t *words = (uint64_t*) p_cont->data;
+        for(uint32_t val = beg; val < stop;) {
+            uint32_t bit = val & 63;
+            uint32_t c = 64 - bit < stop - val ? 64 - bit : stop - val;
+            uint64_t mask = c == 64 ? UINT64_MAX : (((uint64_t) 1 << c) - 1) << bit;
+            words[(val & 0xffff) >> 6] |= mask;
+            val += c;
+        }
+
+        __containerRecount(p_cont);
+        __containerNormalize(p_cont);
+        beg = stop;
+    }
+}
+
+
+/// Remove the value from the bitmap
+void roaringRemove(RoaringBitmap *p_bm, uint32_t val) {
+    RoaringContainer *p_cont = __roaringFind(p_bm, (uint16_t) (val >> 16));
+    if(!p_cont || !__containerRemove(p_cont, (uint16_t) val) || p_cont->n)
+        return;
+
+    // Remove the empty container
+    size_t i = p_cont - p_bm->conts;
+    __containerDestroy(p_cont);
+    memmove(p_bm->conts + i, p_bm->conts + i + 1, (p_bm->n - i - 1) * sizeof(RoaringContainer));
+    p_bm->n--;
+}
+
+
+/// Check if the bitmap contains the value
+bool roaringContains(const RoaringBitmap *p_bm, uint32_t val) {
+    const RoaringContainer *p_cont = __roaringFind(p_bm, (uint16_t) (val >> 16));
+    return p_cont && __containerContains(p_cont, (uint16_t) val);
+}
+
+
+/// Find the amount of values in the bitmap
+size_t roaringCardinality(const RoaringBitmap *p_bm) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_bm->n; i++)
+        n += p_bm->conts[i].n;
+
+    return n;
+}
+
+
+/// Find the 64 bits of the bitmap starting from the given value, which must be
+/// a multiple of 64, where bit i is set if the bitmap contains value beg + i
+uint64_t roaringWord(const RoaringBitmap *p_bm, uint32_t beg) {
+    const RoaringContainer *p_cont = __roaringFind(p_bm, (uint16_t) (beg >> 16));
+    if(!p_cont) return 0;
+
+    const uint16_t low = (uint16_t) beg;
+    if(p_cont->is_bitset)
+        return ((uint64_t*) p_cont->data)[low >> 6];
+
+    const uint16_t *vals = (uint16_t*) p_cont->data;
+    uint64_t word = 0;
+    for(size_t i = __arrayLowerBound(vals, p_cont->n, low); i < p_cont->n && vals[i] - low < 64; i++)
+        word |= (uint64_t) 1 << (vals[i] - low);
+
+    return word;
+}
+
+
+/// Write all values of the bitmap in increasing order into the output array
+/// Returns the amount of values written
+size_t roaringToArray(const RoaringBitmap *p_bm, uint32_t *out) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_bm->n; i++) {
+        const RoaringContainer *p_cont = p_bm->conts + i;
+        const uint32_t base = (uint32_t) p_cont->key << 16;
+
+        if(!p_cont->is_bitset) {
+            const uint16_t *vals = (uint16_t*) p_cont->data;
+            for(size_t j = 0; j < p_cont->n; j++)
+                out[n++] = base | vals[j];
+            continue;
+        }
+
+        const uint64_t *words = (uint64_t*) p_cont->data;
+        for(size_t j = 0; j < __ROARING_BITSET_WORD_C; j++) {
+            for(uint64_t word = words[j]; word; word &= word - 1)
+                out[n++] = base | (uint32_t) (j * 64 + __builtin_ctzll(word));
+        }
+    }
+
+    return n;
+}
+
+
+/// Copy the source bitmap into the destination bitmap, previous destination values
+/// are discarded
+void roaringCopy(RoaringBitmap *p_dst, const RoaringBitmap *p_src) {
+    destroyRoaring(p_dst);
+    p_dst->cap = p_src->n ? p_src->n : 1;
+    p_dst->conts = (RoaringContainer*) memAlloc(MEM_TAG_MAPS, p_dst->cap * sizeof(RoaringContainer));
+    if(!p_dst->conts) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < p_src->n; i++)
+        __containerCopy(p_dst->conts + i, p_src->conts + i);
+    p_dst->n = p_src->n;
+}
+
+
+/// Add all values of the source bitmap into the destination bitmap
+void roaringOr(RoaringBitmap *p_dst, const RoaringBitmap *p_src) {
+    if(!p_src->n) return;
+
+    // Merge the containers of both bitmaps in key order
+    size_t cap = p_dst->n + p_src->n;
+    RoaringContainer *conts = (RoaringContainer*) memAlloc(MEM_TAG_MAPS, cap * sizeof(RoaringContainer));
+    if(!conts) {
+        fprintf(stderr, "Failed to allocate memory for bitmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t i = 0, j = 0, n = 0;
+    while(i < p_dst->n || j < p_src->n) {
+        if(j == p_src->n || (i < p_dst->n && p_dst->conts[i].key < p_src->conts[j].key))
+            conts[n++] = p_dst->conts[i++];
+        else if(i == p_dst->n || p_src->conts[j].key < p_dst->conts[i].key)
+            __containerCopy(conts + n++, p_src->conts + j++);
+        else {
+            conts[n] = p_dst->conts[i++];
+            __containerOr(conts + n++, p_src->conts + j++);
+        }
+    }
+
+    memFree(MEM_TAG_MAPS, p_dst->conts, p_dst->cap * sizeof(RoaringContainer));
+    p_dst->conts = conts;
+    p_dst->n = n;
+    p_dst->cap = cap;
+}
+
+
+/// Keep only the destination bitmap values that are also in the source bitmap
+void roaringAnd(RoaringBitmap *p_dst, const RoaringBitmap *p_src) {
+    size_t j = 0;
+    for(size_t i = 0; i < p_dst->n; i++) {
+        RoaringContainer *p_cont = p_dst->conts + i;
+        while(j < p_src->n && p_src->conts[j].key < p_cont->key)
+            j++;
+
+        if(j < p_src->n && p_src->conts[j].key == p_cont->key)
+            __containerAnd(p_cont, p_src->conts + j);
+        else __containerDestroy(p_cont);
+    }
+
+    __roaringCompact(p_dst);
+}
+
+
+/// Remove all values of the source bitmap from the destination bitmap
+void roaringAndNot(RoaringBitmap *p_dst, const RoaringBitmap *p_src) {
+    size_t j = 0;
+    for(size_t i = 0; i < p_dst->n; i++) {
+        RoaringContainer *p_cont = p_dst->conts + i;
+        while(j < p_src->n && p_src->conts[j].key < p_cont->key)
+            j++;
+
+        if(j < p_src->n && p_src->conts[j].key == p_cont->key)
+            __containerAndNot(p_cont, p_src->conts + j);
+    }
+
+    __roaringCompact(p_dst);
+}
+
+
+/// Free all memory allocated for the bitmap
+void destroyRoaring(RoaringBitmap *p_bm) {
+    for(size_t i = 0; i < p_bm->n; i++)
+        __containerDestroy(p_bm->conts + i);
+
+    memFree(MEM_TAG_MAPS, p_bm->conts, p_bm->cap * sizeof(RoaringContainer));
+    memset(p_bm, 0, sizeof(RoaringBitmap));
+}
+
+
+/// Find the amount of allocated bytes in the bitmap that are not used by its values
+/// Bitset containers always take their full size, so only array containers have slack
+size_t roaringSlack(const RoaringBitmap *p_bm) {
+    size_t slack = (p_bm->cap - p_bm->n) * sizeof(RoaringContainer);
+    for(size_t i = 0; i < p_bm->n; i++) {
+        if(!p_bm->conts[i].is_bitset)
+            slack += (p_bm->conts[i].cap - p_bm->conts[i].n) * sizeof(uint16_t);
+    }
+
+    return slack;
+}
+
+
+/// Find the index of the first bitmap index entry with key not smaller than the given key
+static size_t __bitmapIndexLowerBound(const BitmapIndex *p_idx, uint32_t key) {
+    size_t lo = 0, hi = p_idx->n;
+    while(lo < hi) {
+        size_t mid = lo + (hi - lo) / 2;
+        if(p_idx->entries[mid].key < key) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return lo;
+}
+
+
+/// Find the bitmap of rows with the given key, NULL is returned if the key
+/// is not in the index
+RoaringBitmap *bitmapIndexFind(BitmapIndex *p_idx, uint32_t key) {
+    size_t i = __bitmapIndexLowerBound(p_idx, key);
+    return i < p_idx->n && p_idx->entries[i].key == key ? &p_idx->entries[i].rows : NULL;
+}
+
+
+/// Add the row under the given key into the bitmap index
+void bitmapIndexAdd(BitmapIndex *p_idx, uint32_t key, uint32_t row) {
+    size_t i = __bitmapIndexLowerBound(p_idx, key);
+
+    // Insert a new key
+    if(i == p_idx->n || p_idx->entries[i].key != key) {
+        memReallocCheck(MEM_TAG_MAPS, (void**) &p_idx->entries, sizeof(BitmapIndexEntry), p_idx->n + 1,
+            &p_idx->cap);
+        memmove(p_idx->entries + i + 1, p_idx->entries + i, (p_idx->n - i) * sizeof(BitmapIndexEntry));
+        p_idx->entries[i] = (BitmapIndexEntry) { .key = key };
+        p_idx->n++;
+    }
+
+    roaringAdd(&p_idx->entries[i].rows, row);
+}
+
+
+/// Remove the row under the given key from the bitmap index, keys without
+/// rows are removed from the index
+void bitmapIndexRemove(BitmapIndex *p_idx, uint32_t key, uint32_t row) {
+    size_t i = __bitmapIndexLowerBound(p_idx, key);
+    if(i == p_idx->n || p_idx->entries[i].key != key)
+        return;
+
+    roaringRemove(&p_idx->entries[i].rows, row);
+    if(p_idx->entries[i].rows.n)
+        return;
+
+    destroyRoaring(&p_idx->entries[i].rows);
+    memmove(p_idx->entries + i, p_idx->entries + i + 1, (p_idx->n - i - 1) * sizeof(BitmapIndexEntry));
+    p_idx->n--;
+}
+
+
+/// Find the amount of allocated bytes in the bitmap index that are not used by its rows
+size_t bitmapIndexSlack(const BitmapIndex *p_idx) {
+    size_t slack = (p_idx->cap - p_idx->n) * sizeof(BitmapIndexEntry);
+    for(size_t i = 0; i < p_idx->n; i++)
+        slack += roaringSlack(&p_idx->entries[i].rows);
+
+    return slack;
+}
+
+
+/// Free all memory allocated for the bitmap index
+void destroyBitmapIndex(BitmapIndex *p_idx) {
+    for(size_t i = 0; i < p_idx->n; i++)
+        destroyRoaring(&p_idx->entries[i].rows);
+
+    memFree(MEM_TAG_MAPS, p_idx->entries, p_idx->cap * sizeof(BitmapIndexEntry));
+    memset(p_idx, 0, sizeof(BitmapIndex));
+}
@@ -24,7 +24,7 @@ void __readFileToBuffer(char *file_name, char **p_buf, size_t *p_len) {
     fseek(file, 0, SEEK_SET);
 
     // Allocate memory for char buffer
-    (*p_buf) = (char*) calloc((*p_len) + 1, sizeof(char));
+    (*p_buf) = (char*) memCalloc(MEM_TAG_PARSER, (*p_len) + 1, sizeof(char));
 
     // Read file contents into 
     size_t res = fread(*p_buf, sizeof(char), *p_len, file);
@@ -76,7 +76,7 @@ void __parseCSVRow(char *beg, char *end, char *file_name, uint32_t line, CsvRow
     // Allocate initial amount of memory for row entries
     p_row->cap = __MAX_SEP_C + 1;
     p_row->n = 0;
-    p_row->entries = (CsvEntry*) calloc(p_row->cap, sizeof(CsvEntry));
+    p_row->entries = (CsvEntry*) memCalloc(MEM_TAG_PARSER, p_row->cap, sizeof(CsvEntry));
 
     // For each separator instance check the values inbetween
     for(size_t i = 0; i < sep_c + 1; i++) {
@@ -110,7 +110,7 @@ void __parseCSVRow(char *beg, char *end, char *file_name, uint32_t line, CsvRow
         // Assign quoted string value
         if(buf_len > 2 && *buf == '\"' && buf[buf_len - 1] == '\"') {
             p_row->entries[p_row->n].entry_type = CSV_ENTRY_TYPE_STRING;
-            p_row->entries[p_row->n].str_data = (char*) calloc(buf_len, sizeof(char));
+            p_row->entries[p_row->n].str_data = (char*) memCalloc(MEM_TAG_PARSER, buf_len - 1, sizeof(char));
             strncpy(p_row->entries[p_row->n].str_data, buf + 1, buf_len - 2);
             p_row->n++;
         }
@@ -137,7 +137,7 @@ void __parseCSVRow(char *beg, char *end, char *file_name, uint32_t line, CsvRow
 
             // Allocate memory and copy the string
             p_row->entries[p_row->n].entry_type = CSV_ENTRY_TYPE_STRING;
-            p_row->entries[p_row->n].str_data = (char*) calloc(buf_end - buf + 1, sizeof(char));
+            p_row->entries[p_row->n].str_data = (char*) memCalloc(MEM_TAG_PARSER, buf_end - buf + 1, sizeof(char));
             strncpy(p_row->entries[p_row->n].str_data, buf, buf_end - buf);
             p_row->n++;
         }
@@ -146,14 +146,15 @@ void __parseCSVRow(char *beg, char *end, char *file_name, uint32_t line, CsvRow
 
 
 /// Parse all CSV rows and check if the csv table has constant amount of columns
-void __parseCSVRows(char *buf, size_t buf_len, char *file_name, CsvRow **p_rows, size_t *p_row_c) {
+void __parseCSVRows(char *buf, size_t buf_len, char *file_name, CsvRow **p_rows, size_t *p_row_c,
+    size_t *p_row_cap) {
     char *cur = buf;
     char *next = NULL;
     char *end = buf;
 
     // Allocate initial amount of memory for csv rows
-    size_t row_cap = __DEFAULT_POWER_PLANT_CAP;
-    *p_rows = (CsvRow*) malloc(row_cap * sizeof(CsvRow));
+    *p_row_cap = __DEFAULT_POWER_PLANT_CAP;
+    *p_rows = (CsvRow*) memAlloc(MEM_TAG_PARSER, (*p_row_cap) * sizeof(CsvRow));
 
     // While the current reading pointer is not over the buffer, parse line
     uint32_t line = 1;
@@ -162,7 +163,7 @@ void __parseCSVRows(char *buf, size_t buf_len, char *file_name, CsvRow **p_rows,
         end = !end ? buf + buf_len : end;
 
         // Check if memory reallocation is needed
-        reallocCheck((void**) p_rows, sizeof(CsvRow), (*p_row_c) + 1, &row_cap);
+        memReallocCheck(MEM_TAG_PARSER, (void**) p_rows, sizeof(CsvRow), (*p_row_c) + 1, p_row_cap);
 
         // Parse the current line and set the value accordingly
         __parseCSVRow(cur, end, file_name, line, ((*p_rows) + (*p_row_c)));
@@ -213,15 +214,12 @@ double __csvEntryRetrieveFloat(CsvEntry *p_entry) {
 }
 
 /// Check the current entry for string value and return it, when possible
-char *__csvEntryRetrieveString(CsvEntry *p_entry) {
+char *__csvEntryRetrieveString(CsvEntry *p_entry, Arena *p_arena) {
     // Check the entry type
     switch(p_entry->entry_type) {
-    case CSV_ENTRY_TYPE_STRING: {
-        // Allocate new memory and copy string value to it
-        char *new_str = (char*) calloc(strlen(p_entry->str_data) + 1, sizeof(char));
-        strcpy(new_str, p_entry->str_data);
-        return new_str;
-    }
+    case CSV_ENTRY_TYPE_STRING:
+        // Copy string value to arena memory
+        return arenaStrdup(p_arena, p_entry->str_data);
 
     case CSV_ENTRY_TYPE_FLOAT: 
         fprintf(stderr, "Invalid entry type, got float but expected string\n");
@@ -275,31 +273,18 @@ FuelType __csvCheckFuelType(CsvEntry *p_entry) {
 }
 
 
-/// Check the entry for string date format and try to parse it into Date structure
-Date __csvCheckDateType(char *file_name, CsvEntry *p_entry) {
-    // Buffer variable declarations
-    char yyyy[8] = { 0 }; 
-    char mm[4] = { 0 };
-    char dd[4] = { 0 };
+/// Check the entry for string date format and try to parse it into epoch day
+int32_t __csvCheckDateType(char *file_name, CsvEntry *p_entry) {
+    int32_t day = 0;
 
     // Check the entry type
     switch(p_entry->entry_type) {
     case CSV_ENTRY_TYPE_STRING:
-        // Check if string date has correct amount of characters (yyyy-mm-dd, so 10 characters) and format
-        if(strlen(p_entry->str_data) != 10 || (p_entry->str_data[4] != '-' && p_entry->str_data[7]))
+        // Parse yyyy-mm-dd string directly into days since 1970-01-01
+        if(!parseDate(p_entry->str_data, strlen(p_entry->str_data), &day))
             INVALID_DATE_FORMAT(file_name, p_entry->str_data);
 
-        // Copy year, month and day to their buffer
-        strncpy(yyyy, p_entry->str_data, 4);
-        strncpy(mm, p_entry->str_data + 5, 2);
-        strncpy(dd, p_entry->str_data + 8, 2);
-
-        Date date;
-        date.year = (uint16_t) atoi(yyyy);
-        date.month = (uint16_t) atoi(mm);
-        date.day = (uint16_t) atoi(dd);
-
-        return date;
+        return day;
 
     case CSV_ENTRY_TYPE_FLOAT: 
         fprintf(stderr, "Invalid entry type, got float but expected string\n");
@@ -314,6 +299,42 @@ Date __csvCheckDateType(char *file_name, CsvEntry *p_entry) {
 }
 
 
+/// Verify the log CSV row data types and set the values into LogEntry
+void __csvRowToLogEntry(char *file_name, CsvRow *p_row, LogEntry *p_entry) {
+    // Check if the current row contains correct amount of entries
+    if(p_row->n != 5)
+        INVALID_ARG_C(file_name);
+
+    // Verify that the data is correct and set it to LogEntry values
+    // 0. Log id (integer, can be a float)
+    // 1. Plant number (integer, can be a float)
+    // 2. Production for that day (float, can be an integer)
+    // 3. Average cost for of energy for that day (float, can be an integer)
+    // 4. Date (string)
+    p_entry->log_id = (uint32_t) __csvEntryRetrieveInteger(&p_row->entries[0]);
+    if(p_entry->log_id == DEAD_LOG_ID) {
+        fprintf(stderr, "Log id %u in file '%s' is reserved for deleted logs\n", DEAD_LOG_ID, file_name);
+        exit(EXIT_FAILURE);
+    }
+
+    p_entry->plant_no = (uint32_t) __csvEntryRetrieveInteger(&p_row->entries[1]);
+    p_entry->production = (float) __csvEntryRetrieveFloat(&p_row->entries[2]);
+    p_entry->avg_sale_price = (float) __csvEntryRetrieveFloat(&p_row->entries[3]);
+    p_entry->date = __csvCheckDateType(file_name, &p_row->entries[4]);
+}
+
+
+/// Free all memory allocated for CSV row entries
+void __freeCSVRow(CsvRow *p_row) {
+    for(size_t j = 0; j < p_row->n; j++) {
+        if(p_row->entries[j].entry_type == CSV_ENTRY_TYPE_STRING)
+            memFree(MEM_TAG_PARSER, p_row->entries[j].str_data, strlen(p_row->entries[j].str_data) + 1);
+    }
+
+    memFree(MEM_TAG_PARSER, p_row->entries, p_row->cap * sizeof(CsvEntry));
+}
+
+
 /// High level function to parse all data from csv power plant file
 void parsePowerPlantFile(char *file_name, PowerPlants *p_plants) {
     char *buf = NULL;
@@ -323,13 +344,13 @@ void parsePowerPlantFile(char *file_name, PowerPlants *p_plants) {
     __readFileToBuffer(file_name, &buf, &len);
 
     CsvRow *rows = NULL;
-    size_t row_c = 0;
-    __parseCSVRows(buf, len, file_name, &rows, &row_c);
+    size_t row_c = 0, row_cap = 0;
+    __parseCSVRows(buf, len, file_name, &rows, &row_c, &row_cap);
 
     // Allocate reserve memory for power plants since it is not known how many plants would be in the file 
     p_plants->cap = row_c < __DEFAULT_POWER_PLANT_CAP ? __DEFAULT_POWER_PLANT_CAP : __roundToBase2(row_c << 1);
     p_plants->n = 0;
-    p_plants->plants = (PlantData*) malloc(p_plants->cap * sizeof(PlantData));
+    p_plants->plants = (PlantData*) memAlloc(MEM_TAG_PLANTS, p_plants->cap * sizeof(PlantData));
     p_plants->max_id = 0;
     
     // For each row verify the correct data type and and set the PlantData values
@@ -344,10 +365,15 @@ void parsePowerPlantFile(char *file_name, PowerPlants *p_plants) {
         // 2. Fuel type (string: "coal", "shaleoil", "gas", "uranium", "water", "wind", "geothermal")
         // 3. Rated capacity (integer / float)
         p_plants->plants[i].no = (uint32_t) __csvEntryRetrieveInteger(&rows[i].entries[0]);
-        p_plants->plants[i].name = __csvEntryRetrieveString(&rows[i].entries[1]);
+        p_plants->plants[i].name = __csvEntryRetrieveString(&rows[i].entries[1], &p_plants->arena);
         p_plants->plants[i].fuel = __csvCheckFuelType(&rows[i].entries[2]);
         p_plants->plants[i].rated_cap = __csvEntryRetrieveFloat(&rows[i].entries[3]);
         p_plants->plants[i].avg_cost = 0.0;
+        p_plants->plants[i].avg_utilisation = 0.0;
+        p_plants->plants[i].agg = (PlantAggregates) { 0 };
+        p_plants->plants[i].rollup = (PlantRollup) { 0 };
+        p_plants->plants[i].sketch = (PlantSketches) { 0 };
+        p_plants->plants[i].archive = (PlantArchive) { 0 };
         p_plants->n++;
 
         // Check if maximum value should be updated
@@ -355,17 +381,16 @@ void parsePowerPlantFile(char *file_name, PowerPlants *p_plants) {
             p_plants->max_id = p_plants->plants[i].no;
 
         // Free the CSV row data
-        for(size_t j = 0; j < rows[i].n; j++) {
-            if(rows[i].entries[j].entry_type == CSV_ENTRY_TYPE_STRING)
-                free(rows[i].entries[j].str_data);
-        }
-        free(rows[i].entries);
+        __freeCSVRow(rows + i);
     }
 
-    free(rows);
+    memFree(MEM_TAG_PARSER, rows, row_cap * sizeof(CsvRow));
+
+    // Release the reserve capacity, since the amount of power plants is now known
+    memShrinkToFit(MEM_TAG_PLANTS, (void**) &p_plants->plants, sizeof(PlantData), p_plants->n, &p_plants->cap);
 
     // Free the allocated char buffer
-    free(buf);
+    memFree(MEM_TAG_PARSER, buf, len + 1);
 }
 
 
@@ -378,34 +403,20 @@ void parseLogsFile(char *file_name, PlantLogs *p_logs) {
     __readFileToBuffer(file_name, &buf, &len);
 
     CsvRow *rows = NULL;
-    size_t row_c = 0;
-    __parseCSVRows(buf, len, file_name, &rows, &row_c);
+    size_t row_c = 0, row_cap = 0;
+    __parseCSVRows(buf, len, file_name, &rows, &row_c, &row_cap);
 
     // Allocate initial amount of memory for logs
     p_logs->cap = row_c < __DEFAULT_LOG_CAP ? __DEFAULT_LOG_CAP : __roundToBase2(row_c);
     p_logs->n = 0;
-    p_logs->entries = (LogEntry*) malloc(p_logs->cap * sizeof(LogEntry));
+    p_logs->entries = (LogEntry*) memAlloc(MEM_TAG_LOGS, p_logs->cap * sizeof(LogEntry));
 
     // Set the initial max id value
     p_logs->max_id = 0;
     
     // For each row verify the correct data type and set LogEntry value
     for(size_t i = 0; i < row_c; i++) {
-        // Check if the current row contains correct amount of entries
-        if(rows[i].n != 5)
-            INVALID_ARG_C(file_name);
-
-        // Verify that the data is correct and set it to LogEntry values
-        // 0. Log id (integer, can be a float)
-        // 1. Plant number (integer, can be a float)
-        // 2. Production for that day (float, can be an integer)
-        // 3. Average cost for of energy for that day (float, can be an integer)
-        // 4. Date (string)
-        p_logs->entries[i].log_id = (uint32_t) __csvEntryRetrieveInteger(&rows[i].entries[0]);
-        p_logs->entries[i].plant_no = (uint32_t) __csvEntryRetrieveInteger(&rows[i].entries[1]);
-        p_logs->entries[i].production = (float) __csvEntryRetrieveFloat(&rows[i].entries[2]);
-        p_logs->entries[i].avg_sale_price = (float) __csvEntryRetrieveFloat(&rows[i].entries[3]);
-        p_logs->entries[i].date = __csvCheckDateType(file_name, &rows[i].entries[4]);
+        __csvRowToLogEntry(file_name, rows + i, p_logs->entries + i);
         p_logs->n++;
 
         // Check if maximum value should be updated
@@ -413,16 +424,25 @@ void parseLogsFile(char *file_name, PlantLogs *p_logs) {
             p_logs->max_id = p_logs->entries[i].log_id;
 
         // Free csv row entry data
-        for(size_t j = 0; j < rows[i].n; j++) {
-            if(rows[i].entries[j].entry_type == CSV_ENTRY_TYPE_STRING)
-                free(rows[i].entries[j].str_data);
-        }
-
-        free(rows[i].entries);
+        __freeCSVRow(rows + i);
     }
 
-    free(rows);
+    memFree(MEM_TAG_PARSER, rows, row_cap * sizeof(CsvRow));
+
+    // Release the rounded up capacity, logs are appended one at a time afterwards
+    memShrinkToFit(MEM_TAG_LOGS, (void**) &p_logs->entries, sizeof(LogEntry), p_logs->n, &p_logs->cap);
 
     // Free allocated buffer data
-    free(buf);
+    memFree(MEM_TAG_PARSER, buf, len + 1);
+}
+
+
+/// Parse a single log CSV line into LogEntry structure
+/// The line is given by its beginning and end pointers, where end points to
+/// the line terminator or to the end of the buffer
+void parseLogLine(char *beg, char *end, char *file_name, uint32_t line, LogEntry *p_entry) {
+    CsvRow row = { 0 };
+    __parseCSVRow(beg, end, file_name, line, &row);
+    __csvRowToLogEntry(file_name, &row, p_entry);
+    __freeCSVRow(&row);
 }
@@ -0,0 +1,421 @@
+/*
+ * File:        data_store.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for keeping power plants and logs in a
+ *              memory mapped data file
+ */
+
+
+#define __DATA_STORE_C
+#include <data_store.h>
+
+
+/// Round the size up to the section alignment
+static size_t __alignStore(size_t size) {
+    return (size + __STORE_ALIGNMENT - 1) & ~((size_t) __STORE_ALIGNMENT - 1);
+}
+
+
+/// Resize the data file and map all of it again
+/// NOTE: Pointers into the previous mapping are invalid afterwards
+static void __mapDataStore(DataStore *p_store, size_t size) {
+    if(size != p_store->size && ftruncate(p_store->fd, (off_t) size)) {
+        fprintf(stderr, "Failed to resize data store file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Pages of the previous mapping are shared with the file, so no changes are lost
+    if(p_store->map)
+        munmap(p_store->map, p_store->size);
+
+    p_store->map = (uint8_t*) mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, p_store->fd, 0);
+    if(p_store->map == MAP_FAILED) {
+        fprintf(stderr, "Failed to map data store file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    p_store->size = size;
+}
+
+
+/// Change the capacity of the log section, the tail is moved to follow the log section
+static void __resizeStoreLogs(DataStore *p_store, PlantLogs *p_logs, size_t cap) {
+    __StoreHeader *p_hdr = (__StoreHeader*) p_store->map;
+    const size_t tail_off = p_hdr->plant_off;
+    const size_t tail_size = p_store->size - tail_off;
+    const size_t new_tail_off = __alignStore(p_hdr->log_off + cap * sizeof(LogEntry));
+    const size_t size = new_tail_off + tail_size;
+
+    // The file is grown before the tail is moved up and shrunk after it is moved down
+    if(size > p_store->size)
+        __mapDataStore(p_store, size);
+
+    p_hdr = (__StoreHeader*) p_store->map;
+    memmove(p_store->map + new_tail_off, p_store->map + tail_off, tail_size);
+    p_hdr->plant_off = p_hdr->plant_off - tail_off + new_tail_off;
+    p_hdr->name_off = p_hdr->name_off - tail_off + new_tail_off;
+    p_hdr->archive_off = p_hdr->archive_off - tail_off + new_tail_off;
+    p_hdr->log_cap = cap;
+
+    if(size < p_store->size)
+        __mapDataStore(p_store, size);
+
+    // Mapped rows are accounted separately from the heap
+    memTrackFree(MEM_TAG_STORE, p_logs->cap * sizeof(LogEntry));
+    memTrackAlloc(MEM_TAG_STORE, cap * sizeof(LogEntry));
+    p_hdr = (__StoreHeader*) p_store->map;
+    p_logs->entries = (LogEntry*) (p_store->map + p_hdr->log_off);
+    p_logs->cap = cap;
+}
+
+
+/// Check that the header and all sections of the data file are within the file
+static void __validateDataStore(const DataStore *p_store, const char *file_name) {
+    const __StoreHeader *p_hdr = (const __StoreHeader*) p_store->map;
+    if(p_store->size < __STORE_HEADER_SIZE || memcmp(p_hdr->magic, __STORE_MAGIC, sizeof(__STORE_MAGIC)) ||
+       p_hdr->version != __STORE_VERSION || p_hdr->header_size != __STORE_HEADER_SIZE)
+        INVALID_STORE_ERR(file_name);
+
+    // Sizes are compared against the remaining file size, so that they cannot overflow
+    const size_t size = p_store->size;
+    if(p_hdr->log_off != __STORE_HEADER_SIZE || p_hdr->log_n > p_hdr->log_cap ||
+       p_hdr->plant_off % __STORE_ALIGNMENT || p_hdr->name_size % __STORE_ALIGNMENT ||
+       p_hdr->log_cap > (size - p_hdr->log_off) / sizeof(LogEntry) ||
+       p_hdr->plant_off < p_hdr->log_off + p_hdr->log_cap * sizeof(LogEntry) || p_hdr->plant_off > size ||
+       p_hdr->plant_n > (size - p_hdr->plant_off) / sizeof(__StorePlant) ||
+       p_hdr->name_off != p_hdr->plant_off + p_hdr->plant_n * sizeof(__StorePlant) ||
+       p_hdr->name_size > size - p_hdr->name_off ||
+       p_hdr->archive_off != p_hdr->name_off + p_hdr->name_size ||
+       p_hdr->archive_size != size - p_hdr->archive_off)
+        INVALID_STORE_ERR(file_name);
+}
+
+
+/// Load power plants, their names and archives from the tail of the data file
+static void __loadStorePlants(const DataStore *p_store, const char *file_name, PowerPlants *p_plants) {
+    const __StoreHeader *p_hdr = (const __StoreHeader*) p_store->map;
+    const __StorePlant *records = (const __StorePlant*) (p_store->map + p_hdr->plant_off);
+    const char *names = (const char*) (p_store->map + p_hdr->name_off);
+    const uint8_t *archives = p_store->map + p_hdr->archive_off;
+
+    p_plants->n = p_hdr->plant_n;
+    p_plants->cap = p_hdr->plant_n ? p_hdr->plant_n : 1;
+    p_plants->max_id = p_hdr->plant_max_id;
+    p_plants->plants = (PlantData*) memCalloc(MEM_TAG_PLANTS, p_plants->cap, sizeof(PlantData));
+    if(!p_plants->plants) {
+        fprintf(stderr, "Failed to allocate memory for power plants\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < p_plants->n; i++) {
+        const __StorePlant *p_rec = records + i;
+        PlantData *p_plant = p_plants->plants + i;
+        if(p_rec->fuel > FUEL_TYPE_GEOTHERMAL || p_rec->name_off >= p_hdr->name_size ||
+           p_rec->name_len >= p_hdr->name_size - p_rec->name_off || names[p_rec->name_off + p_rec->name_len])
+            INVALID_STORE_ERR(file_name);
+
+        p_plant->no = p_rec->no;
+        p_plant->name = arenaStrdup(&p_plants->arena, names + p_rec->name_off);
+        p_plant->fuel = (FuelType) p_rec->fuel;
+        p_plant->rated_cap = p_rec->rated_cap;
+
+        // Archive blocks are copied out of the mapping, since they are reallocated
+        // when more logs are archived
+        PlantArchive *p_arch = &p_plant->archive;
+        size_t off = p_rec->archive_off;
+        if(p_rec->block_c) {
+            p_arch->blocks = (ArchiveBlock*) memAlloc(MEM_TAG_ARCHIVE, p_rec->block_c * sizeof(ArchiveBlock));
+            p_arch->cap = p_rec->block_c;
+        }
+
+        for(uint32_t j = 0; j < p_rec->block_c; j++) {
+            if(off > p_hdr->archive_size || p_hdr->archive_size - off < sizeof(__StoreBlock))
+                INVALID_STORE_ERR(file_name);
+
+            const __StoreBlock *p_block = (const __StoreBlock*) (archives + off);
+            off += sizeof(__StoreBlock);
+            if(p_block->size > p_hdr->archive_size - off || !p_block->n || p_block->n > ARCHIVE_BLOCK_LOG_C)
+                INVALID_STORE_ERR(file_name);
+
+            ArchiveBlock *p_dst = p_arch->blocks + p_arch->n++;
+            p_dst->data = (uint8_t*) memAlloc(MEM_TAG_ARCHIVE, p_block->size);
+            if(!p_dst->data) {
+                fprintf(stderr, "Failed to allocate memory for log archive\n");
+                exit(EXIT_FAILURE);
+            }
+
+            memcpy(p_dst->data, archives + off, p_block->size);
+            p_dst->size = p_block->size;
+            p_dst->n = p_block->n;
+            p_dst->first_date = p_block->first_date;
+            p_dst->last_date = p_block->last_date;
+            p_arch->log_c += p_block->n;
+            off += __alignStore(p_block->size);
+        }
+    }
+}
+
+
+/// Remove the log rows, which were deleted or belong to deleted power plants after
+/// the last sync, by moving the following rows back
+/// Returns the amount of removed rows
+static size_t __dropDeadStoreRows(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs) {
+    IdMap plant_map;
+    newIdMap(&plant_map, p_plants->n);
+    for(size_t i = 0; i < p_plants->n; i++)
+        idMapPut(&plant_map, p_plants->plants[i].no, (uint32_t) i);
+
+    // Rows are only written when a row before them was removed, so that the pages
+    // of a cleanly synced file stay unchanged
+    size_t live_c = 0;
+    for(size_t i = 0; i < p_logs->n; i++) {
+        LogEntry *p_entry = p_logs->entries + i;
+        if(p_entry->log_id == DEAD_LOG_ID || idMapFind(&plant_map, p_entry->plant_no) == ID_MAP_NONE)
+            continue;
+
+        if(live_c != i)
+            p_logs->entries[live_c] = *p_entry;
+        live_c++;
+    }
+
+    destroyIdMap(&plant_map);
+    size_t dead_c = p_logs->n - live_c;
+    p_logs->n = live_c;
+    ((__StoreHeader*) p_store->map)->log_n = live_c;
+    return dead_c;
+}
+
+
+/// Open the data file and map its log rows into log entries, power plants and their
+/// archives are loaded into memory
+/// Logs are not associated with their power plants yet
+/// NOTE: Rows that were deleted after the last sync have DEAD_LOG_ID as their log id
+/// and they are removed
+void openDataStore(DataStore *p_store, const char *file_name, PowerPlants *p_plants, PlantLogs *p_logs) {
+    memset(p_store, 0, sizeof(DataStore));
+    p_store->fd = open(file_name, O_RDWR);
+    if(p_store->fd < 0) FOPEN_ERR(file_name);
+
+    struct stat st;
+    if(fstat(p_store->fd, &st)) FREAD_ERR(file_name);
+    if((size_t) st.st_size < __STORE_HEADER_SIZE)
+        INVALID_STORE_ERR(file_name);
+
+    // Mapping the current size leaves the file as it is
+    p_store->size = (size_t) st.st_size;
+    __mapDataStore(p_store, (size_t) st.st_size);
+    __validateDataStore(p_store, file_name);
+    __loadStorePlants(p_store, file_name, p_plants);
+
+    __StoreHeader *p_hdr = (__StoreHeader*) p_store->map;
+    p_logs->entries = (LogEntry*) (p_store->map + p_hdr->log_off);
+    p_logs->n = p_hdr->log_n;
+    p_logs->cap = p_hdr->log_cap;
+    p_logs->max_id = p_hdr->log_max_id;
+    p_logs->store = p_store;
+    memTrackAlloc(MEM_TAG_STORE, p_logs->cap * sizeof(LogEntry));
+
+    size_t dead_c = __dropDeadStoreRows(p_store, p_plants, p_logs);
+    if(dead_c)
+        printf("Removed %zu deleted log row(s) from %s\n", dead_c, file_name);
+
+    // Archived logs stay in the aggregates of their power plants and their ids stay reserved
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        for(size_t j = 0; j < p_plant->archive.n; j++) {
+            size_t block_n = decodeArchiveBlock(p_plant->archive.blocks + j, p_plant->no, block);
+            for(size_t k = 0; k < block_n; k++) {
+                roaringAdd(&p_logs->archived_ids, block[k].log_id);
+                addLogAggregates(p_plant, block + k);
+            }
+        }
+    }
+
+    p_store->last_sync = (int64_t) time(NULL);
+}
+
+
+/// Create a new data file from the loaded power plants and logs, afterwards the log
+/// entries are mapped from the data file
+void createDataStore(DataStore *p_store, const char *file_name, PowerPlants *p_plants, PlantLogs *p_logs) {
+    memset(p_store, 0, sizeof(DataStore));
+    p_store->fd = open(file_name, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if(p_store->fd < 0) FOPEN_ERR(file_name);
+
+    // The tail is empty until the first sync
+    size_t cap = p_logs->n > __STORE_MIN_LOG_CAP ? p_logs->n : __STORE_MIN_LOG_CAP;
+    size_t tail_off = __alignStore(__STORE_HEADER_SIZE + cap * sizeof(LogEntry));
+    __mapDataStore(p_store, tail_off);
+
+    __StoreHeader *p_hdr = (__StoreHeader*) p_store->map;
+    memcpy(p_hdr->magic, __STORE_MAGIC, sizeof(__STORE_MAGIC));
+    p_hdr->version = __STORE_VERSION;
+    p_hdr->header_size = __STORE_HEADER_SIZE;
+    p_hdr->log_off = __STORE_HEADER_SIZE;
+    p_hdr->log_n = p_logs->n;
+    p_hdr->log_cap = cap;
+    p_hdr->plant_off = p_hdr->name_off = p_hdr->archive_off = tail_off;
+
+    // Log rows are moved into the mapping, the indexes hold rows, so they stay valid
+    memcpy(p_store->map + p_hdr->log_off, p_logs->entries, p_logs->n * sizeof(LogEntry));
+    memFree(MEM_TAG_LOGS, p_logs->entries, p_logs->cap * sizeof(LogEntry));
+    memTrackAlloc(MEM_TAG_STORE, cap * sizeof(LogEntry));
+    p_logs->entries = (LogEntry*) (p_store->map + p_hdr->log_off);
+    p_logs->cap = cap;
+    p_logs->store = p_store;
+
+    syncDataStore(p_store, p_plants, p_logs);
+}
+
+
+/// Allocate a new log row at the end of the mapped log section, which is grown if needed
+/// The new row is marked as deleted until it is written, and the row count in the data
+/// file is updated
+uint32_t allocStoreLogRow(DataStore *p_store, PlantLogs *p_logs) {
+    if(p_logs->n + 1 > p_logs->cap)
+        __resizeStoreLogs(p_store, p_logs, p_logs->cap << 1);
+
+    // Rows after the row count can hold stale data of moved rows or the tail
+    uint32_t row = (uint32_t) p_logs->n++;
+    memset(p_logs->entries + row, 0, sizeof(LogEntry));
+    p_logs->entries[row].log_id = DEAD_LOG_ID;
+    ((__StoreHeader*) p_store->map)->log_n = p_logs->n;
+    return row;
+}
+
+
+/// Release the unused log section capacity after the log rows were compacted
+void fitStoreLogs(DataStore *p_store, PlantLogs *p_logs) {
+    ((__StoreHeader*) p_store->map)->log_n = p_logs->n;
+
+    size_t cap = p_logs->n > __STORE_MIN_LOG_CAP ? p_logs->n : __STORE_MIN_LOG_CAP;
+    if(cap < p_logs->cap)
+        __resizeStoreLogs(p_store, p_logs, cap);
+}
+
+
+/// Copy reordered log entries over the mapped log rows, only the pages that
+/// differ are written, so that unchanged pages are not written back to the file
+void writeStoreLogs(PlantLogs *p_logs, const LogEntry *entries) {
+    const uint8_t *src = (const uint8_t*) entries;
+    uint8_t *dst = (uint8_t*) p_logs->entries;
+    const size_t size = p_logs->n * sizeof(LogEntry);
+
+    // The log section starts at a page boundary, so the chunks match the mapped pages
+    for(size_t off = 0; off < size; off += __STORE_PAGE_SIZE) {
+        size_t len = size - off < __STORE_PAGE_SIZE ? size - off : __STORE_PAGE_SIZE;
+        if(memcmp(dst + off, src + off, len))
+            memcpy(dst + off, src + off, len);
+    }
+}
+
+
+/// Write power plants and archives into the data file and flush all changes
+void syncDataStore(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs) {
+    __StoreHeader *p_hdr = (__StoreHeader*) p_store->map;
+
+    // Find the size of each tail section
+    size_t name_size = 0, archive_size = 0;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        const PlantArchive *p_arch = &p_plants->plants[i].archive;
+        name_size += strlen(p_plants->plants[i].name) + 1;
+        for(size_t j = 0; j < p_arch->n; j++)
+            archive_size += sizeof(__StoreBlock) + __alignStore(p_arch->blocks[j].size);
+    }
+    name_size = __alignStore(name_size);
+
+    const size_t plant_off = __alignStore(p_hdr->log_off + p_hdr->log_cap * sizeof(LogEntry));
+    const size_t name_off = plant_off + p_plants->n * sizeof(__StorePlant);
+    const size_t archive_off = name_off + name_size;
+    const size_t size = archive_off + archive_size;
+    if(size != p_store->size) {
+        __mapDataStore(p_store, size);
+        p_hdr = (__StoreHeader*) p_store->map;
+        p_logs->entries = (LogEntry*) (p_store->map + p_hdr->log_off);
+    }
+
+    // Write the tail sections, padding bytes are zeroed
+    memset(p_store->map + plant_off, 0, size - plant_off);
+    __StorePlant *records = (__StorePlant*) (p_store->map + plant_off);
+    char *names = (char*) (p_store->map + name_off);
+    uint8_t *archives = p_store->map + archive_off;
+    size_t name_pos = 0, archive_pos = 0;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        const PlantData *p_plant = p_plants->plants + i;
+        size_t name_len = strlen(p_plant->name);
+        records[i] = (__StorePlant) {
+            .no = p_plant->no,
+            .fuel = (uint32_t) p_plant->fuel,
+            .rated_cap = p_plant->rated_cap,
+            .block_c = (uint32_t) p_plant->archive.n,
+            .name_off = name_pos,
+            .archive_off = archive_pos,
+            .name_len = (uint32_t) name_len
+        };
+
+        memcpy(names + name_pos, p_plant->name, name_len + 1);
+        name_pos += name_len + 1;
+
+        for(size_t j = 0; j < p_plant->archive.n; j++) {
+            const ArchiveBlock *p_block = p_plant->archive.blocks + j;
+            *(__StoreBlock*) (archives + archive_pos) = (__StoreBlock) {
+                .size = p_block->size,
+                .n = p_block->n,
+                .first_date = p_block->first_date,
+                .last_date = p_block->last_date
+            };
+
+            archive_pos += sizeof(__StoreBlock);
+            memcpy(archives + archive_pos, p_block->data, p_block->size);
+            archive_pos += __alignStore(p_block->size);
+        }
+    }
+
+    p_hdr->plant_off = plant_off;
+    p_hdr->plant_n = p_plants->n;
+    p_hdr->name_off = name_off;
+    p_hdr->name_size = name_size;
+    p_hdr->archive_off = archive_off;
+    p_hdr->archive_size = archive_size;
+    p_hdr->plant_max_id = p_plants->max_id;
+    flushDataStore(p_store, p_logs);
+}
+
+
+/// Flush changed log rows and the row count into the data file
+void flushDataStore(DataStore *p_store, const PlantLogs *p_logs) {
+    __StoreHeader *p_hdr = (__StoreHeader*) p_store->map;
+    p_hdr->log_n = p_logs->n;
+    p_hdr->log_max_id = p_logs->max_id;
+    p_store->last_sync = (int64_t) time(NULL);
+    p_hdr->sync_time = p_store->last_sync;
+
+    // Only the dirty pages of the mapping are written
+    if(msync(p_store->map, p_store->size, MS_SYNC)) {
+        fprintf(stderr, "Failed to sync data store file\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/// Check if the changed log rows should be flushed
+bool isDataStoreSyncDue(const DataStore *p_store) {
+    return (int64_t) time(NULL) - p_store->last_sync >= DATA_STORE_SYNC_INTERVAL;
+}
+
+
+/// Sync the data store and unmap the data file
+void closeDataStore(DataStore *p_store, const PowerPlants *p_plants, PlantLogs *p_logs) {
+    syncDataStore(p_store, p_plants, p_logs);
+    memTrackFree(MEM_TAG_STORE, p_logs->cap * sizeof(LogEntry));
+    munmap(p_store->map, p_store->size);
+    close(p_store->fd);
+
+    p_logs->entries = NULL;
+    p_logs->cap = 0;
+    p_logs->store = NULL;
+    memset(p_store, 0, sizeof(DataStore));
+}
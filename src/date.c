@@ -0,0 +1,92 @@
+/*
+ * File:        date.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-03
+ * Last edit:   2021-06-03
+ * Description: Function definitions for converting between civil dates and
+ *              epoch days (days since 1970-01-01)
+ */
+
+
+#define __DATE_C
+#include <date.h>
+
+
+/// Check if the given year is a leap year
+bool __isLeapYear(int32_t year) {
+    return (!(year % 4) && (year % 100)) || !(year % 400);
+}
+
+
+/// Convert civil date into days since 1970-01-01
+/// The calculation is done in 400 year eras starting from March, so that
+/// the leap day is the last day of the shifted year
+int32_t dateToEpochDay(Date date) {
+    int32_t y = (int32_t) date.year - (date.month <= 2);
+    int32_t era = (y >= 0 ? y : y - 399) / 400;
+    uint32_t yoe = (uint32_t) (y - era * 400);
+    uint32_t doy = (153 * (date.month > 2 ? date.month - 3 : date.month + 9) + 2) / 5 + date.day - 1;
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + (int32_t) doe - 719468;
+}
+
+
+/// Convert days since 1970-01-01 into civil date
+Date epochDayToDate(int32_t day) {
+    day += 719468;
+    int32_t era = (day >= 0 ? day : day - 146096) / 146097;
+    uint32_t doe = (uint32_t) (day - era * 146097);
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    uint32_t mp = (5 * doy + 2) / 153;
+
+    Date date;
+    date.day = (uint16_t) (doy - (153 * mp + 2) / 5 + 1);
+    date.month = (uint16_t) (mp < 10 ? mp + 3 : mp - 9);
+    date.year = (uint16_t) ((int32_t) yoe + era * 400 + (date.month <= 2));
+    return date;
+}
+
+
+/// Convert days since 1970-01-01 into months since 1970-01
+int32_t epochDayToMonth(int32_t day) {
+    Date date = epochDayToDate(day);
+    return ((int32_t) date.year - 1970) * 12 + date.month - 1;
+}
+
+
+/// Find the amount of days in the given month
+uint16_t daysInMonth(int32_t year, uint16_t month) {
+    static const uint16_t days[] = { 31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if(month == 2 && __isLeapYear(year))
+        return 29;
+    return days[month - 1];
+}
+
+
+/// Parse date string in yyyy-mm-dd format directly into days since 1970-01-01
+/// Returns false if the string is not a valid date
+bool parseDate(const char *str, size_t len, int32_t *p_day) {
+    // Check the separator locations
+    if(len != 10 || str[4] != '-' || str[7] != '-')
+        return false;
+
+    // Check that all other characters are digits
+    for(size_t i = 0; i < len; i++) {
+        if(i != 4 && i != 7 && (str[i] < '0' || str[i] > '9'))
+            return false;
+    }
+
+    Date date;
+    date.year = (uint16_t) ((str[0] - '0') * 1000 + (str[1] - '0') * 100 + (str[2] - '0') * 10 + (str[3] - '0'));
+    date.month = (uint16_t) ((str[5] - '0') * 10 + (str[6] - '0'));
+    date.day = (uint16_t) ((str[8] - '0') * 10 + (str[9] - '0'));
+
+    // Check if the month and day values are in bounds
+    if(date.month < 1 || date.month > 12 || date.day < 1 || date.day > daysInMonth(date.year, date.month))
+        return false;
+
+    *p_day = dateToEpochDay(date);
+    return true;
+}
@@ -9,106 +9,215 @@
 #define __ENERGY_MANAGER_C
 #include <energy_manager.h>
 
-/// Create a new hashmap instance for power plants
-Hashmap createPowerPlantMap(PowerPlants *p_power_plants) {
-    Hashmap map = {};
-    newHashmap(&map, p_power_plants->cap << 1);
+/// Create a new id map instance for power plants
+IdMap createPowerPlantMap(PowerPlants *p_power_plants) {
+    IdMap map;
+    newIdMap(&map, p_power_plants->n);
 
-    // Variable for containing PlantData pointers retrieved from hashmap
-    PlantData *p_duplicate = NULL;
-
-    // For each power plant add it to hashmap if possible
+    // For each power plant add it to id map if possible
     for(size_t i = 0; i < p_power_plants->n; i++) {
         // Check if power plant with current key value already exists
-        if((p_duplicate = (PlantData*) findValue(&map, &p_power_plants->plants[i].no, sizeof(uint32_t)))) {
-            DuplicateEntryAction act = promptDuplicatePowerPlantEntries(p_power_plants->plants + i, p_duplicate);
-            handleDuplicatePowerPlantEntries(act, &map, p_power_plants,
-                p_power_plants->plants + i, p_duplicate, p_power_plants->plants[i].no);
+        uint32_t dup_row = idMapFind(&map, p_power_plants->plants[i].no);
+        if(dup_row != ID_MAP_NONE) {
+            DuplicateEntryAction act = promptDuplicatePowerPlantEntries(p_power_plants->plants + i, 
+                p_power_plants->plants + dup_row);
+            handleDuplicatePowerPlantEntries(act, &map, p_power_plants, dup_row, i);
         }
 
         // No duplicates were found
-        else {
-            pushToHashmap(&map, &p_power_plants->plants[i].no, sizeof(uint32_t), p_power_plants->plants + i);
-        }
+        else idMapPut(&map, p_power_plants->plants[i].no, (uint32_t) i);
     }
 
     return map;
 }
 
 
-/// Create a new hashmap instance for daily logs
-Hashmap createLogMap(PlantLogs *p_logs) {
-    Hashmap map = {};
-    newHashmap(&map, p_logs->cap << 1);
-
-    // Variable for containing PlantData pointers retrieved from hashmap
-    LogEntry *p_duplicate = NULL;
+/// Create a new id map instance for daily logs
+IdMap createLogMap(PlantLogs *p_logs) {
+    IdMap map;
+    newIdMap(&map, p_logs->n);
 
-    // For each power plant add it to hashmap if possible
+    // For each log add it to id map if possible
     for(size_t i = 0; i < p_logs->n; i++) {
-        // Check if power plant with current key value already exists
-        if((p_duplicate = (LogEntry*) findValue(&map, &p_logs->entries[i].log_id, sizeof(uint32_t)))) {
-            DuplicateEntryAction act = promptDuplicateLogEntries(p_logs->entries + i, p_duplicate);
-            handleDuplicateLogEntries(act, &map, p_logs, p_logs->entries + i, 
-                p_duplicate, p_logs->entries[i].log_id);
+        // Check if log with current key value already exists
+        uint32_t dup_row = idMapFind(&map, p_logs->entries[i].log_id);
+        if(dup_row != ID_MAP_NONE) {
+            DuplicateEntryAction act = promptDuplicateLogEntries(p_logs->entries + i, 
+                p_logs->entries + dup_row);
+            handleDuplicateLogEntries(act, &map, p_logs, dup_row, i);
         }
 
         // No duplicates were found
-        else {
-            pushToHashmap(&map, &p_logs->entries[i].log_id, sizeof(uint32_t), p_logs->entries + i);
-        }
+        else idMapPut(&map, p_logs->entries[i].log_id, (uint32_t) i);
     }
 
     return map;
 }
 
 
-/// Associate file read log data with its power plant instances
-void associateLogData(PowerPlants *p_power_plants, PlantLogs *p_logs, Hashmap *p_map) {
-    // For each power plant instance allocate initial amount of memory for logs
-    for(size_t i = 0; i < p_power_plants->n; i++) {
-        p_power_plants->plants[i].logs.cap = __DEFAULT_POWER_PLANT_LOG_C;
-        p_power_plants->plants[i].logs.n = 0;
-        p_power_plants->plants[i].logs.p_entries = (LogEntry**) calloc(__DEFAULT_POWER_PLANT_LOG_C,
-            sizeof(LogEntry*));
+/// Find the power plant with the given number, NULL is returned if it does not exist
+/// NOTE: The returned pointer is valid until the power plant array is modified
+PlantData *findPowerPlant(PowerPlants *p_plants, IdMap *p_map, uint32_t no) {
+    uint32_t row = idMapFind(p_map, no);
+    return row == ID_MAP_NONE ? NULL : p_plants->plants + row;
+}
+
+
+/// Find the log with the given id, NULL is returned if it does not exist
+/// NOTE: The returned pointer is valid until the log array is modified
+LogEntry *findLog(PlantLogs *p_logs, IdMap *p_map, uint32_t id) {
+    uint32_t row = idMapFind(p_map, id);
+    return row == ID_MAP_NONE ? NULL : p_logs->entries + row;
+}
+
+
+/// Make room for at least req_n log rows of the power plant, the rows are
+/// allocated from the power plant arena
+void reservePlantLogRows(Arena *p_arena, PlantLogRows *p_rows, size_t req_n) {
+    if(req_n <= p_rows->cap) return;
+
+    // Capacities are powers of two, which match the arena size classes
+    size_t cap = p_rows->cap > __DEFAULT_POWER_PLANT_LOG_C ? __roundToBase2(p_rows->cap - 1) : 
+        __DEFAULT_POWER_PLANT_LOG_C;
+    while(cap < req_n)
+        cap <<= 1;
+
+    // Slices of the shared row buffer are copied out, since they cannot be resized
+    if(p_rows->is_slice) {
+        uint32_t *rows = (uint32_t*) arenaAlloc(p_arena, cap * sizeof(uint32_t));
+        memcpy(rows, p_rows->rows, p_rows->n * sizeof(uint32_t));
+        p_rows->rows = rows;
+        p_rows->is_slice = false;
     }
 
-    
-    // For each log instance add it to correct power plant instance
-    for(size_t i = 0; i < p_logs->n; i++) {
-        PlantData *p_data = (PlantData*) findValue(p_map, &p_logs->entries[i].plant_no, sizeof(uint32_t));
+    else {
+        p_rows->rows = (uint32_t*) arenaRealloc(p_arena, p_rows->rows, p_rows->cap * sizeof(uint32_t),
+            cap * sizeof(uint32_t));
+    }
+
+    p_rows->cap = cap;
+}
+
+
+/// Free the log rows of the power plant, slices of the shared row buffer are
+/// released with the arena
+void freePlantLogRows(Arena *p_arena, PlantLogRows *p_rows) {
+    if(!p_rows->is_slice)
+        arenaFree(p_arena, p_rows->rows, p_rows->cap * sizeof(uint32_t));
+    memset(p_rows, 0, sizeof(PlantLogRows));
+}
+
+
+/// Associate file read log data with its power plant instances and build the
+/// bitmap indexes
+/// Logs are reordered with a counting sort on their power plant, so that the logs
+/// of each power plant occupy a single date ordered range of the log array, and the
+/// rows of each power plant are a slice of one shared row buffer
+void associateLogData (
+    PowerPlants *p_power_plants, 
+    PlantLogs *p_logs, 
+    IdMap *pow_map, 
+    IdMap *log_map
+) {
+    rebuildPlantIndexes(p_power_plants);
+    const size_t n = p_logs->n;
 
-        // Check if the found entry is NULL and if it is, throw an error
-        if(!p_data) {
+    // Count the logs of each power plant row
+    uint32_t *plant_rows = (uint32_t*) memAlloc(MEM_TAG_SORT, (n ? n : 1) * sizeof(uint32_t));
+    size_t *offsets = (size_t*) memCalloc(MEM_TAG_SORT, p_power_plants->n + 1, sizeof(size_t));
+    for(size_t i = 0; i < n; i++) {
+        uint32_t row = idMapFind(pow_map, p_logs->entries[i].plant_no);
+
+        // Check if the power plant exists and if it does not, throw an error
+        if(row == ID_MAP_NONE) {
             fprintf(stderr, "associateLogData(): Invalid plant number %d in log with id %d\n",
                 p_logs->entries[i].plant_no, p_logs->entries[i].log_id);
             exit(EXIT_FAILURE);
         }
 
-        // Check if reallocation might be needed
-        reallocCheck((void**) &p_data->logs.p_entries, sizeof(LogEntry*), p_data->logs.n + 1, 
-            &p_data->logs.cap);
+        plant_rows[i] = row;
+        offsets[row + 1]++;
+    }
+
+    // Prefix sums of the counts give the start of each power plant's range
+    for(size_t i = 0; i < p_power_plants->n; i++)
+        offsets[i + 1] += offsets[i];
+
+    // Order all logs by date, so that each power plant range is scattered in date
+    // order, logs are usually in time order, so the sort mostly has to verify 
+    // natural runs
+    LogEntry **order = (LogEntry**) memAlloc(MEM_TAG_SORT, (n ? n : 1) * sizeof(LogEntry*));
+    for(size_t i = 0; i < n; i++)
+        order[i] = p_logs->entries + i;
+    if(n) {
+        mergesort(order, offsetof(LogEntry, date), sizeof(LogEntry*), false,
+            SORT_VALUE_TYPE_DATE, true, 0, n - 1);
+    }
+
+    // Scatter the logs into their power plant ranges
+    size_t cap = p_logs->cap ? p_logs->cap : 1;
+    LogEntry *entries = (LogEntry*) memAlloc(MEM_TAG_LOGS, cap * sizeof(LogEntry));
+    size_t *cursors = (size_t*) memAlloc(MEM_TAG_SORT, (p_power_plants->n ? p_power_plants->n : 1) * sizeof(size_t));
+    if(!plant_rows || !offsets || !order || !entries || !cursors) {
+        fprintf(stderr, "Failed to allocate memory for log association\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memcpy(cursors, offsets, p_power_plants->n * sizeof(size_t));
+    for(size_t i = 0; i < n; i++) {
+        size_t dst = cursors[plant_rows[order[i] - p_logs->entries]]++;
+        entries[dst] = *order[i];
+        idMapPut(log_map, entries[dst].log_id, (uint32_t) dst);
+    }
+
+    // Mapped logs stay in the data file, where only the changed pages are written
+    if(p_logs->store) {
+        writeStoreLogs(p_logs, entries);
+        memFree(MEM_TAG_LOGS, entries, cap * sizeof(LogEntry));
+    }
 
-        // Set the log value to its power plant entry
-        p_data->logs.p_entries[p_data->logs.n] = p_logs->entries + i;
-        p_logs->entries[i].ref_ind = p_data->logs.n;
-        p_data->logs.n++;
+    else {
+        memFree(MEM_TAG_LOGS, p_logs->entries, p_logs->cap * sizeof(LogEntry));
+        p_logs->entries = entries;
+        p_logs->cap = cap;
     }
 
-    // For each power plant instance find its utilisation and average cost
+    // The logs are in power plant order, so the shared row buffer is the identity
+    uint32_t *rows = (uint32_t*) arenaAlloc(&p_power_plants->arena, (n ? n : 1) * sizeof(uint32_t));
+    for(size_t i = 0; i < n; i++)
+        rows[i] = (uint32_t) i;
+
+    // Each power plant's rows and aggregates are found from its own range
     for(size_t i = 0; i < p_power_plants->n; i++) {
-        calcAvgCost(p_power_plants->plants + i);
-        calcAvgUtilisation(p_power_plants->plants + i);
+        PlantData *p_data = p_power_plants->plants + i;
+        p_data->logs = (PlantLogRows) { 
+            .rows = rows + offsets[i], 
+            .n = offsets[i + 1] - offsets[i],
+            .cap = offsets[i + 1] - offsets[i],
+            .is_slice = true
+        };
+
+        for(size_t j = offsets[i]; j < offsets[i + 1]; j++)
+            addLogAggregates(p_data, p_logs->entries + j);
     }
+
+    // Rows are added to bitmap indexes in increasing order
+    for(size_t i = 0; i < n; i++)
+        addLogIndexes(p_logs, i);
+
+    memFree(MEM_TAG_SORT, cursors, (p_power_plants->n ? p_power_plants->n : 1) * sizeof(size_t));
+    memFree(MEM_TAG_SORT, order, (n ? n : 1) * sizeof(LogEntry*));
+    memFree(MEM_TAG_SORT, offsets, (p_power_plants->n + 1) * sizeof(size_t));
+    memFree(MEM_TAG_SORT, plant_rows, (n ? n : 1) * sizeof(uint32_t));
 }
 
 
 /// Overwrite existing power plant data instance value with given value
-/// NOTE: The given plant id has to be a valid key to value in hashmap, otherwise 
+/// NOTE: The given plant id has to be a valid key to value in id map, otherwise 
 /// an error will be thrown
-void overwritePlantData(PlantData *p_data, Hashmap *p_map) {
-    // Retrive a PlantData entry from hashmap
-    PlantData *p_hdata = (PlantData*) findValue(p_map, &p_data->no, sizeof(uint32_t));
+void overwritePlantData(PlantData *p_data, PowerPlants *p_plants, IdMap *p_map) {
+    // Retrive a PlantData entry from id map
+    PlantData *p_hdata = findPowerPlant(p_plants, p_map, p_data->no);
 
     // Check if no data was found and throw error if necessary
     if(!p_hdata) {
@@ -122,75 +231,52 @@ void overwritePlantData(PlantData *p_data, Hashmap *p_map) {
 
 
 /// Create a new power plant instance and push it to map
+/// The map holds row indices, so reallocating the power plant array needs no fix-up
 void newPowerPlant (
     PlantData *p_data, 
     PowerPlants *p_plants, 
-    Hashmap *p_map
+    IdMap *p_map
 ) {
-    // Check if data should be popped from hashmap due to the reallocation
-    if(p_plants->n + 1 <= p_plants->cap) {
-        for(size_t i = 0; i < p_plants->n; i++)
-            popFromHashmap(p_map, &p_plants->plants[i].no, sizeof(uint32_t));
-    }
-
     // Check if power plants array needs reallocation
-    reallocCheck((void**) &p_plants->plants, sizeof(PlantData), p_plants->n + 1,
+    memReallocCheck(MEM_TAG_PLANTS, (void**) &p_plants->plants, sizeof(PlantData), p_plants->n + 1,
         &p_plants->cap);
 
-    // Check if new references should be push to hashmap
-    if(p_plants->n + 1 <= p_plants->cap) {
-        // Check each plantdata instance pop and repush elements with correct memory address
-        for(size_t i = 0; i < p_plants->n; i++)
-            pushToHashmap(p_map, &p_plants->plants[i].no, sizeof(uint32_t), p_plants->plants + i);
-    }
-
-    // Set the new PlantData instance in power plants array
+    // Set the new PlantData instance in power plants array and map its row
     p_plants->plants[p_plants->n] = *p_data;
-
-    // Push the new entry to hashmap
-    pushToHashmap(p_map, &p_plants->plants[p_plants->n].no, sizeof(uint32_t), 
-        p_plants->plants + p_plants->n);
+    idMapPut(p_map, p_data->no, (uint32_t) p_plants->n);
 
     // Increment the power plant count
     p_plants->n++;
+    addPlantIndexes(p_plants, p_plants->n - 1);
 }
 
 
-/// Create a new power plant log entry for specific power plant
-/// NOTE: plant_no must be a correct key to the plant instance, otherwise
-/// an error is thrown
-void newPowerPlantLog(LogEntry *entry, PlantLogs *p_logs, Hashmap *p_map) {
-    // Check if reallocation might be necessary
-    LogEntry *old_addr = p_logs->entries;
-    reallocCheck((void**) &p_logs->entries, sizeof(LogEntry), p_logs->n + 1,
-        &p_logs->cap);
-
-    // Check if hashmap remapping is necessary
-    if(old_addr - p_logs->entries) {
-        // Check each plantdata instance pop and repush elements with correct memory address
-        for(size_t i = 0; i < p_logs->n; i++) {
-            popFromHashmap(p_map, &p_logs->entries[i].log_id, sizeof(uint32_t));
-            pushToHashmap(p_map, &p_logs->entries[i].log_id, sizeof(uint32_t), p_logs->entries + i);
-        }
-    }
+/// Create a new power plant log entry in a deleted row or at the end of the log array
+/// The map holds row indices, so reallocating the log array needs no fix-up
+/// Returns the row of the new log entry
+uint32_t newPowerPlantLog(LogEntry *entry, PlantLogs *p_logs, IdMap *p_map) {
+    uint32_t row = allocLogRow(p_logs);
 
-    // Set new log entry instance 
-    p_logs->entries[p_logs->n] = *entry;
-    p_logs->n++;
+    // Set new log entry instance and map its row
+    p_logs->entries[row] = *entry;
+    idMapPut(p_map, entry->log_id, row);
+    return row;
 }
 
 
 /// Handle duplicate power plant values according to the specified duplicate handling action
-/// mdup is the duplicate entry that exists in the map
-/// udup is the duplicate value that would be pushed to the map
+/// mdup_row is the row of the duplicate entry that exists in the map
+/// udup_row is the row of the duplicate entry that would be mapped
 void handleDuplicatePowerPlantEntries (
     DuplicateEntryAction action, 
-    Hashmap *p_map,
+    IdMap *p_map,
     PowerPlants *p_plants, 
-    PlantData *mdup, 
-    PlantData *udup, 
-    uint32_t key
+    size_t mdup_row, 
+    size_t udup_row
 ) {
+    PlantData *mdup = p_plants->plants + mdup_row;
+    PlantData *udup = p_plants->plants + udup_row;
+
     // Check the action type
     switch(action) {
     case DUPLICATE_ENTRY_ACTION_USE_UNMAPPED:
@@ -198,28 +284,21 @@ void handleDuplicatePowerPlantEntries (
         break;
 
     case DUPLICATE_ENTRY_ACTION_APPEND_MAPPED:
-        // Pop the current mapped pointer from the map
-        mdup = (PlantData*) popFromHashmap(p_map, &key, sizeof(uint32_t));
-        p_plants->plants[p_plants->n - 1].no = mdup->no;
+        // Give the mapped instance a new id and map the unmapped instance with the old one
+        udup->no = mdup->no;
         mdup->no = p_plants->max_id + 1;
         p_plants->max_id++;
 
-        // Push previously mapped instance back to the hashmap
-        pushToHashmap(p_map, &mdup->no, sizeof(uint32_t), mdup);
-        
-        // Push the unmapped instance to hashmap
-        pushToHashmap(p_map, &p_plants->plants[p_plants->n - 1].no, sizeof(uint32_t), udup);
+        idMapPut(p_map, mdup->no, (uint32_t) mdup_row);
+        idMapPut(p_map, udup->no, (uint32_t) udup_row);
         break;
 
 
     case DUPLICATE_ENTRY_ACTION_APPEND_UNMAPPED:
-        // Pop the current mapped pointer from the map
-        p_plants->plants[p_plants->n - 1].no = p_plants->max_id + 1;
+        // Give the unmapped instance a new id and map it
+        udup->no = p_plants->max_id + 1;
         p_plants->max_id++;
-        
-        // Push the unmapped instance to hashmap
-        pushToHashmap(p_map, &p_plants->plants[p_plants->n - 1].no, sizeof(uint32_t),
-            p_plants->plants + p_plants->n - 1);
+        idMapPut(p_map, udup->no, (uint32_t) udup_row);
         break;
 
     default:
@@ -229,16 +308,18 @@ void handleDuplicatePowerPlantEntries (
 
 
 /// Handle duplicate log values according to the specified duplicate handling action
-/// mdup is the duplicate entry that exists in the map
-/// udup is the duplicate value that would be pushed to the map
+/// mdup_row is the row of the duplicate entry that exists in the map
+/// udup_row is the row of the duplicate entry that would be mapped
 void handleDuplicateLogEntries (
     DuplicateEntryAction action, 
-    Hashmap *p_map,
+    IdMap *p_map,
     PlantLogs *p_logs,
-    LogEntry *mdup, 
-    LogEntry *udup,
-    uint32_t key
+    size_t mdup_row, 
+    size_t udup_row
 ) {
+    LogEntry *mdup = p_logs->entries + mdup_row;
+    LogEntry *udup = p_logs->entries + udup_row;
+
     // Check the duplicate handling action
     switch(action) {
     case DUPLICATE_ENTRY_ACTION_USE_UNMAPPED:
@@ -247,27 +328,21 @@ void handleDuplicateLogEntries (
         break;
 
     case DUPLICATE_ENTRY_ACTION_APPEND_MAPPED:
-        // Pop the current mapped pointer from the map
-        mdup = (LogEntry*) popFromHashmap(p_map, &key, sizeof(uint32_t));
-        p_logs->entries[p_logs->n - 1].log_id = mdup->log_id;
+        // Give the mapped instance a new id and map the unmapped instance with the old one
+        udup->log_id = mdup->log_id;
         mdup->log_id = p_logs->max_id + 1;
         p_logs->max_id++;
 
-        // Push previously mapped instance back to the hashmap
-        pushToHashmap(p_map, &mdup->log_id, sizeof(uint32_t), mdup);
-        
-        // Push the unmapped instance to hashmap
-        pushToHashmap(p_map, &p_logs->entries[p_logs->n - 1].log_id, sizeof(uint32_t), udup);
+        idMapPut(p_map, mdup->log_id, (uint32_t) mdup_row);
+        idMapPut(p_map, udup->log_id, (uint32_t) udup_row);
         break;
 
 
     case DUPLICATE_ENTRY_ACTION_APPEND_UNMAPPED:
-        // Pop the current mapped pointer from the map
-        p_logs->entries[p_logs->n - 1].log_id = p_logs->max_id + 1;
+        // Give the unmapped instance a new id and map it
+        udup->log_id = p_logs->max_id + 1;
         p_logs->max_id++;
-        
-        // Push the unmapped instance to hashmap
-        pushToHashmap(p_map, &p_logs->entries[p_logs->n - 1].log_id, sizeof(uint32_t), udup);
+        idMapPut(p_map, udup->log_id, (uint32_t) udup_row);
         break;
 
     default: 
@@ -0,0 +1,311 @@
+/*
+ * File:        ext_sort.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-02
+ * Last edit:   2021-06-02
+ * Description: Function definitions for sorting log files that do not fit into memory
+ */
+
+
+#define __EXT_SORT_C
+#include <ext_sort.h>
+
+
+/// Check if run a should be merged before run b
+/// Ties are resolved by run index, which keeps the merge stable
+bool __runBeats(__LoserTree *p_tree, size_t a, size_t b) {
+    if(p_tree->is_done[a]) return false;
+    if(p_tree->is_done[b]) return true;
+
+    if(p_tree->keys[a] != p_tree->keys[b])
+        return p_tree->keys[a] < p_tree->keys[b];
+    return a < b;
+}
+
+
+/// Build the loser tree subtree and return its winner run index
+size_t __buildLoserTree(__LoserTree *p_tree, size_t node) {
+    // Leaf nodes are located at indices k..2k - 1
+    if(node >= p_tree->k)
+        return node - p_tree->k;
+
+    size_t l = __buildLoserTree(p_tree, 2 * node);
+    size_t r = __buildLoserTree(p_tree, 2 * node + 1);
+
+    // Store the loser in the current node and pass the winner upwards
+    if(__runBeats(p_tree, l, r)) {
+        p_tree->nodes[node] = r;
+        return l;
+    }
+
+    p_tree->nodes[node] = l;
+    return r;
+}
+
+
+/// Replay the matches from the leaf of given run to the root
+void __replayLoserTree(__LoserTree *p_tree, size_t run) {
+    size_t winner = run;
+
+    // For each match on the path to root check if the stored loser wins
+    for(size_t node = (run + p_tree->k) / 2; node > 0; node /= 2) {
+        if(__runBeats(p_tree, p_tree->nodes[node], winner)) {
+            size_t tmp = p_tree->nodes[node];
+            p_tree->nodes[node] = winner;
+            winner = tmp;
+        }
+    }
+
+    p_tree->nodes[0] = winner;
+}
+
+
+/// Read the next buffered entries of a run from the spill file
+/// Returns false if the run is exhausted
+bool __refillRun(FILE *spill, __SortRun *p_run, size_t buf_cap) {
+    if(p_run->read_n >= p_run->n)
+        return false;
+
+    // Find how many entries to read
+    size_t n = p_run->n - p_run->read_n;
+    n = n > buf_cap ? buf_cap : n;
+
+    // Read the entries from the run location in the spill file
+    fseek(spill, (long) ((p_run->beg + p_run->read_n) * sizeof(LogEntry)), SEEK_SET);
+    if(fread(p_run->buf, sizeof(LogEntry), n, spill) != n) {
+        fprintf(stderr, "Failed to read sorted run from temporary file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    p_run->read_n += n;
+    p_run->buf_n = n;
+    p_run->buf_i = 0;
+    return true;
+}
+
+
+/// Write a single log entry as CSV line into the output stream
+void __writeSortedLogLine(FILE *file, LogEntry *p_entry) {
+    fprintf(file, "%d,%d,%f,%f,\"%s\"\n", p_entry->log_id, p_entry->plant_no,
+        p_entry->production, p_entry->avg_sale_price, formatDate(p_entry->date));
+}
+
+
+/// Sort the in-memory run and write it into the spill file
+void __spillRun(FILE *spill, PlantLogs *p_run, ListSortMode smode, __SortRun *p_info) {
+    __sortLogs(p_run, smode);
+
+    // Write the sorted run to the end of spill file
+    fseek(spill, 0, SEEK_END);
+    p_info->beg = (size_t) ftell(spill) / sizeof(LogEntry);
+    p_info->n = p_run->n;
+
+    if(fwrite(p_run->entries, sizeof(LogEntry), p_run->n, spill) != p_run->n) {
+        fprintf(stderr, "Failed to write sorted run into temporary file\n");
+        exit(EXIT_FAILURE);
+    }
+
+    p_run->n = 0;
+}
+
+
+/// Merge the sorted runs of the spill file with a loser tree in the given memory budget
+/// If is_csv is true, the merged entries after skip entries are written into out as CSV
+/// lines until left entries are written, otherwise all entries are appended into out
+/// as a single run
+void __mergeRuns (
+    FILE *spill,
+    __SortRun *runs,
+    size_t run_c,
+    ListSortMode smode,
+    size_t mem_budget,
+    FILE *out,
+    bool is_csv,
+    size_t skip,
+    size_t left
+) {
+    // Split the memory budget between run buffers
+    size_t buf_cap = mem_budget / (run_c * sizeof(LogEntry));
+    buf_cap = buf_cap < __MIN_RUN_BUF_C ? __MIN_RUN_BUF_C : buf_cap;
+
+    // Initialise the loser tree with the first entry of each run
+    __LoserTree tree = { 0 };
+    tree.k = run_c;
+    tree.nodes = (size_t*) calloc(run_c, sizeof(size_t));
+    tree.keys = (uint32_t*) calloc(run_c, sizeof(uint32_t));
+    tree.is_done = (bool*) calloc(run_c, sizeof(bool));
+
+    for(size_t i = 0; i < run_c; i++) {
+        runs[i].buf = (LogEntry*) malloc(buf_cap * sizeof(LogEntry));
+        runs[i].read_n = 0;
+        tree.is_done[i] = !__refillRun(spill, runs + i, buf_cap);
+        if(!tree.is_done[i])
+            tree.keys[i] = __sortLogKey(runs[i].buf, smode);
+    }
+
+    tree.nodes[0] = run_c == 1 ? 0 : __buildLoserTree(&tree, 1);
+
+    // Pop the winner run entry until all runs are exhausted
+    while(!tree.is_done[tree.nodes[0]] && left) {
+        size_t w = tree.nodes[0];
+        __SortRun *p_run = runs + w;
+
+        // Write the winner entry to output unless it is skipped
+        if(skip) skip--;
+        else if(is_csv) {
+            __writeSortedLogLine(out, p_run->buf + p_run->buf_i);
+            left--;
+        }
+
+        else if(fwrite(p_run->buf + p_run->buf_i, sizeof(LogEntry), 1, out) != 1) {
+            fprintf(stderr, "Failed to write sorted run into temporary file\n");
+            exit(EXIT_FAILURE);
+        }
+
+        // Advance the winner run and find its next key
+        p_run->buf_i++;
+        if(p_run->buf_i >= p_run->buf_n && !__refillRun(spill, p_run, buf_cap))
+            tree.is_done[w] = true;
+        else tree.keys[w] = __sortLogKey(p_run->buf + p_run->buf_i, smode);
+
+        if(run_c > 1)
+            __replayLoserTree(&tree, w);
+    }
+
+    // Free all merge resources
+    for(size_t i = 0; i < run_c; i++) {
+        free(runs[i].buf);
+        runs[i].buf = NULL;
+    }
+    free(tree.nodes);
+    free(tree.keys);
+    free(tree.is_done);
+}
+
+
+/// Sort the logs CSV file into output CSV file in bounded amount of memory
+/// Input is streamed into sorted runs that are spilled into a temporary file and then
+/// k-way merged with a loser tree, in multiple passes if there are too many runs to fit
+/// their buffers into the memory budget. Only the first sort mode of the query is used,
+/// but the query offset, limit and where clause are respected
+void sortLogsFile (
+    char *in_file,
+    char *out_file,
+    ListQuery *p_query,
+    size_t mem_budget
+) {
+    ListSortMode smode = p_query->smodes[0];
+    if(mem_budget < __MIN_SORT_MEM_BUDGET)
+        mem_budget = __MIN_SORT_MEM_BUDGET;
+
+    // Open input and output streams
+    FILE *in = fopen(in_file, "rb");
+    if(!in) FOPEN_ERR(in_file);
+
+    FILE *out = fopen(out_file, "wb");
+    if(!out) FOPEN_ERR(out_file);
+    setvbuf(out, NULL, _IOFBF, __OUT_STREAM_BUF_SIZE);
+
+    // Merge sort requires a scratch buffer of the same size as the run
+    PlantLogs run = { 0 };
+    run.cap = mem_budget / (2 * sizeof(LogEntry));
+    run.entries = (LogEntry*) malloc(run.cap * sizeof(LogEntry));
+
+    // Spill file and run information
+    FILE *spill = NULL;
+    __SortRun *runs = NULL;
+    size_t run_c = 0;
+    size_t runs_cap = 0;
+
+    // Stream the input file line by line into runs
+    char line[__MAX_LOG_LINE_SIZE + 2] = { 0 };
+    uint32_t line_no = 0;
+    while(fgets(line, sizeof(line), in)) {
+        line_no++;
+        size_t len = strlen(line);
+
+        // Check if the line did not fit into buffer
+        if(len && line[len - 1] != '\n' && !feof(in))
+            LINE_LENGTH_ERR(in_file, line_no);
+
+        // Strip the line terminators and skip empty lines
+        while(len && (line[len - 1] == '\n' || line[len - 1] == '\r'))
+            len--;
+        if(!len) continue;
+
+        // Check if the run is full and should be spilled
+        if(run.n == run.cap) {
+            if(!spill && !(spill = tmpfile())) {
+                fprintf(stderr, "Failed to create temporary file for sorting\n");
+                exit(EXIT_FAILURE);
+            }
+
+            reallocCheck((void**) &runs, sizeof(__SortRun), run_c + 1, &runs_cap);
+            memset(runs + run_c, 0, sizeof(__SortRun));
+            __spillRun(spill, &run, smode, runs + run_c);
+            run_c++;
+        }
+
+        // Only entries that match the where clause are sorted
+        parseLogLine(line, line + len, in_file, line_no, run.entries + run.n);
+        if(!p_query->pred_c || matchLogEntry(run.entries + run.n, p_query->pred, p_query->pred_c))
+            run.n++;
+    }
+    fclose(in);
+
+    size_t skip = p_query->offset;
+    size_t left = p_query->limit ? p_query->limit : SIZE_MAX;
+
+    // Check if all data fit into a single run, in which case no merging is needed
+    if(!run_c) {
+        __sortLogs(&run, smode);
+        for(size_t i = skip; i < run.n && left; i++, left--)
+            __writeSortedLogLine(out, run.entries + i);
+
+        free(run.entries);
+        fclose(out);
+        return;
+    }
+
+    // Spill the last run and release run memory for merge buffers
+    if(run.n) {
+        reallocCheck((void**) &runs, sizeof(__SortRun), run_c + 1, &runs_cap);
+        memset(runs + run_c, 0, sizeof(__SortRun));
+        __spillRun(spill, &run, smode, runs + run_c);
+        run_c++;
+    }
+    free(run.entries);
+
+    // Merge groups of runs into longer runs until the buffers of all runs fit into
+    // the memory budget, runs are merged in order so that the merge stays stable
+    const size_t max_fan_in = mem_budget / (__MIN_RUN_BUF_C * sizeof(LogEntry));
+    while(run_c > max_fan_in) {
+        FILE *next = tmpfile();
+        if(!next) {
+            fprintf(stderr, "Failed to create temporary file for sorting\n");
+            exit(EXIT_FAILURE);
+        }
+
+        size_t merged_c = 0;
+        for(size_t i = 0; i < run_c; i += max_fan_in, merged_c++) {
+            size_t group_c = run_c - i < max_fan_in ? run_c - i : max_fan_in;
+            __SortRun merged = { 0 };
+            merged.beg = (size_t) ftell(next) / sizeof(LogEntry);
+            for(size_t j = 0; j < group_c; j++)
+                merged.n += runs[i + j].n;
+
+            __mergeRuns(spill, runs + i, group_c, smode, mem_budget, next, false, 0, SIZE_MAX);
+            runs[merged_c] = merged;
+        }
+
+        fclose(spill);
+        spill = next;
+        run_c = merged_c;
+    }
+
+    __mergeRuns(spill, runs, run_c, smode, mem_budget, out, true, skip, left);
+    free(runs);
+
+    fclose(spill);
+    fclose(out);
+}
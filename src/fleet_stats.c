@@ -0,0 +1,181 @@
+/*
+ * File:        fleet_stats.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-07
+ * Last edit:   2021-06-07
+ * Description: Function definitions for computing fleet-wide statistics grouped by
+ *              power plant fuel type in a parallel reduction
+ */
+
+
+#define __FLEET_STATS_C
+#include <fleet_stats.h>
+
+
+/// Accumulate the task's log range into its partial per fuel statistics
+static void *__reduceFuelStatsTask(void *p_arg) {
+    __FuelStatsTask *p_task = (__FuelStatsTask*) p_arg;
+    const LogColumns *p_cols = p_task->p_logs->cols;
+    const uint64_t *tombs = p_task->p_logs->tombs.n ? p_task->p_logs->tombs.bits : NULL;
+
+    for(size_t i = p_task->beg; i < p_task->end; i++) {
+        // Skip deleted rows
+        if(tombs && (tombs[i >> 6] >> (i & 63) & 1))
+            continue;
+
+        // Read the log values from columns if available, since only three fields are needed
+        uint32_t plant_no;
+        float production, sale_price;
+        if(p_cols) {
+            plant_no = p_cols->plant_no[i];
+            production = p_cols->production[i];
+            sale_price = p_cols->avg_sale_price[i];
+        } else {
+            const LogEntry *p_entry = p_task->p_logs->entries + i;
+            plant_no = p_entry->plant_no;
+            production = p_entry->production;
+            sale_price = p_entry->avg_sale_price;
+        }
+
+        // Skip logs whose power plant no longer exists
+        if(plant_no >= p_task->info_c || !p_task->infos[plant_no].is_valid)
+            continue;
+
+        const __PlantFuelInfo *p_info = p_task->infos + plant_no;
+        FuelStats *p_stats = p_task->partial + p_info->fuel;
+        kahanAdd(&p_stats->production, production);
+        kahanAdd(&p_stats->sale_price, sale_price);
+        p_stats->log_c++;
+
+        // Rated production is found later from the amount of logs per plant
+        p_task->plant_log_c[plant_no]++;
+    }
+
+    return NULL;
+}
+
+
+/// Find the amount of threads to use for reducing n logs
+static size_t __fuelStatsThreadCount(size_t n, size_t req_c) {
+    if(!req_c) {
+        long core_c = sysconf(_SC_NPROCESSORS_ONLN);
+        req_c = core_c > 0 ? (size_t) core_c : 1;
+
+        // Small inputs are not worth the thread creation overhead
+        size_t max_c = n / __MIN_FUEL_STATS_TASK_SIZE;
+        req_c = req_c > max_c ? max_c : req_c;
+    }
+
+    req_c = req_c > __MAX_FUEL_STATS_THREAD_C ? __MAX_FUEL_STATS_THREAD_C : req_c;
+    req_c = req_c > n ? n : req_c;
+    return req_c ? req_c : 1;
+}
+
+
+/// Compute statistics per fuel type over all power plants and logs
+/// Logs are split into contiguous ranges, each reduced by its own thread into partial
+/// per fuel accumulators, which are combined at the end. If thread_c is 0, the amount
+/// of threads is chosen from the available cores and the amount of live logs
+/// Archived logs are decoded and reduced by the calling thread
+/// Returns the amount of threads that were used
+size_t calcFuelStats (
+    PowerPlants *p_plants,
+    PlantLogs *p_logs,
+    size_t thread_c,
+    FuelStats stats[FUEL_TYPE_C]
+) {
+    memset(stats, 0, FUEL_TYPE_C * sizeof(FuelStats));
+
+    // Build a dense plant number lookup table and accumulate the plant values
+    size_t info_c = 0;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        if(p_plants->plants[i].no >= info_c)
+            info_c = p_plants->plants[i].no + 1;
+    }
+
+    __PlantFuelInfo *infos = (__PlantFuelInfo*) calloc(info_c ? info_c : 1, sizeof(__PlantFuelInfo));
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        FuelType fuel = p_plant->fuel < FUEL_TYPE_C ? p_plant->fuel : FUEL_TYPE_UNKNOWN;
+
+        infos[p_plant->no].day_cap = p_plant->rated_cap * 24;
+        infos[p_plant->no].fuel = (uint8_t) fuel;
+        infos[p_plant->no].is_valid = true;
+
+        stats[fuel].plant_c++;
+        stats[fuel].rated_cap += p_plant->rated_cap;
+    }
+
+    // Split the logs into contiguous ranges of nearly equal size
+    thread_c = __fuelStatsThreadCount(p_logs->n, thread_c);
+    __FuelStatsTask *tasks = (__FuelStatsTask*) aligned_alloc(_Alignof(__FuelStatsTask),
+        thread_c * sizeof(__FuelStatsTask));
+    pthread_t *threads = (pthread_t*) malloc(thread_c * sizeof(pthread_t));
+    size_t *plant_log_c = (size_t*) calloc(thread_c * (info_c ? info_c : 1), sizeof(size_t));
+    if(!tasks || !threads || !plant_log_c) {
+        fprintf(stderr, "Failed to allocate memory for fuel statistics tasks\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < thread_c; i++) {
+        memset(tasks + i, 0, sizeof(__FuelStatsTask));
+        tasks[i].p_logs = p_logs;
+        tasks[i].infos = infos;
+        tasks[i].info_c = info_c;
+        tasks[i].plant_log_c = plant_log_c + i * info_c;
+        tasks[i].beg = p_logs->n * i / thread_c;
+        tasks[i].end = p_logs->n * (i + 1) / thread_c;
+    }
+
+    // The calling thread reduces the first range itself, while the rest are spawned
+    for(size_t i = 1; i < thread_c; i++) {
+        if(pthread_create(threads + i, NULL, __reduceFuelStatsTask, tasks + i)) {
+            fprintf(stderr, "Failed to create fuel statistics thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    __reduceFuelStatsTask(tasks);
+    for(size_t i = 1; i < thread_c; i++)
+        pthread_join(threads[i], NULL);
+
+    // Combine the partial accumulators of all threads
+    for(size_t i = 0; i < thread_c; i++) {
+        for(size_t j = 0; j < FUEL_TYPE_C; j++) {
+            FuelStats *p_part = tasks[i].partial + j;
+            kahanAdd(&stats[j].production, kahanValue(&p_part->production));
+            kahanAdd(&stats[j].sale_price, kahanValue(&p_part->sale_price));
+            stats[j].log_c += p_part->log_c;
+        }
+
+        for(size_t j = 0; j < info_c; j++) {
+            if(tasks[i].plant_log_c[j]) {
+                kahanAdd(&stats[infos[j].fuel].rated_prod, 
+                    tasks[i].plant_log_c[j] * (double) infos[j].day_cap);
+            }
+        }
+    }
+
+    // Archived logs are reduced by the calling thread, decoding one block at a time
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        FuelStats *p_stats = stats + infos[p_plant->no].fuel;
+        for(size_t j = 0; j < p_plant->archive.n; j++) {
+            size_t n = decodeArchiveBlock(p_plant->archive.blocks + j, p_plant->no, block);
+            for(size_t k = 0; k < n; k++) {
+                kahanAdd(&p_stats->production, block[k].production);
+                kahanAdd(&p_stats->sale_price, block[k].avg_sale_price);
+            }
+
+            p_stats->log_c += n;
+            kahanAdd(&p_stats->rated_prod, n * (double) infos[p_plant->no].day_cap);
+        }
+    }
+
+    free(plant_log_c);
+    free(threads);
+    free(tasks);
+    free(infos);
+    return thread_c;
+}
@@ -0,0 +1,291 @@
+/*
+ * File:        group_by.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for grouping logs by a key and aggregating
+ *              their values in a parallel hash aggregation
+ */
+
+
+#define __GROUP_BY_C
+#include <group_by.h>
+
+
+/// Find the hash table slot index of the key, which is either the slot with
+/// the key or the first empty slot in its probe sequence
+static size_t __groupTableProbe(const GroupTable *p_table, uint32_t key) {
+    // Fibonacci hashing spreads consecutive keys, such as months, over the table
+    size_t mask = p_table->cap - 1;
+    size_t i = (size_t) (((uint64_t) key * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while(p_table->slots[i].n && p_table->slots[i].key != key)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+
+/// Double the capacity of the hash table and reinsert all aggregates
+static void __groupTableGrow(GroupTable *p_table) {
+    GroupTable old = *p_table;
+    p_table->cap = old.cap ? old.cap << 1 : __GROUP_TABLE_MIN_CAP;
+    p_table->slots = (GroupAggregate*) calloc(p_table->cap, sizeof(GroupAggregate));
+    if(!p_table->slots) {
+        fprintf(stderr, "Failed to allocate memory for group table\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < old.cap; i++) {
+        if(old.slots[i].n)
+            p_table->slots[__groupTableProbe(p_table, old.slots[i].key)] = old.slots[i];
+    }
+
+    free(old.slots);
+}
+
+
+/// Find the aggregate of the key, the aggregate is created if it does not exist
+static GroupAggregate *__groupTableGet(GroupTable *p_table, uint32_t key) {
+    if(p_table->cap) {
+        GroupAggregate *p_agg = p_table->slots + __groupTableProbe(p_table, key);
+        if(p_agg->n) return p_agg;
+    }
+
+    // Keep the load factor at most one half, so that probe sequences stay short
+    if(2 * (p_table->n + 1) > p_table->cap)
+        __groupTableGrow(p_table);
+
+    // New aggregates are returned with n = 0 and become used on their first value
+    GroupAggregate *p_agg = p_table->slots + __groupTableProbe(p_table, key);
+    p_agg->key = key;
+    p_table->n++;
+    return p_agg;
+}
+
+
+/// Find the group key of the log according to the grouping key
+static uint32_t __logGroupKey(const __GroupTask *p_task, uint32_t plant_no, int32_t date) {
+    switch(p_task->key) {
+    case GROUP_KEY_PLANT:
+        return plant_no;
+
+    case GROUP_KEY_FUEL:
+        if(plant_no >= p_task->info_c || !p_task->infos[plant_no].is_valid)
+            return FUEL_TYPE_UNKNOWN;
+        return p_task->infos[plant_no].fuel;
+
+    case GROUP_KEY_MONTH:
+        return monthIndexKey(epochDayToMonth(date));
+
+    case GROUP_KEY_YEAR: {
+        int32_t month = epochDayToMonth(date);
+        return (uint32_t) (1970 + (month >= 0 ? month : month - 11) / 12);
+    }
+
+    // 1970-01-01 was a thursday, weekdays are numbered from monday
+    case GROUP_KEY_WEEKDAY:
+        return (uint32_t) (((date % 7) + 10) % 7);
+
+    default:
+        return 0;
+    }
+}
+
+
+/// Aggregate the value into the group aggregate
+static void __aggregateValue(GroupAggregate *p_agg, float val) {
+    if(!p_agg->n || val < p_agg->min) p_agg->min = val;
+    if(!p_agg->n || val > p_agg->max) p_agg->max = val;
+    kahanAdd(&p_agg->sum, val);
+    p_agg->n++;
+}
+
+
+/// Accumulate the task's log range into its partial hash table
+static void *__reduceGroupTask(void *p_arg) {
+    __GroupTask *p_task = (__GroupTask*) p_arg;
+    const LogColumns *p_cols = p_task->p_logs->cols;
+    const uint64_t *tombs = p_task->p_logs->tombs.n ? p_task->p_logs->tombs.bits : NULL;
+    uint64_t word = 0;
+
+    for(size_t i = p_task->beg; i < p_task->end; i++) {
+        // Read the row bitmap one word at a time, the bitmap has no deleted rows
+        if(p_task->p_rows) {
+            if(!(i & 63) || i == p_task->beg)
+                word = roaringWord(p_task->p_rows, (uint32_t) (i & ~(size_t) 63));
+            if(!(word >> (i & 63) & 1))
+                continue;
+        }
+
+        // Skip deleted rows
+        else if(tombs && (tombs[i >> 6] >> (i & 63) & 1))
+            continue;
+
+        // Read the log values from columns if available, since only three fields are needed
+        uint32_t plant_no;
+        int32_t date;
+        float val;
+        if(p_cols) {
+            plant_no = p_cols->plant_no[i];
+            date = p_cols->date[i];
+            val = p_task->field == QUANTILE_FIELD_PRODUCTION ? p_cols->production[i] :
+                p_cols->avg_sale_price[i];
+        } else {
+            const LogEntry *p_entry = p_task->p_logs->entries + i;
+            plant_no = p_entry->plant_no;
+            date = p_entry->date;
+            val = p_task->field == QUANTILE_FIELD_PRODUCTION ? p_entry->production :
+                p_entry->avg_sale_price;
+        }
+
+        __aggregateValue(__groupTableGet(&p_task->partial, __logGroupKey(p_task, plant_no, date)), val);
+    }
+
+    return NULL;
+}
+
+
+/// Find the amount of threads to use for aggregating n logs
+static size_t __groupThreadCount(size_t n, size_t req_c) {
+    if(!req_c) {
+        long core_c = sysconf(_SC_NPROCESSORS_ONLN);
+        req_c = core_c > 0 ? (size_t) core_c : 1;
+
+        // Small inputs are not worth the thread creation overhead
+        size_t max_c = n / __MIN_GROUP_TASK_SIZE;
+        req_c = req_c > max_c ? max_c : req_c;
+    }
+
+    req_c = req_c > __MAX_GROUP_THREAD_C ? __MAX_GROUP_THREAD_C : req_c;
+    req_c = req_c > n ? n : req_c;
+    return req_c ? req_c : 1;
+}
+
+
+/// Group logs by the grouping key and aggregate the values of the log field in each
+/// group, logs of power plants that no longer exist are grouped under unknown fuel
+/// If the bitmap of rows is given, only logs in those rows are aggregated
+/// Logs are split into contiguous ranges, each aggregated by its own thread into a partial
+/// hash table, which are merged at the end. If thread_c is 0, the amount of threads is
+/// chosen from the available cores and the amount of live logs
+/// Archived logs are aggregated by the calling thread, if they match the predicate
+/// Returns the amount of threads that were used
+size_t groupLogs (
+    PowerPlants *p_plants,
+    PlantLogs *p_logs,
+    GroupKey key,
+    QuantileField field,
+    const RoaringBitmap *p_rows,
+    const PredicateInstr *pred,
+    size_t pred_c,
+    size_t thread_c,
+    GroupTable *p_out
+) {
+    memset(p_out, 0, sizeof(GroupTable));
+
+    // Build a dense plant number lookup table for joining logs with fuel types
+    size_t info_c = 0;
+    for(size_t i = 0; i < p_plants->n; i++) {
+        if(p_plants->plants[i].no >= info_c)
+            info_c = p_plants->plants[i].no + 1;
+    }
+
+    __GroupPlantInfo *infos = (__GroupPlantInfo*) calloc(info_c ? info_c : 1, sizeof(__GroupPlantInfo));
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        infos[p_plant->no].fuel = (uint8_t) (p_plant->fuel < FUEL_TYPE_C ? p_plant->fuel : FUEL_TYPE_UNKNOWN);
+        infos[p_plant->no].is_valid = true;
+    }
+
+    // Split the logs into contiguous ranges of nearly equal size
+    thread_c = __groupThreadCount(p_logs->n, thread_c);
+    __GroupTask *tasks = (__GroupTask*) aligned_alloc(_Alignof(__GroupTask), thread_c * sizeof(__GroupTask));
+    pthread_t *threads = (pthread_t*) malloc(thread_c * sizeof(pthread_t));
+    if(!tasks || !threads) {
+        fprintf(stderr, "Failed to allocate memory for group aggregation tasks\n");
+        exit(EXIT_FAILURE);
+    }
+
+    for(size_t i = 0; i < thread_c; i++) {
+        memset(tasks + i, 0, sizeof(__GroupTask));
+        tasks[i].p_logs = p_logs;
+        tasks[i].p_rows = p_rows;
+        tasks[i].infos = infos;
+        tasks[i].info_c = info_c;
+        tasks[i].key = key;
+        tasks[i].field = field;
+        tasks[i].beg = p_logs->n * i / thread_c;
+        tasks[i].end = p_logs->n * (i + 1) / thread_c;
+    }
+
+    // The calling thread aggregates the first range itself, while the rest are spawned
+    for(size_t i = 1; i < thread_c; i++) {
+        if(pthread_create(threads + i, NULL, __reduceGroupTask, tasks + i)) {
+            fprintf(stderr, "Failed to create group aggregation thread\n");
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    __reduceGroupTask(tasks);
+    for(size_t i = 1; i < thread_c; i++)
+        pthread_join(threads[i], NULL);
+
+    // Merge the partial hash tables of all threads
+    for(size_t i = 0; i < thread_c; i++) {
+        GroupTable *p_part = &tasks[i].partial;
+        for(size_t j = 0; j < p_part->cap; j++) {
+            GroupAggregate *p_src = p_part->slots + j;
+            if(!p_src->n) continue;
+
+            GroupAggregate *p_dst = __groupTableGet(p_out, p_src->key);
+            if(!p_dst->n || p_src->min < p_dst->min) p_dst->min = p_src->min;
+            if(!p_dst->n || p_src->max > p_dst->max) p_dst->max = p_src->max;
+            kahanAdd(&p_dst->sum, kahanValue(&p_src->sum));
+            p_dst->n += p_src->n;
+        }
+
+        destroyGroupTable(p_part);
+    }
+
+    // Archived logs are decoded one block at a time and aggregated by the calling thread,
+    // their power plants always exist, so their fuel type is known
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        for(size_t j = 0; j < p_plant->archive.n; j++) {
+            size_t n = decodeArchiveBlock(p_plant->archive.blocks + j, p_plant->no, block);
+            for(size_t k = 0; k < n; k++) {
+                if(pred_c && !matchArchivedLog(block + k, p_plant->fuel, pred, pred_c))
+                    continue;
+
+                float val = field == QUANTILE_FIELD_PRODUCTION ? block[k].production : block[k].avg_sale_price;
+                __aggregateValue(__groupTableGet(p_out, __logGroupKey(tasks, p_plant->no, block[k].date)), val);
+            }
+        }
+    }
+
+    free(threads);
+    free(tasks);
+    free(infos);
+    return thread_c;
+}
+
+
+/// Find the value of the aggregate function over the group aggregate
+double groupAggregateValue(GroupAggregate *p_agg, GroupAggFunc func) {
+    switch(func) {
+    case GROUP_AGG_FUNC_SUM:    return kahanValue(&p_agg->sum);
+    case GROUP_AGG_FUNC_AVG:    return p_agg->n ? kahanValue(&p_agg->sum) / p_agg->n : 0;
+    case GROUP_AGG_FUNC_MIN:    return p_agg->min;
+    case GROUP_AGG_FUNC_MAX:    return p_agg->max;
+    case GROUP_AGG_FUNC_COUNT:  return (double) p_agg->n;
+    default:                    return 0;
+    }
+}
+
+
+/// Free all memory allocated for the group table
+void destroyGroupTable(GroupTable *p_table) {
+    free(p_table->slots);
+    memset(p_table, 0, sizeof(GroupTable));
+}
@@ -18,12 +18,14 @@ void newHashmap (
 ) {
     p_hashmap->map_cap = elem_c;
     p_hashmap->used_size = 0;
-    p_hashmap->map_data = (__HashData*) calloc (
+    p_hashmap->map_data = (__HashData*) memCalloc (
+        MEM_TAG_MAPS,
         p_hashmap->map_cap,
         sizeof(__HashData)
     );
 
-    p_hashmap->indices = (size_t*) calloc (
+    p_hashmap->indices = (size_t*) memCalloc (
+        MEM_TAG_MAPS,
         p_hashmap->map_cap,
         sizeof(size_t)
     );
@@ -71,7 +73,18 @@ static size_t __hashfunc (
 static void __reallocateHashmap(Hashmap *p_hm) {
     size_t old_size = p_hm->map_cap;
     p_hm->map_cap <<= 2;
-    __HashData *tmp = (__HashData*) calloc(p_hm->map_cap, sizeof(__HashData));
+    __HashData *tmp = (__HashData*) memCalloc(MEM_TAG_MAPS, p_hm->map_cap, sizeof(__HashData));
+
+    // Insertion order indices must have room for every bucket as well
+    size_t *indices = (size_t*) memRealloc(MEM_TAG_MAPS, p_hm->indices, old_size * sizeof(size_t),
+        p_hm->map_cap * sizeof(size_t));
+    if(!tmp || !indices) {
+        fprintf(stderr, "Failed to allocate memory for hashmap\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(indices + old_size, 0, (p_hm->map_cap - old_size) * sizeof(size_t));
+    p_hm->indices = indices;
 
     // Copy data from old map to a new one
     size_t i = 0, j = 0;
@@ -120,7 +133,7 @@ static void __reallocateHashmap(Hashmap *p_hm) {
         }
     }
 
-    free(p_hm->map_data);
+    memFree(MEM_TAG_MAPS, p_hm->map_data, old_size * sizeof(__HashData));
     p_hm->map_data = tmp;
 }
 
@@ -303,6 +316,6 @@ void clearHashmap(Hashmap *p_hm) {
 
 /// Destroy the given hashmap instance
 void destroyHashmap(Hashmap *p_hm) {
-    free(p_hm->map_data);
-    free(p_hm->indices);
+    memFree(MEM_TAG_MAPS, p_hm->map_data, p_hm->map_cap * sizeof(__HashData));
+    memFree(MEM_TAG_MAPS, p_hm->indices, p_hm->map_cap * sizeof(size_t));
 }
@@ -0,0 +1,117 @@
+/*
+ * File:        id_map.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for mapping power plant and log ids to
+ *              their row indices
+ */
+
+
+#define __ID_MAP_C
+#include <id_map.h>
+
+
+/// Find the slot index of the id, which is either the slot with the id or
+/// the first empty slot in its probe sequence
+static size_t __idMapProbe(const IdMap *p_map, uint32_t id) {
+    // Ids are mostly consecutive, so they are spread over the map with Fibonacci hashing
+    size_t mask = p_map->cap - 1;
+    size_t i = (size_t) (((uint64_t) id * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    while(p_map->slots[i].row != ID_MAP_NONE && p_map->slots[i].id != id)
+        i = (i + 1) & mask;
+
+    return i;
+}
+
+
+/// Resize the map to the given capacity and reinsert all ids
+static void __idMapResize(IdMap *p_map, size_t cap) {
+    IdMap old = *p_map;
+    p_map->cap = cap;
+    p_map->slots = (IdMapSlot*) memAlloc(MEM_TAG_MAPS, cap * sizeof(IdMapSlot));
+    if(!p_map->slots) {
+        fprintf(stderr, "Failed to allocate memory for id map\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // Setting all bytes to 0xff marks every slot empty
+    memset(p_map->slots, 0xff, cap * sizeof(IdMapSlot));
+    for(size_t i = 0; i < old.cap; i++) {
+        if(old.slots[i].row != ID_MAP_NONE)
+            p_map->slots[__idMapProbe(p_map, old.slots[i].id)] = old.slots[i];
+    }
+
+    memFree(MEM_TAG_MAPS, old.slots, old.cap * sizeof(IdMapSlot));
+}
+
+
+/// Create a new id map with capacity for at least the given amount of ids
+void newIdMap(IdMap *p_map, size_t id_c) {
+    memset(p_map, 0, sizeof(IdMap));
+
+    // Keep the load factor at most one half
+    size_t cap = __ID_MAP_MIN_CAP;
+    while(cap < 2 * id_c)
+        cap <<= 1;
+    __idMapResize(p_map, cap);
+}
+
+
+/// Map the id to the row, previous row of the id is replaced
+void idMapPut(IdMap *p_map, uint32_t id, uint32_t row) {
+    if(2 * (p_map->n + 1) > p_map->cap)
+        __idMapResize(p_map, p_map->cap ? p_map->cap << 1 : __ID_MAP_MIN_CAP);
+
+    IdMapSlot *p_slot = p_map->slots + __idMapProbe(p_map, id);
+    if(p_slot->row == ID_MAP_NONE)
+        p_map->n++;
+
+    p_slot->id = id;
+    p_slot->row = row;
+}
+
+
+/// Find the row of the id, ID_MAP_NONE is returned if the id is not in the map
+uint32_t idMapFind(const IdMap *p_map, uint32_t id) {
+    if(!p_map->cap) return ID_MAP_NONE;
+    return p_map->slots[__idMapProbe(p_map, id)].row;
+}
+
+
+/// Remove the id from the map
+/// Returns the row of the removed id or ID_MAP_NONE if the id was not in the map
+uint32_t idMapRemove(IdMap *p_map, uint32_t id) {
+    if(!p_map->cap) return ID_MAP_NONE;
+
+    size_t mask = p_map->cap - 1;
+    size_t i = __idMapProbe(p_map, id);
+    uint32_t row = p_map->slots[i].row;
+    if(row == ID_MAP_NONE) return ID_MAP_NONE;
+
+    // Shift the following slots of the probe sequence back into the hole, unless
+    // their home slot is cyclically after the hole
+    size_t j = i;
+    while(true) {
+        j = (j + 1) & mask;
+        if(p_map->slots[j].row == ID_MAP_NONE)
+            break;
+
+        size_t home = (size_t) (((uint64_t) p_map->slots[j].id * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+        if(((j - home) & mask) >= ((j - i) & mask)) {
+            p_map->slots[i] = p_map->slots[j];
+            i = j;
+        }
+    }
+
+    p_map->slots[i].row = ID_MAP_NONE;
+    p_map->n--;
+    return row;
+}
+
+
+/// Free all memory allocated for the id map
+void destroyIdMap(IdMap *p_map) {
+    memFree(MEM_TAG_MAPS, p_map->slots, p_map->cap * sizeof(IdMapSlot));
+    memset(p_map, 0, sizeof(IdMap));
+}
@@ -0,0 +1,86 @@
+/*
+ * File:        indexes.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-11
+ * Last edit:   2021-06-11
+ * Description: Function definitions for maintaining bitmap indexes over power
+ *              plants and logs
+ */
+
+
+#define __INDEXES_C
+#include <indexes.h>
+
+
+/// Convert months since 1970-01 into month index key, keys have the same order as months
+uint32_t monthIndexKey(int32_t month) {
+    // Flip the sign bit, so that months before 1970 are ordered correctly
+    return (uint32_t) month ^ 0x80000000;
+}
+
+
+/// Convert month index key back into months since 1970-01
+int32_t monthIndexKeyToMonth(uint32_t key) {
+    return (int32_t) (key ^ 0x80000000);
+}
+
+
+/// Add the log row into the plant and month indexes
+void addLogIndexes(PlantLogs *p_logs, size_t row) {
+    LogEntry *p_entry = p_logs->entries + row;
+    bitmapIndexAdd(&p_logs->plant_idx, p_entry->plant_no, (uint32_t) row);
+    bitmapIndexAdd(&p_logs->month_idx, monthIndexKey(epochDayToMonth(p_entry->date)), (uint32_t) row);
+}
+
+
+/// Remove the log row from the plant and month indexes, the entry must have
+/// the values the row was indexed with
+void removeLogIndexes(PlantLogs *p_logs, size_t row, LogEntry *p_entry) {
+    bitmapIndexRemove(&p_logs->plant_idx, p_entry->plant_no, (uint32_t) row);
+    bitmapIndexRemove(&p_logs->month_idx, monthIndexKey(epochDayToMonth(p_entry->date)), (uint32_t) row);
+}
+
+
+/// Rebuild the plant and month indexes from all live log rows
+void rebuildLogIndexes(PlantLogs *p_logs) {
+    destroyLogIndexes(p_logs);
+
+    // Rows are added in increasing order, so each row is appended to its bitmaps
+    for(size_t i = 0; i < p_logs->n; i++) {
+        if(!isLogRowDead(p_logs, i))
+            addLogIndexes(p_logs, i);
+    }
+}
+
+
+/// Free all memory allocated for the log indexes
+void destroyLogIndexes(PlantLogs *p_logs) {
+    destroyBitmapIndex(&p_logs->plant_idx);
+    destroyBitmapIndex(&p_logs->month_idx);
+}
+
+
+/// Add the power plant row into the fuel index
+void addPlantIndexes(PowerPlants *p_plants, size_t row) {
+    bitmapIndexAdd(&p_plants->fuel_idx, p_plants->plants[row].fuel, (uint32_t) row);
+}
+
+
+/// Remove the power plant row with the given fuel type from the fuel index
+void removePlantIndexes(PowerPlants *p_plants, size_t row, FuelType fuel) {
+    bitmapIndexRemove(&p_plants->fuel_idx, fuel, (uint32_t) row);
+}
+
+
+/// Rebuild the fuel index from all power plant rows
+void rebuildPlantIndexes(PowerPlants *p_plants) {
+    destroyPlantIndexes(p_plants);
+    for(size_t i = 0; i < p_plants->n; i++)
+        addPlantIndexes(p_plants, i);
+}
+
+
+/// Free all memory allocated for the power plant indexes
+void destroyPlantIndexes(PowerPlants *p_plants) {
+    destroyBitmapIndex(&p_plants->fuel_idx);
+}
@@ -94,6 +94,58 @@ void logCommandAction (
         req_clean = true;
         break;
 
+    case USER_INPUT_ACTION_U_SHOW_STATS:
+        msg = "Showing fleet-wide log statistics\n";
+        break;
+
+    case USER_INPUT_ACTION_U_SHOW_FUEL_STATS:
+        msg = "Showing log statistics per fuel type\n";
+        break;
+
+    case USER_INPUT_ACTION_U_SHOW_QUANTILES:
+        msg = "Showing log value quantiles for the fleet\n";
+        break;
+
+    case USER_INPUT_ACTION_S_SHOW_QUANTILES:
+        msg = (char*) calloc(__MAX_BUF_SIZE, sizeof(char));
+        sprintf(msg, "Showing log value quantiles for power plant nr %lu\n", id_arg);
+        req_clean = true;
+        break;
+
+    case USER_INPUT_ACTION_U_SHOW_ROLLING:
+        msg = "Showing power plants ranked by rolling utilisation\n";
+        break;
+
+    case USER_INPUT_ACTION_S_SHOW_ROLLING:
+        msg = (char*) calloc(__MAX_BUF_SIZE, sizeof(char));
+        sprintf(msg, "Showing rolling utilisation for power plant nr %lu\n", id_arg);
+        req_clean = true;
+        break;
+
+    case USER_INPUT_ACTION_U_SHOW_ROLLUP:
+        msg = "Showing rollups for all power plants\n";
+        break;
+
+    case USER_INPUT_ACTION_S_SHOW_ROLLUP:
+        msg = (char*) calloc(__MAX_BUF_SIZE, sizeof(char));
+        sprintf(msg, "Showing rollup for power plant nr %lu\n", id_arg);
+        req_clean = true;
+        break;
+
+    case USER_INPUT_ACTION_U_COUNT_LOGS:
+        msg = "Counting matching logs of the fleet\n";
+        break;
+
+    case USER_INPUT_ACTION_U_GROUP_LOGS:
+        msg = "Showing grouped log aggregates\n";
+        break;
+
+    case USER_INPUT_ACTION_S_COUNT_LOGS:
+        msg = (char*) calloc(__MAX_BUF_SIZE, sizeof(char));
+        sprintf(msg, "Counting matching logs for power plant nr %lu\n", id_arg);
+        req_clean = true;
+        break;
+
     case USER_INPUT_ACTION_S_SHOW_HELP:
         msg = "Showing help for selected mode";
         break;
@@ -128,6 +180,18 @@ void logCommandAction (
         req_clean = true;
         break;
 
+    case USER_INPUT_ACTION_COMPACT:
+        msg = "Compacted log storage\n";
+        break;
+
+    case USER_INPUT_ACTION_MEM:
+        msg = "Showing memory usage per subsystem\n";
+        break;
+
+    case USER_INPUT_ACTION_U_ARCHIVE_LOGS:
+        msg = "Archived old logs\n";
+        break;
+
     case USER_INPUT_ACTION_SAVE:
         msg = "Saved data to files\n";
         break;
@@ -0,0 +1,386 @@
+/*
+ * File:        log_archive.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for moving old logs into compressed
+ *              per power plant archive blocks and decoding them
+ */
+
+
+#define __LOG_ARCHIVE_C
+#include <log_archive.h>
+
+
+/// Append the n low bits of the value to the bit stream, n must be at most 32
+static void __writeBits(__BitWriter *p_bw, uint64_t val, uint32_t n) {
+    p_bw->acc = (p_bw->acc << n) | (val & ((1ull << n) - 1));
+    p_bw->acc_n += n;
+
+    // Whole bytes are written out, the capacity is reserved once per log
+    while(p_bw->acc_n >= 8) {
+        p_bw->acc_n -= 8;
+        p_bw->data[p_bw->size++] = (uint8_t) (p_bw->acc >> p_bw->acc_n);
+    }
+}
+
+
+/// Read the next n bits from the bit stream, n must be at most 32
+static uint64_t __readBits(__BitReader *p_br, uint32_t n) {
+    if(!n) return 0;
+
+    // Load 8 bytes in big endian order, which always contain the n bits after the bit offset
+    const uint8_t *p = p_br->data + (p_br->pos >> 3);
+    uint64_t word = 0;
+    for(size_t i = 0; i < 8; i++)
+        word = (word << 8) | p[i];
+
+    uint64_t val = (word << (p_br->pos & 7)) >> (64 - n);
+    p_br->pos += n;
+    return val;
+}
+
+
+/// Write the value as the difference between its delta and the previous delta
+/// Zigzag encoded differences are prefixed with their bit width class, so that
+/// evenly spaced values take a single bit
+static void __writeDelta(__BitWriter *p_bw, __DeltaState *p_st, int64_t val) {
+    int64_t delta = val - p_st->prev;
+    int64_t dod = delta - p_st->delta;
+    uint64_t zz = ((uint64_t) dod << 1) ^ (uint64_t) (dod >> 63);
+
+    if(!zz) __writeBits(p_bw, 0x0, 1);
+    else if(zz < 1ull << 7) {
+        __writeBits(p_bw, 0x2, 2);
+        __writeBits(p_bw, zz, 7);
+    }
+    else if(zz < 1ull << 12) {
+        __writeBits(p_bw, 0x6, 3);
+        __writeBits(p_bw, zz, 12);
+    }
+    else if(zz < 1ull << 20) {
+        __writeBits(p_bw, 0xe, 4);
+        __writeBits(p_bw, zz, 20);
+    }
+    else {
+        __writeBits(p_bw, 0xf, 4);
+        __writeBits(p_bw, zz >> 32, 32);
+        __writeBits(p_bw, zz, 32);
+    }
+
+    // The first value is encoded against zero, so its delta is not carried over
+    p_st->prev = val;
+    p_st->delta = p_st->has_prev ? delta : 0;
+    p_st->has_prev = true;
+}
+
+
+/// Read the next delta-of-delta encoded value
+static int64_t __readDelta(__BitReader *p_br, __DeltaState *p_st) {
+    uint64_t zz;
+    if(!__readBits(p_br, 1)) zz = 0;
+    else if(!__readBits(p_br, 1)) zz = __readBits(p_br, 7);
+    else if(!__readBits(p_br, 1)) zz = __readBits(p_br, 12);
+    else if(!__readBits(p_br, 1)) zz = __readBits(p_br, 20);
+    else {
+        zz = __readBits(p_br, 32) << 32;
+        zz |= __readBits(p_br, 32);
+    }
+
+    int64_t dod = (int64_t) (zz >> 1) ^ -(int64_t) (zz & 1);
+    int64_t delta = p_st->delta + dod;
+    int64_t val = p_st->prev + delta;
+
+    p_st->prev = val;
+    p_st->delta = p_st->has_prev ? delta : 0;
+    p_st->has_prev = true;
+    return val;
+}
+
+
+/// Write the value as XOR with the previous value, where only the meaningful bits
+/// are stored and the bit window of the previous value is reused if it fits
+static void __writeXor(__BitWriter *p_bw, __XorState *p_st, float val) {
+    uint32_t bits;
+    memcpy(&bits, &val, sizeof(uint32_t));
+    uint32_t x = bits ^ p_st->prev;
+    p_st->prev = bits;
+
+    if(!x) {
+        __writeBits(p_bw, 0x0, 1);
+        return;
+    }
+
+    uint32_t lead = (uint32_t) __builtin_clz(x);
+    uint32_t trail = (uint32_t) __builtin_ctz(x);
+    if(p_st->len && lead >= p_st->lead && trail >= 32 - p_st->lead - p_st->len) {
+        __writeBits(p_bw, 0x2, 2);
+        __writeBits(p_bw, x >> (32 - p_st->lead - p_st->len), p_st->len);
+        return;
+    }
+
+    // The window is stored as leading zero count and length, both fit into 5 bits
+    p_st->lead = lead;
+    p_st->len = 32 - lead - trail;
+    __writeBits(p_bw, 0x3, 2);
+    __writeBits(p_bw, lead, 5);
+    __writeBits(p_bw, p_st->len - 1, 5);
+    __writeBits(p_bw, x >> trail, p_st->len);
+}
+
+
+/// Read the next XOR encoded value
+static float __readXor(__BitReader *p_br, __XorState *p_st) {
+    if(__readBits(p_br, 1)) {
+        if(__readBits(p_br, 1)) {
+            p_st->lead = (uint32_t) __readBits(p_br, 5);
+            p_st->len = (uint32_t) __readBits(p_br, 5) + 1;
+        }
+
+        uint32_t x = (uint32_t) __readBits(p_br, p_st->len) << (32 - p_st->lead - p_st->len);
+        p_st->prev ^= x;
+    }
+
+    float val;
+    memcpy(&val, &p_st->prev, sizeof(float));
+    return val;
+}
+
+
+/// Compress the date ordered logs into a new archive block
+static void __encodeArchiveBlock(const LogEntry *entries, size_t n, ArchiveBlock *p_block) {
+    __BitWriter bw = { 0 };
+    __DeltaState ids = { 0 }, dates = { 0 };
+    __XorState prods = { 0 }, prices = { 0 };
+
+    // Fields of each log are interleaved, so that a block is decoded in a single pass
+    for(size_t i = 0; i < n; i++) {
+        memReallocCheck(MEM_TAG_ARCHIVE, (void**) &bw.data, sizeof(uint8_t),
+            bw.size + __ARCHIVE_MAX_LOG_SIZE + __ARCHIVE_PAD_SIZE, &bw.cap);
+        __writeDelta(&bw, &ids, entries[i].log_id);
+        __writeDelta(&bw, &dates, entries[i].date);
+        __writeXor(&bw, &prods, entries[i].production);
+        __writeXor(&bw, &prices, entries[i].avg_sale_price);
+    }
+
+    // Flush the last partial byte and pad the stream with zeros
+    if(bw.acc_n)
+        bw.data[bw.size++] = (uint8_t) (bw.acc << (8 - bw.acc_n));
+    memset(bw.data + bw.size, 0, __ARCHIVE_PAD_SIZE);
+    memShrinkToFit(MEM_TAG_ARCHIVE, (void**) &bw.data, sizeof(uint8_t), bw.size + __ARCHIVE_PAD_SIZE,
+        &bw.cap);
+
+    p_block->data = bw.data;
+    p_block->size = bw.cap;
+    p_block->n = (uint32_t) n;
+    p_block->first_date = entries[0].date;
+    p_block->last_date = entries[n - 1].date;
+}
+
+
+/// Add the date ordered logs into the archive, blocks after the first log date are
+/// decoded, merged with the logs and compressed again
+static void __appendPlantArchive (
+    PlantArchive *p_arch,
+    uint32_t plant_no,
+    const LogEntry *entries,
+    size_t n
+) {
+    // Blocks ending before the first new log stay as they are, while a partially
+    // filled last block is refilled
+    size_t beg = p_arch->n;
+    while(beg && p_arch->blocks[beg - 1].last_date > entries[0].date)
+        beg--;
+    if(beg && beg == p_arch->n && p_arch->blocks[beg - 1].n < ARCHIVE_BLOCK_LOG_C)
+        beg--;
+
+    size_t old_c = 0;
+    for(size_t i = beg; i < p_arch->n; i++)
+        old_c += p_arch->blocks[i].n;
+
+    // Decode the blocks that are encoded again into the end of the merge buffer
+    size_t merged_c = old_c + n;
+    LogEntry *merged = (LogEntry*) memAlloc(MEM_TAG_SORT, merged_c * sizeof(LogEntry));
+    if(!merged) {
+        fprintf(stderr, "Failed to allocate memory for log archiving\n");
+        exit(EXIT_FAILURE);
+    }
+
+    LogEntry *old = merged + n;
+    for(size_t i = beg, j = 0; i < p_arch->n; i++) {
+        j += decodeArchiveBlock(p_arch->blocks + i, plant_no, old + j);
+        memFree(MEM_TAG_ARCHIVE, p_arch->blocks[i].data, p_arch->blocks[i].size);
+    }
+    p_arch->n = beg;
+
+    // Merge forward, which never overwrites an old log that is not merged yet
+    // Archived logs come before new logs with the same date
+    size_t i = 0, j = 0, k = 0;
+    while(i < old_c || j < n) {
+        if(j == n || (i < old_c && old[i].date <= entries[j].date))
+            merged[k++] = old[i++];
+        else merged[k++] = entries[j++];
+    }
+
+    for(size_t off = 0; off < merged_c; off += ARCHIVE_BLOCK_LOG_C) {
+        size_t block_n = merged_c - off < ARCHIVE_BLOCK_LOG_C ? merged_c - off : ARCHIVE_BLOCK_LOG_C;
+        memReallocCheck(MEM_TAG_ARCHIVE, (void**) &p_arch->blocks, sizeof(ArchiveBlock), p_arch->n + 1,
+            &p_arch->cap);
+        __encodeArchiveBlock(merged + off, block_n, p_arch->blocks + p_arch->n++);
+    }
+
+    p_arch->log_c += n;
+    memFree(MEM_TAG_SORT, merged, merged_c * sizeof(LogEntry));
+}
+
+
+/// Move the logs of each power plant dated before the cutoff day into its archive
+/// Archived logs are removed from log storage, indexes and the id map, but they stay
+/// in the aggregates, rollups and sketches of their power plant
+/// Logs of deleted power plants are not archived
+/// Returns the amount of archived logs
+size_t archiveLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *p_map, int32_t cutoff) {
+    size_t arch_c = 0;
+
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantData *p_plant = p_plants->plants + i;
+        PlantLogRows *p_rows = &p_plant->logs;
+
+        // Log rows are in date order, so the archived logs are a prefix of them
+        size_t k = 0;
+        while(k < p_rows->n && p_logs->entries[p_rows->rows[k]].date < cutoff)
+            k++;
+        if(!k) continue;
+
+        LogEntry *moved = (LogEntry*) memAlloc(MEM_TAG_SORT, k * sizeof(LogEntry));
+        if(!moved) {
+            fprintf(stderr, "Failed to allocate memory for log archiving\n");
+            exit(EXIT_FAILURE);
+        }
+
+        for(size_t j = 0; j < k; j++)
+            moved[j] = p_logs->entries[p_rows->rows[j]];
+        __appendPlantArchive(&p_plant->archive, p_plant->no, moved, k);
+
+        // Indexes are rebuilt once all rows are compacted away
+        for(size_t j = 0; j < k; j++) {
+            idMapRemove(p_map, moved[j].log_id);
+            roaringAdd(&p_logs->archived_ids, moved[j].log_id);
+            freeLogRow(p_logs, p_rows->rows[j]);
+        }
+
+        memmove(p_rows->rows, p_rows->rows + k, (p_rows->n - k) * sizeof(uint32_t));
+        p_rows->n -= k;
+        arch_c += k;
+        memFree(MEM_TAG_SORT, moved, k * sizeof(LogEntry));
+    }
+
+    if(!arch_c) return 0;
+    compactLogs(p_plants, p_logs, p_map);
+
+    // Archiving leaves most of the column and id map capacity unused, so both are
+    // built again at the size of the remaining live logs
+    if(p_logs->cols) {
+        LogColumns *p_cols = p_logs->cols;
+        destroyLogColumns(p_cols);
+        newLogColumns(p_cols, p_logs);
+    }
+
+    destroyIdMap(p_map);
+    newIdMap(p_map, p_logs->n);
+    for(size_t i = 0; i < p_logs->n; i++)
+        idMapPut(p_map, p_logs->entries[i].log_id, (uint32_t) i);
+
+    return arch_c;
+}
+
+
+/// Decode all logs of the archive block into the output array
+/// Returns the amount of decoded logs
+size_t decodeArchiveBlock(const ArchiveBlock *p_block, uint32_t plant_no, LogEntry *out) {
+    __BitReader br = { .data = p_block->data, .pos = 0 };
+    __DeltaState ids = { 0 }, dates = { 0 };
+    __XorState prods = { 0 }, prices = { 0 };
+
+    for(size_t i = 0; i < p_block->n; i++) {
+        out[i].log_id = (uint32_t) __readDelta(&br, &ids);
+        out[i].plant_no = plant_no;
+        out[i].date = (int32_t) __readDelta(&br, &dates);
+        out[i].production = __readXor(&br, &prods);
+        out[i].avg_sale_price = __readXor(&br, &prices);
+    }
+
+    return p_block->n;
+}
+
+
+/// Decode the archived logs dated from day from to day to into the output array in date order
+/// Only the blocks overlapping the date range are decoded
+/// Returns the amount of logs written into out, which must fit plantArchiveRangeBound() logs
+size_t scanPlantArchive (
+    const PlantArchive *p_arch,
+    uint32_t plant_no,
+    int32_t from,
+    int32_t to,
+    LogEntry *out
+) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_arch->n; i++) {
+        const ArchiveBlock *p_block = p_arch->blocks + i;
+        if(p_block->last_date < from) continue;
+        if(p_block->first_date > to) break;
+
+        // Blocks on the range boundaries are decoded whole and filtered in place
+        size_t base = n;
+        size_t block_n = decodeArchiveBlock(p_block, plant_no, out + base);
+        if(p_block->first_date >= from && p_block->last_date <= to) {
+            n += block_n;
+            continue;
+        }
+
+        for(size_t j = 0; j < block_n; j++) {
+            if(out[base + j].date >= from && out[base + j].date <= to)
+                out[n++] = out[base + j];
+        }
+    }
+
+    return n;
+}
+
+
+/// Find the upper bound of the amount of archived logs dated from day from to day to
+size_t plantArchiveRangeBound(const PlantArchive *p_arch, int32_t from, int32_t to) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_arch->n; i++) {
+        if(p_arch->blocks[i].last_date >= from && p_arch->blocks[i].first_date <= to)
+            n += p_arch->blocks[i].n;
+    }
+
+    return n;
+}
+
+
+/// Find the amount of archived logs of all power plants
+size_t archivedLogCount(const PowerPlants *p_plants) {
+    size_t n = 0;
+    for(size_t i = 0; i < p_plants->n; i++)
+        n += p_plants->plants[i].archive.log_c;
+
+    return n;
+}
+
+
+/// Find the amount of unused bytes in the archive block array
+size_t plantArchiveSlack(const PlantArchive *p_arch) {
+    return (p_arch->cap - p_arch->n) * sizeof(ArchiveBlock);
+}
+
+
+/// Free all memory allocated for the archive
+void destroyPlantArchive(PlantArchive *p_arch) {
+    for(size_t i = 0; i < p_arch->n; i++)
+        memFree(MEM_TAG_ARCHIVE, p_arch->blocks[i].data, p_arch->blocks[i].size);
+
+    memFree(MEM_TAG_ARCHIVE, p_arch->blocks, p_arch->cap * sizeof(ArchiveBlock));
+    memset(p_arch, 0, sizeof(PlantArchive));
+}
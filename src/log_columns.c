@@ -0,0 +1,385 @@
+/*
+ * File:        log_columns.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-05
+ * Last edit:   2021-06-05
+ * Description: Function definitions for columnar log storage and vectorised 
+ *              column scanning kernels
+ */
+
+
+#define __LOG_COLUMNS_C
+#include <log_columns.h>
+
+
+/// Check if the CPU supports AVX2 instructions
+static bool __hasAvx2() {
+    static int has_avx2 = -1;
+    if(has_avx2 < 0) {
+        __builtin_cpu_init();
+        has_avx2 = __builtin_cpu_supports("avx2") ? 1 : 0;
+    }
+
+    return has_avx2;
+}
+
+
+/// Allocate 32 byte aligned column memory for cap elements of given size and copy 
+/// n elements from the old column over to it
+static void *__reallocColumn(void *col, size_t size, size_t n, size_t cap) {
+    void *new_col = aligned_alloc(__COLUMN_ALIGNMENT, cap * size);
+    if(!new_col) {
+        fprintf(stderr, "Failed to allocate memory for log columns\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if(n) memcpy(new_col, col, n * size);
+    free(col);
+    return new_col;
+}
+
+
+/// Make sure that the columns can hold at least req_n rows
+static void __reserveLogColumns(LogColumns *p_cols, size_t req_n) {
+    if(req_n <= p_cols->cap) return;
+
+    // Keep the capacity a multiple of 8 rows, so that each column size is a
+    // multiple of the alignment
+    size_t cap = p_cols->cap ? p_cols->cap : __COLUMN_MIN_CAP;
+    while(cap < req_n) cap <<= 1;
+
+    p_cols->log_id = __reallocColumn(p_cols->log_id, sizeof(uint32_t), p_cols->n, cap);
+    p_cols->plant_no = __reallocColumn(p_cols->plant_no, sizeof(uint32_t), p_cols->n, cap);
+    p_cols->production = __reallocColumn(p_cols->production, sizeof(float), p_cols->n, cap);
+    p_cols->avg_sale_price = __reallocColumn(p_cols->avg_sale_price, sizeof(float), p_cols->n, cap);
+    p_cols->date = __reallocColumn(p_cols->date, sizeof(int32_t), p_cols->n, cap);
+
+    // Aligned columns are not allocated through the tagged wrappers, so they are accounted here
+    memTrackFree(MEM_TAG_LOGS, p_cols->cap * LOG_COLUMNS_ROW_SIZE);
+    memTrackAlloc(MEM_TAG_LOGS, cap * LOG_COLUMNS_ROW_SIZE);
+    p_cols->cap = cap;
+}
+
+
+/// Create columnar copy of all live log entries
+/// NOTE: Deleted rows are left out, so column rows match entry rows only if there
+/// are no deleted rows
+void newLogColumns(LogColumns *p_cols, PlantLogs *p_logs) {
+    memset(p_cols, 0, sizeof(LogColumns));
+    __reserveLogColumns(p_cols, liveLogCount(p_logs));
+
+    for(size_t i = 0; i < p_logs->n; i++) {
+        if(!isLogRowDead(p_logs, i))
+            setLogColumnsRow(p_cols, p_cols->n++, p_logs->entries + i);
+    }
+}
+
+
+/// Free all memory allocated for log columns
+void destroyLogColumns(LogColumns *p_cols) {
+    free(p_cols->log_id);
+    free(p_cols->plant_no);
+    free(p_cols->production);
+    free(p_cols->avg_sale_price);
+    free(p_cols->date);
+    memTrackFree(MEM_TAG_LOGS, p_cols->cap * LOG_COLUMNS_ROW_SIZE);
+    memset(p_cols, 0, sizeof(LogColumns));
+}
+
+
+/// Append log entry as a new row to the end of columns
+void pushLogColumnsRow(LogColumns *p_cols, LogEntry *p_entry) {
+    __reserveLogColumns(p_cols, p_cols->n + 1);
+    setLogColumnsRow(p_cols, p_cols->n, p_entry);
+    p_cols->n++;
+}
+
+
+/// Overwrite the row at given index with log entry values
+void setLogColumnsRow(LogColumns *p_cols, size_t i, LogEntry *p_entry) {
+    p_cols->log_id[i] = p_entry->log_id;
+    p_cols->plant_no[i] = p_entry->plant_no;
+    p_cols->production[i] = p_entry->production;
+    p_cols->avg_sale_price[i] = p_entry->avg_sale_price;
+    p_cols->date[i] = p_entry->date;
+}
+
+
+/// Remove the row at given index and shift all following rows to the left
+void removeLogColumnsRow(LogColumns *p_cols, size_t i) {
+    size_t n = p_cols->n - i - 1;
+    memmove(p_cols->log_id + i, p_cols->log_id + i + 1, n * sizeof(uint32_t));
+    memmove(p_cols->plant_no + i, p_cols->plant_no + i + 1, n * sizeof(uint32_t));
+    memmove(p_cols->production + i, p_cols->production + i + 1, n * sizeof(float));
+    memmove(p_cols->avg_sale_price + i, p_cols->avg_sale_price + i + 1, n * sizeof(float));
+    memmove(p_cols->date + i, p_cols->date + i + 1, n * sizeof(int32_t));
+    p_cols->n--;
+}
+
+
+/// Create a row view of the log columns at given index
+LogEntry getLogColumnsRow(LogColumns *p_cols, size_t i) {
+    LogEntry entry = { 0 };
+    entry.log_id = p_cols->log_id[i];
+    entry.plant_no = p_cols->plant_no[i];
+    entry.production = p_cols->production[i];
+    entry.avg_sale_price = p_cols->avg_sale_price[i];
+    entry.date = p_cols->date[i];
+    return entry;
+}
+
+
+/********** AVX2 column kernels **********/
+
+__attribute__((target("avx2")))
+static double __columnSumfAvx2(const float *col, size_t n) {
+    // Floats are widened into doubles before adding, two accumulators hide the
+    // addition latency
+    __m256d acc0 = _mm256_setzero_pd();
+    __m256d acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(col + i);
+        acc0 = _mm256_add_pd(acc0, _mm256_cvtps_pd(_mm256_castps256_ps128(v)));
+        acc1 = _mm256_add_pd(acc1, _mm256_cvtps_pd(_mm256_extractf128_ps(v, 1)));
+    }
+
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+
+    for(; i < n; i++)
+        sum += col[i];
+    return sum;
+}
+
+
+__attribute__((target("avx2")))
+static float __columnMinfAvx2(const float *col, size_t n) {
+    float res = col[0];
+    size_t i = 0;
+    if(n >= 8) {
+        __m256 acc = _mm256_loadu_ps(col);
+        for(i = 8; i + 8 <= n; i += 8)
+            acc = _mm256_min_ps(acc, _mm256_loadu_ps(col + i));
+
+        float lanes[8];
+        _mm256_storeu_ps(lanes, acc);
+        for(size_t j = 0; j < 8; j++)
+            res = lanes[j] < res ? lanes[j] : res;
+    }
+
+    for(; i < n; i++)
+        res = col[i] < res ? col[i] : res;
+    return res;
+}
+
+
+__attribute__((target("avx2")))
+static float __columnMaxfAvx2(const float *col, size_t n) {
+    float res = col[0];
+    size_t i = 0;
+    if(n >= 8) {
+        __m256 acc = _mm256_loadu_ps(col);
+        for(i = 8; i + 8 <= n; i += 8)
+            acc = _mm256_max_ps(acc, _mm256_loadu_ps(col + i));
+
+        float lanes[8];
+        _mm256_storeu_ps(lanes, acc);
+        for(size_t j = 0; j < 8; j++)
+            res = lanes[j] > res ? lanes[j] : res;
+    }
+
+    for(; i < n; i++)
+        res = col[i] > res ? col[i] : res;
+    return res;
+}
+
+
+__attribute__((target("avx2")))
+static int32_t __columnMini32Avx2(const int32_t *col, size_t n) {
+    int32_t res = col[0];
+    size_t i = 0;
+    if(n >= 8) {
+        __m256i acc = _mm256_loadu_si256((const __m256i*) col);
+        for(i = 8; i + 8 <= n; i += 8)
+            acc = _mm256_min_epi32(acc, _mm256_loadu_si256((const __m256i*) (col + i)));
+
+        int32_t lanes[8];
+        _mm256_storeu_si256((__m256i*) lanes, acc);
+        for(size_t j = 0; j < 8; j++)
+            res = lanes[j] < res ? lanes[j] : res;
+    }
+
+    for(; i < n; i++)
+        res = col[i] < res ? col[i] : res;
+    return res;
+}
+
+
+__attribute__((target("avx2")))
+static int32_t __columnMaxi32Avx2(const int32_t *col, size_t n) {
+    int32_t res = col[0];
+    size_t i = 0;
+    if(n >= 8) {
+        __m256i acc = _mm256_loadu_si256((const __m256i*) col);
+        for(i = 8; i + 8 <= n; i += 8)
+            acc = _mm256_max_epi32(acc, _mm256_loadu_si256((const __m256i*) (col + i)));
+
+        int32_t lanes[8];
+        _mm256_storeu_si256((__m256i*) lanes, acc);
+        for(size_t j = 0; j < 8; j++)
+            res = lanes[j] > res ? lanes[j] : res;
+    }
+
+    for(; i < n; i++)
+        res = col[i] > res ? col[i] : res;
+    return res;
+}
+
+
+__attribute__((target("avx2")))
+static size_t __columnFilterRangefAvx2(const float *col, size_t n, float lo, float hi, uint32_t *out) {
+    const __m256 vlo = _mm256_set1_ps(lo);
+    const __m256 vhi = _mm256_set1_ps(hi);
+    size_t c = 0, i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(col + i);
+        __m256 in = _mm256_and_ps(_mm256_cmp_ps(v, vlo, _CMP_GE_OQ), _mm256_cmp_ps(v, vhi, _CMP_LE_OQ));
+
+        // Write out the index of each set lane
+        uint32_t mask = (uint32_t) _mm256_movemask_ps(in);
+        while(mask) {
+            out[c++] = (uint32_t) (i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    for(; i < n; i++) {
+        if(col[i] >= lo && col[i] <= hi)
+            out[c++] = (uint32_t) i;
+    }
+
+    return c;
+}
+
+
+__attribute__((target("avx2")))
+static size_t __columnFilterRangei32Avx2 (
+    const int32_t *col, 
+    size_t n, 
+    int32_t lo, 
+    int32_t hi, 
+    uint32_t *out
+) {
+    const __m256i vlo = _mm256_set1_epi32(lo);
+    const __m256i vhi = _mm256_set1_epi32(hi);
+    size_t c = 0, i = 0;
+
+    for(; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i*) (col + i));
+
+        // Lanes outside of the range are either smaller than lo or greater than hi
+        __m256i out_range = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, v), _mm256_cmpgt_epi32(v, vhi));
+        uint32_t mask = ~(uint32_t) _mm256_movemask_ps(_mm256_castsi256_ps(out_range)) & 0xff;
+        while(mask) {
+            out[c++] = (uint32_t) (i + __builtin_ctz(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    for(; i < n; i++) {
+        if(col[i] >= lo && col[i] <= hi)
+            out[c++] = (uint32_t) i;
+    }
+
+    return c;
+}
+
+
+/********** Column kernels **********/
+
+/// Find the sum of floating point column values in double precision
+double columnSumf(const float *col, size_t n) {
+    if(__hasAvx2()) return __columnSumfAvx2(col, n);
+
+    double sum = 0;
+    for(size_t i = 0; i < n; i++)
+        sum += col[i];
+    return sum;
+}
+
+
+/// Find the minimum floating point column value
+float columnMinf(const float *col, size_t n) {
+    if(__hasAvx2()) return __columnMinfAvx2(col, n);
+
+    float res = col[0];
+    for(size_t i = 1; i < n; i++)
+        res = col[i] < res ? col[i] : res;
+    return res;
+}
+
+
+/// Find the maximum floating point column value
+float columnMaxf(const float *col, size_t n) {
+    if(__hasAvx2()) return __columnMaxfAvx2(col, n);
+
+    float res = col[0];
+    for(size_t i = 1; i < n; i++)
+        res = col[i] > res ? col[i] : res;
+    return res;
+}
+
+
+/// Find the minimum integer column value
+int32_t columnMini32(const int32_t *col, size_t n) {
+    if(__hasAvx2()) return __columnMini32Avx2(col, n);
+
+    int32_t res = col[0];
+    for(size_t i = 1; i < n; i++)
+        res = col[i] < res ? col[i] : res;
+    return res;
+}
+
+
+/// Find the maximum integer column value
+int32_t columnMaxi32(const int32_t *col, size_t n) {
+    if(__hasAvx2()) return __columnMaxi32Avx2(col, n);
+
+    int32_t res = col[0];
+    for(size_t i = 1; i < n; i++)
+        res = col[i] > res ? col[i] : res;
+    return res;
+}
+
+
+/// Write the indices of floating point column values in range [lo, hi] into out
+/// Returns the amount of written indices
+size_t columnFilterRangef(const float *col, size_t n, float lo, float hi, uint32_t *out) {
+    if(__hasAvx2()) return __columnFilterRangefAvx2(col, n, lo, hi, out);
+
+    size_t c = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(col[i] >= lo && col[i] <= hi)
+            out[c++] = (uint32_t) i;
+    }
+
+    return c;
+}
+
+
+/// Write the indices of integer column values in range [lo, hi] into out
+/// Returns the amount of written indices
+size_t columnFilterRangei32(const int32_t *col, size_t n, int32_t lo, int32_t hi, uint32_t *out) {
+    if(__hasAvx2()) return __columnFilterRangei32Avx2(col, n, lo, hi, out);
+
+    size_t c = 0;
+    for(size_t i = 0; i < n; i++) {
+        if(col[i] >= lo && col[i] <= hi)
+            out[c++] = (uint32_t) i;
+    }
+
+    return c;
+}
@@ -0,0 +1,157 @@
+/*
+ * File:        log_slab.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-12
+ * Last edit:   2021-06-12
+ * Description: Function definitions for log row allocation with tombstones
+ *              and compaction of deleted rows
+ */
+
+
+#define __LOG_SLAB_C
+#include <log_slab.h>
+
+
+/// Make sure that the tombstone bits cover at least row_c rows
+static void __reserveTombstoneBits(LogTombstones *p_tombs, size_t row_c) {
+    size_t word_c = (row_c + 63) / 64;
+    if(word_c <= p_tombs->word_c) return;
+
+    // Grow to the next power of two words, new words have no tombstones
+    size_t new_c = __roundToBase2(word_c);
+    uint64_t *bits = (uint64_t*) memRealloc(MEM_TAG_LOGS, p_tombs->bits, p_tombs->word_c * sizeof(uint64_t),
+        new_c * sizeof(uint64_t));
+    if(!bits) {
+        fprintf(stderr, "Failed to allocate memory for log tombstones\n");
+        exit(EXIT_FAILURE);
+    }
+
+    memset(bits + p_tombs->word_c, 0, (new_c - p_tombs->word_c) * sizeof(uint64_t));
+    p_tombs->bits = bits;
+    p_tombs->word_c = new_c;
+}
+
+
+/// Check if the log row is deleted
+bool isLogRowDead(const PlantLogs *p_logs, size_t row) {
+    return p_logs->tombs.n && (p_logs->tombs.bits[row >> 6] >> (row & 63) & 1);
+}
+
+
+/// Find the amount of logs that are not deleted
+size_t liveLogCount(const PlantLogs *p_logs) {
+    return p_logs->n - p_logs->tombs.n;
+}
+
+
+/// Allocate a row for a new log, deleted rows are reused before the log array is grown
+/// NOTE: Returned row may be a reused row, so columns must be set instead of pushed if
+/// the row is below the column count
+uint32_t allocLogRow(PlantLogs *p_logs) {
+    LogTombstones *p_tombs = &p_logs->tombs;
+    if(p_tombs->n) {
+        uint32_t row = p_tombs->free_rows[--p_tombs->n];
+        p_tombs->bits[row >> 6] &= ~(1ull << (row & 63));
+        return row;
+    }
+
+    // Mapped logs are grown in the data file
+    if(p_logs->store)
+        return allocStoreLogRow(p_logs->store, p_logs);
+
+    memReallocCheck(MEM_TAG_LOGS, (void**) &p_logs->entries, sizeof(LogEntry), p_logs->n + 1, &p_logs->cap);
+    return (uint32_t) p_logs->n++;
+}
+
+
+/// Mark the log row as deleted and put it into the free list
+/// NOTE: The row must be removed from the indexes and id map separately
+void freeLogRow(PlantLogs *p_logs, uint32_t row) {
+    LogTombstones *p_tombs = &p_logs->tombs;
+    __reserveTombstoneBits(p_tombs, p_logs->n);
+    memReallocCheck(MEM_TAG_LOGS, (void**) &p_tombs->free_rows, sizeof(uint32_t), p_tombs->n + 1, &p_tombs->cap);
+
+    p_tombs->bits[row >> 6] |= 1ull << (row & 63);
+    p_tombs->free_rows[p_tombs->n++] = row;
+    memset(p_logs->entries + row, 0, sizeof(LogEntry));
+    p_logs->entries[row].log_id = DEAD_LOG_ID;
+}
+
+
+/// Remove all deleted rows from the bitmap of rows
+void removeDeadLogRows(const PlantLogs *p_logs, RoaringBitmap *p_rows) {
+    for(size_t i = 0; i < p_logs->tombs.n; i++)
+        roaringRemove(p_rows, p_logs->tombs.free_rows[i]);
+}
+
+
+/// Check if enough rows are deleted that the logs should be compacted
+bool shouldCompactLogs(const PlantLogs *p_logs) {
+    return p_logs->tombs.n >= __MIN_COMPACT_ROW_C && 
+        p_logs->tombs.n * __COMPACT_DEAD_RATIO >= p_logs->n;
+}
+
+
+/// Move all live logs to the front of the log array in their current order and 
+/// remap the id map, power plant log rows, columns and indexes accordingly
+/// Unused log slots and tombstone memory are released afterwards
+/// Returns the amount of deleted rows that were removed
+size_t compactLogs(PowerPlants *p_plants, PlantLogs *p_logs, IdMap *p_map) {
+    size_t dead_c = p_logs->tombs.n;
+    if(!dead_c) return 0;
+
+    // Live rows keep their relative order, so each plant's date ordered rows stay ordered
+    size_t row_c = p_logs->n;
+    uint32_t *remap = (uint32_t*) memAlloc(MEM_TAG_SORT, row_c * sizeof(uint32_t));
+    if(!remap) {
+        fprintf(stderr, "Failed to allocate memory for log compaction\n");
+        exit(EXIT_FAILURE);
+    }
+
+    size_t live_c = 0;
+    for(size_t i = 0; i < p_logs->n; i++) {
+        if(isLogRowDead(p_logs, i)) {
+            remap[i] = UINT32_MAX;
+            continue;
+        }
+
+        if(live_c != i) {
+            p_logs->entries[live_c] = p_logs->entries[i];
+            idMapPut(p_map, p_logs->entries[live_c].log_id, (uint32_t) live_c);
+            if(p_logs->cols)
+                setLogColumnsRow(p_logs->cols, live_c, p_logs->entries + live_c);
+        }
+
+        remap[i] = (uint32_t) live_c++;
+    }
+
+    for(size_t i = 0; i < p_plants->n; i++) {
+        PlantLogRows *p_rows = &p_plants->plants[i].logs;
+        for(size_t j = 0; j < p_rows->n; j++)
+            p_rows->rows[j] = remap[p_rows->rows[j]];
+    }
+
+    p_logs->n = live_c;
+    if(p_logs->cols)
+        p_logs->cols->n = live_c;
+
+    // Compaction follows bulk deletes, so the unused log slots are released
+    if(p_logs->store)
+        fitStoreLogs(p_logs->store, p_logs);
+    else memShrinkToFit(MEM_TAG_LOGS, (void**) &p_logs->entries, sizeof(LogEntry), live_c, &p_logs->cap);
+
+    // All tombstones are gone, so their memory is released before rebuilding the indexes
+    destroyLogTombstones(p_logs);
+    rebuildLogIndexes(p_logs);
+
+    memFree(MEM_TAG_SORT, remap, row_c * sizeof(uint32_t));
+    return dead_c;
+}
+
+
+/// Free all memory allocated for log tombstones
+void destroyLogTombstones(PlantLogs *p_logs) {
+    memFree(MEM_TAG_LOGS, p_logs->tombs.bits, p_logs->tombs.word_c * sizeof(uint64_t));
+    memFree(MEM_TAG_LOGS, p_logs->tombs.free_rows, p_logs->tombs.cap * sizeof(uint32_t));
+    memset(&p_logs->tombs, 0, sizeof(LogTombstones));
+}
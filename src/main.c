@@ -12,29 +12,50 @@
 
 
 /// Poll user input
-void poll(char *pow_file, char *log_file, time_t start) {
+void poll(char *pow_file, char *log_file, char *store_file, time_t start) {
     // Create a new logger instance
     FILE *slog = newLogger(start);
 
-    // Parse and log power plants information
     PowerPlants plants = { 0 };
-    parsePowerPlantFile(pow_file, &plants);
-    logMiscInfo(slog, "Parsed power plant file contents\n", start);
-
-    // Parse and log power plant logs
     PlantLogs logs = { 0 };
-    parseLogsFile(log_file, &logs);
-    logMiscInfo(slog, "Parsed log file contents\n", start);
+    DataStore store = { 0 };
+    if(!pow_file) {
+        // Map logs and load power plants from the existing data file
+        openDataStore(&store, store_file, &plants, &logs);
+        logMiscInfo(slog, "Opened data store\n", start);
+    }
+
+    else {
+        // Parse and log power plants information
+        parsePowerPlantFile(pow_file, &plants);
+        logMiscInfo(slog, "Parsed power plant file contents\n", start);
+
+        // Parse and log power plant logs
+        parseLogsFile(log_file, &logs);
+        logMiscInfo(slog, "Parsed log file contents\n", start);
+    }
 
     // Create commandline token map
     Hashmap tokens = tokeniseUserInput();
 
-    // Create hashmap instances for power plant data and daily log data
-    Hashmap pow_map = createPowerPlantMap(&plants);
-    Hashmap log_map = createLogMap(&logs);
+    // Create id maps for power plant data and daily log data
+    IdMap pow_map = createPowerPlantMap(&plants);
+    IdMap log_map = createLogMap(&logs);
+
+    // Put log data into their corresponding PlantData instance, which reorders
+    // the logs by power plant
+    associateLogData(&plants, &logs, &pow_map, &log_map);
+
+    // Parsed data is moved into a new data file
+    if(store_file && !logs.store) {
+        createDataStore(&store, store_file, &plants, &logs);
+        logMiscInfo(slog, "Created data store\n", start);
+    }
 
-    // Put log data into their corresponding PlantData instance
-    associateLogData(&plants, &logs, &pow_map);
+    // Keep a columnar copy of logs for scanning single fields
+    LogColumns log_cols = { 0 };
+    newLogColumns(&log_cols, &logs);
+    logs.cols = &log_cols;
 
     // Input data buffer
     char in_buf[__DEFAULT_BUF_LEN] = { 0 };
@@ -42,7 +63,7 @@ void poll(char *pow_file, char *log_file, time_t start) {
     // Set the selected id as maximum possible
     uint32_t selected = UINT32_MAX;
     char *name_arg = NULL;
-    ListSortMode sort_mode = LIST_SORT_MODE_UNKNOWN;
+    ListQuery query = { 0 };
 
     // Allocate resources for ncurses
     printf("Welcome to energy manager program!\n"\
@@ -62,9 +83,8 @@ void poll(char *pow_file, char *log_file, time_t start) {
 
         // Parse the input into enumeral value
         uint32_t arg = UINT32_MAX;
-        sort_mode = LIST_SORT_MODE_UNKNOWN;
         UserInputAction act = parseUserInputAction(&tokens, in_buf, selected != UINT32_MAX,
-            &sort_mode, &arg);
+            &query, &arg);
 
         // Check the parsed action value and call appropriate functions
         switch(act) {
@@ -78,15 +98,15 @@ void poll(char *pow_file, char *log_file, time_t start) {
             break;
 
         case USER_INPUT_ACTION_U_LIST_PLANTS:
-            listPowerPlants(&plants, sort_mode);
+            listPowerPlants(&plants, &query);
             break;
 
         case USER_INPUT_ACTION_U_EDIT_POWER_PLANT:
-            editPowerPlant(&pow_map, arg);
+            editPowerPlant(&plants, &pow_map, arg);
             break;
 
         case USER_INPUT_ACTION_U_LIST_LOGS:
-            listAllLogs(&logs, sort_mode);
+            listAllLogs(&plants, &logs, &query);
             break;
 
         case USER_INPUT_ACTION_U_DELETE_POWER_PLANT:
@@ -97,18 +117,50 @@ void poll(char *pow_file, char *log_file, time_t start) {
             selectionCheck(&selected, arg, &pow_map);
             break;
 
+        case USER_INPUT_ACTION_U_SHOW_STATS:
+            showLogStats(&plants, &logs);
+            break;
+
+        case USER_INPUT_ACTION_U_SHOW_FUEL_STATS:
+            showFuelStats(&plants, &logs, arg);
+            break;
+
+        case USER_INPUT_ACTION_U_SHOW_QUANTILES:
+            showQuantiles(&plants, &logs, NULL, &query);
+            break;
+
+        case USER_INPUT_ACTION_U_SHOW_ROLLING:
+            showRollingRanking(&plants, &logs, arg);
+            break;
+
+        case USER_INPUT_ACTION_U_SHOW_ROLLUP:
+            showRollup(&plants, NULL, &query);
+            break;
+
+        case USER_INPUT_ACTION_U_COUNT_LOGS:
+            countLogs(&plants, &logs, NULL, &query);
+            break;
+
+        case USER_INPUT_ACTION_U_GROUP_LOGS:
+            showGroupAggregates(&plants, &logs, &query);
+            break;
+
+        case USER_INPUT_ACTION_U_ARCHIVE_LOGS:
+            archiveOldLogs(&plants, &logs, &log_map, arg);
+            break;
+
         case USER_INPUT_ACTION_S_SHOW_HELP:
             showHelp(true);
             break;
 
         case USER_INPUT_ACTION_S_LIST_LOGS: {
-            PlantData *data = (PlantData*) findValue(&pow_map, &selected, sizeof(uint32_t));
-            listPowerPlantLogs(data, sort_mode);
+            PlantData *data = findPowerPlant(&plants, &pow_map, selected);
+            listPowerPlantLogs(&plants, &logs, data, &query);
             break;
         }
 
         case USER_INPUT_ACTION_S_EDIT_LOG:
-            editLog(&pow_map, &log_map, selected, arg);
+            editLog(&plants, &logs, &pow_map, &log_map, selected, arg);
             break;
 
         case USER_INPUT_ACTION_S_NEW_LOG: {
@@ -117,34 +169,81 @@ void poll(char *pow_file, char *log_file, time_t start) {
         }
 
         case USER_INPUT_ACTION_S_DELETE_LOG:
-            deleteLog(&logs, &pow_map, &log_map, selected, arg);
+            deleteLog(&plants, &logs, &pow_map, &log_map, selected, arg);
             break;
 
+        case USER_INPUT_ACTION_S_SHOW_ROLLUP: {
+            PlantData *data = findPowerPlant(&plants, &pow_map, selected);
+            showRollup(&plants, data, &query);
+            break;
+        }
+
+        case USER_INPUT_ACTION_S_SHOW_QUANTILES: {
+            PlantData *data = findPowerPlant(&plants, &pow_map, selected);
+            showQuantiles(&plants, &logs, data, &query);
+            break;
+        }
+
+        case USER_INPUT_ACTION_S_SHOW_ROLLING: {
+            PlantData *data = findPowerPlant(&plants, &pow_map, selected);
+            showRolling(&logs, data, arg);
+            break;
+        }
+
+        case USER_INPUT_ACTION_S_COUNT_LOGS: {
+            PlantData *data = findPowerPlant(&plants, &pow_map, selected);
+            countLogs(&plants, &logs, data, &query);
+            break;
+        }
+
         case USER_INPUT_ACTION_S_UNSEL_POWER_PLANT:
             selected = UINT32_MAX;
             name_arg = NULL;
             break;
 
+        case USER_INPUT_ACTION_COMPACT:
+            compactLogArray(&plants, &logs, &log_map);
+            break;
+
+        case USER_INPUT_ACTION_MEM:
+            showMemoryUsage(&plants, &logs, &pow_map, &log_map);
+            break;
+
         case USER_INPUT_ACTION_SAVE:
-            saveData(&plants, &logs, pow_file, log_file);
+            if(logs.store)
+                syncStoreData(&store, &plants, &logs);
+            else saveData(&plants, &logs, pow_file, log_file);
             break;
 
         case USER_INPUT_ACTION_EXIT:
-            // Clear hashmaps
-            destroyHashmap(&pow_map);
-            destroyHashmap(&log_map);
+            // Clear id maps and token hashmap
+            destroyIdMap(&pow_map);
+            destroyIdMap(&log_map);
             destroyHashmap(&tokens);
 
+            // Data file is synced before the archives it is written from are freed
+            if(logs.store)
+                closeDataStore(&store, &plants, &logs);
+            else memFree(MEM_TAG_LOGS, logs.entries, logs.cap * sizeof(LogEntry));
+
             // For each power plant instance free the memory that was
-            // allocated for their log pointers and name
+            // allocated for their archives, rollups and sketches
             for(size_t i = 0; i < plants.n; i++) {
-                free(plants.plants[i].name);
-                free(plants.plants[i].logs.p_entries);
+                destroyPlantArchive(&plants.plants[i].archive);
+                destroyPlantRollup(&plants.plants[i].rollup);
+                destroyPlantSketches(&plants.plants[i].sketch);
             }
+
+            // Power plant names and log rows are released with the arena
+            destroyArena(&plants.arena);
             
             // Free all memory that was allocated for storing plant and log data
-            free(plants.plants);
-            free(logs.entries);
+            memFree(MEM_TAG_PLANTS, plants.plants, plants.cap * sizeof(PlantData));
+            destroyLogColumns(&log_cols);
+            destroyLogIndexes(&logs);
+            destroyLogTombstones(&logs);
+            destroyRoaring(&logs.archived_ids);
+            destroyPlantIndexes(&plants);
 
             is_running = false;
             break;
@@ -154,6 +253,16 @@ void poll(char *pow_file, char *log_file, time_t start) {
             break;
         }
 
+        // Power plants and archives are only kept in memory, so the data file is synced
+        // when they change, while changed log rows are flushed periodically
+        if(logs.store) {
+            if(act == USER_INPUT_ACTION_U_NEW_POWER_PLANT || act == USER_INPUT_ACTION_U_EDIT_POWER_PLANT ||
+               act == USER_INPUT_ACTION_U_DELETE_POWER_PLANT || act == USER_INPUT_ACTION_U_ARCHIVE_LOGS)
+                syncDataStore(&store, &plants, &logs);
+            else if(isDataStoreSyncDue(&store))
+                flushDataStore(&store, &logs);
+        }
+
         // Log the command into command log file
         logCommandAction(slog, act, arg != UINT32_MAX ? arg : selected, start);
     }
@@ -163,10 +272,65 @@ void poll(char *pow_file, char *log_file, time_t start) {
 }
 
 
+/// Run the program in standalone log file sorting mode
+/// Usage: sort-file <input> <output> [[i|d] <key>] [limit <N>] [offset <N>] [mem <MB>]
+int sortFileMode(int argc, char *argv[]) {
+    // Check if input and output files were given
+    if(argc < 2) {
+        fprintf(stderr, "%s", __sort_file_usage);
+        return EXIT_FAILURE;
+    }
+
+    // Find the memory budget argument and remove it from sorting arguments
+    size_t mem_budget = DEFAULT_SORT_MEM_BUDGET;
+    char **args = (char**) calloc(argc, sizeof(char*));
+    size_t arg_c = 0;
+    for(int i = 2; i < argc; i++) {
+        if(!strcmp(argv[i], "mem") && i + 1 < argc && numcheck(argv[i + 1], strlen(argv[i + 1]))) {
+            mem_budget = (size_t) strtoull(argv[i + 1], NULL, 10) << 20;
+            i++;
+        }
+        else args[arg_c++] = argv[i];
+    }
+
+    // Parse the sorting arguments, only a single sort key is supported
+    ListQuery query = { 0 };
+    if(!parseLogListArgs(args, arg_c, &query) || query.smode_c != 1) {
+        fprintf(stderr, "%s", __sort_file_usage);
+        free(args);
+        return EXIT_FAILURE;
+    }
+
+    free(args);
+    sortLogsFile(argv[0], argv[1], &query, mem_budget);
+    return EXIT_SUCCESS;
+}
+
+
 int main(int argc, char *argv[]) {
+    // Check if the program should run in standalone log file sorting mode
+    if(argc > 1 && !strcmp(argv[1], "sort-file"))
+        return sortFileMode(argc - 2, argv + 2);
+
     // Start measuring program runtime duration
     time_t start = time(NULL);
 
+    // Check if the program should run in data store mode
+    char *store_file = NULL;
+    if(argc > 1 && !strcmp(argv[1], "store")) {
+        if(argc < 3) {
+            fprintf(stderr, "%s", __store_usage);
+            return EXIT_FAILURE;
+        }
+
+        // Existing data file replaces the power plant and log files
+        store_file = argv[2];
+        if(!access(store_file, F_OK)) {
+            poll(NULL, NULL, store_file, start);
+            return EXIT_SUCCESS;
+        }
+    }
+
     // Read the user input about power plant file
     char pow_file[1024] = { 0 };
     printf("Enter power plant file name: ");
@@ -182,6 +346,6 @@ int main(int argc, char *argv[]) {
     log_file[strlen(log_file) - 1] = 0x00;
 
     // Start input polling
-    poll(pow_file, log_file, start);
+    poll(pow_file, log_file, store_file, start);
     return EXIT_SUCCESS;
 }
@@ -27,27 +27,177 @@ size_t __roundToBase2(size_t k) {
 }
 
 
-/// Check if memory reallocation is necessary based on the required size and capacity
+/// Check if memory reallocation is necessary based on the required element count and capacity
+/// The capacity is counted in elements and grown by the array growth factor until req_n elements fit
 void reallocCheck(void **p_data, size_t size, size_t req_n, size_t *p_cap) {
-    // Check if the required memory size is bigger than capacity
-    if(size * req_n >= (*p_cap)) {
-        // Assign new capacity value determined from the rounded required size or rounded previous cap * 2
-        (*p_cap) = __roundToBase2(size * req_n) < __roundToBase2((*p_cap) << 1) ? 
-                   __roundToBase2((*p_cap) << 1) : __roundToBase2((size * req_n) << 1);
-
-        // Attempt reallocation
-        void *tmp = realloc((*p_data), (*p_cap) * size);
-
-        // If the previous reallocation was not successful, throw an error
-        if(!tmp) {
-            fprintf(stderr, "Failed reallocation");
-            exit(EXIT_FAILURE);
-        }
-        (*p_data) = tmp;
+    // Check if the required element count is bigger than capacity
+    if(req_n <= (*p_cap)) return;
+
+    size_t cap = (*p_cap) ? (*p_cap) : ARRAY_MIN_CAP;
+    while(cap < req_n) {
+        // Small capacities are grown by at least one element
+        size_t next = cap * ARRAY_GROWTH_NUM / ARRAY_GROWTH_DEN;
+        cap = next > cap ? next : cap + 1;
+    }
+
+    // Attempt reallocation
+    void *tmp = realloc((*p_data), cap * size);
+
+    // If the previous reallocation was not successful, throw an error
+    if(!tmp) {
+        fprintf(stderr, "Failed reallocation");
+        exit(EXIT_FAILURE);
+    }
+
+    (*p_data) = tmp;
+    (*p_cap) = cap;
+}
+
+
+/// Shrink the capacity of the array to its element count, memory of empty arrays is released
+void shrinkToFit(void **p_data, size_t size, size_t n, size_t *p_cap) {
+    if(n >= (*p_cap)) return;
+
+    if(!n) {
+        free(*p_data);
+        (*p_data) = NULL;
+        (*p_cap) = 0;
+        return;
+    }
+
+    // Failing to shrink is not an error, the array is just left at its old capacity
+    void *tmp = realloc((*p_data), n * size);
+    if(!tmp) return;
+
+    (*p_data) = tmp;
+    (*p_cap) = n;
+}
+
+
+/// Account allocated bytes under the subsystem tag
+void memTrackAlloc(MemTag tag, size_t size) {
+    MemTagStats *p_stats = __mem_tag_stats + tag;
+    p_stats->live += size;
+    p_stats->alloc_c++;
+    if(p_stats->live > p_stats->peak)
+        p_stats->peak = p_stats->live;
+}
+
+
+/// Account freed bytes under the subsystem tag
+void memTrackFree(MemTag tag, size_t size) {
+    MemTagStats *p_stats = __mem_tag_stats + tag;
+    p_stats->live = size > p_stats->live ? 0 : p_stats->live - size;
+}
+
+
+/// Allocate memory and account it under the subsystem tag
+/// NULL is returned if the allocation fails
+void *memAlloc(MemTag tag, size_t size) {
+    void *ptr = malloc(size);
+    if(ptr) memTrackAlloc(tag, size);
+    return ptr;
+}
+
+
+/// Allocate zeroed memory and account it under the subsystem tag
+/// NULL is returned if the allocation fails
+void *memCalloc(MemTag tag, size_t n, size_t size) {
+    void *ptr = calloc(n, size);
+    if(ptr) memTrackAlloc(tag, n * size);
+    return ptr;
+}
+
+
+/// Resize memory that was accounted under the subsystem tag
+/// NULL is returned if the reallocation fails, in which case the old memory is kept
+void *memRealloc(MemTag tag, void *ptr, size_t old_size, size_t new_size) {
+    void *tmp = realloc(ptr, new_size);
+    if(!tmp) return NULL;
+
+    // Count the resize as a single allocation of the new size
+    memTrackFree(tag, ptr ? old_size : 0);
+    memTrackAlloc(tag, new_size);
+    return tmp;
+}
+
+
+/// Free memory that was accounted under the subsystem tag with the given size
+void memFree(MemTag tag, void *ptr, size_t size) {
+    if(!ptr) return;
+    memTrackFree(tag, size);
+    free(ptr);
+}
+
+
+/// Same as reallocCheck, but the reallocated bytes are accounted under the subsystem tag
+void memReallocCheck(MemTag tag, void **p_data, size_t size, size_t req_n, size_t *p_cap) {
+    size_t old_cap = *p_cap;
+    void *old_data = *p_data;
+    reallocCheck(p_data, size, req_n, p_cap);
+
+    if(*p_cap != old_cap) {
+        memTrackFree(tag, old_data ? old_cap * size : 0);
+        memTrackAlloc(tag, (*p_cap) * size);
+    }
+}
+
+
+/// Same as shrinkToFit, but the released bytes are accounted under the subsystem tag
+void memShrinkToFit(MemTag tag, void **p_data, size_t size, size_t n, size_t *p_cap) {
+    size_t old_cap = *p_cap;
+    shrinkToFit(p_data, size, n, p_cap);
+    memTrackFree(tag, (old_cap - (*p_cap)) * size);
+}
+
+
+/// Retrieve allocation statistics of the subsystem tag
+MemTagStats memTagStats(MemTag tag) {
+    return __mem_tag_stats[tag];
+}
+
+
+/// Convert MemTag enumeral into appropriate string
+char *memTagToStr(MemTag tag) {
+    switch(tag) {
+        case MEM_TAG_PLANTS:        return "plants";
+        case MEM_TAG_LOGS:          return "logs";
+        case MEM_TAG_REFS:          return "refs";
+        case MEM_TAG_MAPS:          return "maps";
+        case MEM_TAG_PARSER:        return "parser";
+        case MEM_TAG_SORT:          return "sort";
+        case MEM_TAG_ARCHIVE:       return "archive";
+        case MEM_TAG_STORE:         return "store";
+        default:                    return NULL;
     }
 }
 
 
+/// Find the current resident set size of the process in bytes
+/// Returns 0 if the resident set size is not available
+size_t residentSetSize() {
+    FILE *file = fopen("/proc/self/statm", "r");
+    if(!file) return 0;
+
+    // Second field is the amount of resident pages
+    unsigned long size = 0, res = 0;
+    int field_c = fscanf(file, "%lu %lu", &size, &res);
+    fclose(file);
+
+    return field_c == 2 ? (size_t) res * (size_t) sysconf(_SC_PAGESIZE) : 0;
+}
+
+
+/// Find the peak resident set size of the process in bytes
+size_t peakResidentSetSize() {
+    struct rusage usage;
+    if(getrusage(RUSAGE_SELF, &usage)) return 0;
+
+    // Maximum resident set size is given in kilobytes
+    return (size_t) usage.ru_maxrss << 10;
+}
+
+
 /// Check if the given memory area contains only ascii numbers
 /// Returns 1 if the memory area contains only ascii numbers and 0 otherwise
 bool numcheck(char *data, size_t len) {
@@ -0,0 +1,440 @@
+/*
+ * File:        predicate.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-10
+ * Last edit:   2021-06-10
+ * Description: Function definitions for evaluating compiled filter predicates over
+ *              power plants, log entries and log columns
+ */
+
+
+#define __PREDICATE_C
+#include <predicate.h>
+
+
+/// Find the value of the predicate field of the power plant
+static double __powerPlantFieldValue(void *p_row, PredicateField field) {
+    PlantData *p_plant = (PlantData*) p_row;
+    switch(field) {
+        case PREDICATE_FIELD_POW_ID:        return p_plant->no;
+        case PREDICATE_FIELD_POW_FUEL:      return p_plant->fuel;
+        case PREDICATE_FIELD_POW_RATED_CAP: return p_plant->rated_cap;
+        case PREDICATE_FIELD_POW_AVG_PRICE: return p_plant->avg_cost;
+        case PREDICATE_FIELD_POW_AVG_UTIL:  return p_plant->avg_utilisation;
+        default:                            return 0;
+    }
+}
+
+
+/// Find the value of the predicate field of the log entry
+static double __logEntryFieldValue(void *p_row, PredicateField field) {
+    LogEntry *p_entry = (LogEntry*) p_row;
+    switch(field) {
+        case PREDICATE_FIELD_LOG_ID:            return p_entry->log_id;
+        case PREDICATE_FIELD_LOG_PLANT_ID:      return p_entry->plant_no;
+        case PREDICATE_FIELD_LOG_PRODUCTION:    return p_entry->production;
+        case PREDICATE_FIELD_LOG_SALE_PRICE:    return p_entry->avg_sale_price;
+        case PREDICATE_FIELD_LOG_DATE:          return p_entry->date;
+        case PREDICATE_FIELD_LOG_YEAR:          return epochDayToDate(p_entry->date).year;
+        case PREDICATE_FIELD_LOG_MONTH:         return epochDayToDate(p_entry->date).month;
+        case PREDICATE_FIELD_LOG_DAY:           return epochDayToDate(p_entry->date).day;
+        default:                                return 0;
+    }
+}
+
+
+/// Find the value of the predicate field of the archived log
+static double __archivedLogFieldValue(void *p_row, PredicateField field) {
+    __ArchivedLogRow *p_row_data = (__ArchivedLogRow*) p_row;
+    if(field == PREDICATE_FIELD_LOG_FUEL)
+        return p_row_data->fuel;
+
+    return __logEntryFieldValue(p_row_data->p_entry, field);
+}
+
+
+/// Evaluate the predicate for a single row, whose field values are found with
+/// the given value function
+/// If comparison bitmaps are given, comparisons on indexed fields are answered
+/// by checking if the bitmap contains the row index
+static bool __matchRow (
+    void *p_row,
+    double (*value)(void*, PredicateField),
+    const PredicateInstr *pred,
+    size_t pred_c,
+    const RoaringBitmap *bms,
+    uint32_t row
+) {
+    bool stack[LIST_MAX_PREDICATE_C];
+    size_t n = 0;
+
+    for(size_t i = 0; i < pred_c; i++) {
+        const PredicateInstr *p_instr = pred + i;
+        switch(p_instr->op) {
+            case PREDICATE_OP_AND:  n--; stack[n - 1] = stack[n - 1] && stack[n]; break;
+            case PREDICATE_OP_OR:   n--; stack[n - 1] = stack[n - 1] || stack[n]; break;
+            case PREDICATE_OP_NOT:  stack[n - 1] = !stack[n - 1]; break;
+            default: {
+                if(bms && isIndexedPredicateField(p_instr->field)) {
+                    stack[n++] = roaringContains(bms + i, row);
+                    break;
+                }
+
+                double v = value(p_row, p_instr->field);
+                stack[n++] = __cmpBlock(&v, 1, p_instr->op, p_instr->val) & 1;
+                break;
+            }
+        }
+    }
+
+    return n ? stack[0] : true;
+}
+
+
+/// Compare the index key value with the constant of the comparison instruction
+static bool __cmpKey(const PredicateInstr *p_instr, double key) {
+    return __cmpBlock(&key, 1, p_instr->op, p_instr->val) & 1;
+}
+
+
+/// Add all rows of the index keys that match the comparison into the output bitmap
+static void __indexCmp(BitmapIndex *p_idx, const PredicateInstr *p_instr, RoaringBitmap *p_out) {
+    for(size_t i = 0; i < p_idx->n; i++) {
+        if(__cmpKey(p_instr, p_idx->entries[i].key))
+            roaringOr(p_out, &p_idx->entries[i].rows);
+    }
+}
+
+
+/// Add all log rows of the log months that match the year or month comparison
+/// into the output bitmap
+static void __indexMonthCmp(PlantLogs *p_logs, const PredicateInstr *p_instr, RoaringBitmap *p_out) {
+    for(size_t i = 0; i < p_logs->month_idx.n; i++) {
+        // Split months since 1970-01 into civil year and month
+        int32_t month = monthIndexKeyToMonth(p_logs->month_idx.entries[i].key);
+        int32_t year = (month >= 0 ? month : month - 11) / 12;
+        double key = p_instr->field == PREDICATE_FIELD_LOG_YEAR ? 1970 + year : month - year * 12 + 1;
+
+        if(__cmpKey(p_instr, key))
+            roaringOr(p_out, &p_logs->month_idx.entries[i].rows);
+    }
+}
+
+
+/// Add all log rows of the power plants, whose fuel type matches the comparison,
+/// into the output bitmap
+static void __indexLogFuelCmp (
+    PowerPlants *p_plants,
+    PlantLogs *p_logs,
+    const PredicateInstr *p_instr,
+    RoaringBitmap *p_out
+) {
+    uint32_t *plant_rows = (uint32_t*) malloc((p_plants->n ? p_plants->n : 1) * sizeof(uint32_t));
+    for(size_t i = 0; i < p_plants->fuel_idx.n; i++) {
+        if(!__cmpKey(p_instr, p_plants->fuel_idx.entries[i].key))
+            continue;
+
+        // Join the power plants of the fuel type with their log rows
+        size_t n = roaringToArray(&p_plants->fuel_idx.entries[i].rows, plant_rows);
+        for(size_t j = 0; j < n; j++) {
+            RoaringBitmap *p_rows = bitmapIndexFind(&p_logs->plant_idx, p_plants->plants[plant_rows[j]].no);
+            if(p_rows) roaringOr(p_out, p_rows);
+        }
+    }
+
+    free(plant_rows);
+}
+
+
+/// Load the field values of n column rows starting from beg
+static void __loadColumnBlock (
+    LogColumns *p_cols,
+    PredicateField field,
+    size_t beg,
+    size_t n,
+    double *vals
+) {
+    switch(field) {
+        case PREDICATE_FIELD_LOG_ID:
+            for(size_t i = 0; i < n; i++) vals[i] = p_cols->log_id[beg + i];
+            break;
+
+        case PREDICATE_FIELD_LOG_PLANT_ID:
+            for(size_t i = 0; i < n; i++) vals[i] = p_cols->plant_no[beg + i];
+            break;
+
+        case PREDICATE_FIELD_LOG_PRODUCTION:
+            for(size_t i = 0; i < n; i++) vals[i] = p_cols->production[beg + i];
+            break;
+
+        case PREDICATE_FIELD_LOG_SALE_PRICE:
+            for(size_t i = 0; i < n; i++) vals[i] = p_cols->avg_sale_price[beg + i];
+            break;
+
+        case PREDICATE_FIELD_LOG_DATE:
+            for(size_t i = 0; i < n; i++) vals[i] = p_cols->date[beg + i];
+            break;
+
+        // Civil date fields are derived from the epoch day of each row
+        case PREDICATE_FIELD_LOG_YEAR:
+            for(size_t i = 0; i < n; i++) vals[i] = epochDayToDate(p_cols->date[beg + i]).year;
+            break;
+
+        case PREDICATE_FIELD_LOG_MONTH:
+            for(size_t i = 0; i < n; i++) vals[i] = epochDayToDate(p_cols->date[beg + i]).month;
+            break;
+
+        case PREDICATE_FIELD_LOG_DAY:
+            for(size_t i = 0; i < n; i++) vals[i] = epochDayToDate(p_cols->date[beg + i]).day;
+            break;
+
+        default:
+            memset(vals, 0, n * sizeof(double));
+            break;
+    }
+}
+
+
+/// Compare each block value with the constant and return the results as a bit mask
+static uint64_t __cmpBlock(const double *vals, size_t n, PredicateOp op, double c) {
+    uint64_t mask = 0;
+
+    // The operator is resolved outside of the loops, so that each loop is branchless
+    switch(op) {
+        case PREDICATE_OP_LT:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] < c) << i;
+            break;
+
+        case PREDICATE_OP_LE:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] <= c) << i;
+            break;
+
+        case PREDICATE_OP_GT:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] > c) << i;
+            break;
+
+        case PREDICATE_OP_GE:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] >= c) << i;
+            break;
+
+        case PREDICATE_OP_EQ:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] == c) << i;
+            break;
+
+        case PREDICATE_OP_NE:
+            for(size_t i = 0; i < n; i++) mask |= (uint64_t) (vals[i] != c) << i;
+            break;
+
+        default: break;
+    }
+
+    return mask;
+}
+
+
+/// Check if comparisons on the predicate field can be answered from bitmap indexes
+bool isIndexedPredicateField(PredicateField field) {
+    switch(field) {
+        case PREDICATE_FIELD_POW_FUEL:
+        case PREDICATE_FIELD_LOG_PLANT_ID:
+        case PREDICATE_FIELD_LOG_YEAR:
+        case PREDICATE_FIELD_LOG_MONTH:
+        case PREDICATE_FIELD_LOG_FUEL:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+
+/// Evaluate each comparison of the predicate on an indexed field into the bitmap of
+/// matching rows, bitmaps of the other instructions are left empty
+/// Log fields are evaluated over log rows and power plant fields over power plant rows
+/// Returns true if every comparison of the predicate is on an indexed field
+bool indexPredicate (
+    PowerPlants *p_plants,
+    PlantLogs *p_logs,
+    const PredicateInstr *pred,
+    size_t pred_c,
+    RoaringBitmap *bms
+) {
+    bool is_indexed = true;
+    memset(bms, 0, pred_c * sizeof(RoaringBitmap));
+
+    for(size_t i = 0; i < pred_c; i++) {
+        const PredicateInstr *p_instr = pred + i;
+        if(p_instr->op > PREDICATE_OP_LAST_CMP)
+            continue;
+
+        switch(p_instr->field) {
+            case PREDICATE_FIELD_POW_FUEL:
+                __indexCmp(&p_plants->fuel_idx, p_instr, bms + i);
+                break;
+
+            case PREDICATE_FIELD_LOG_PLANT_ID:
+                __indexCmp(&p_logs->plant_idx, p_instr, bms + i);
+                break;
+
+            case PREDICATE_FIELD_LOG_YEAR:
+            case PREDICATE_FIELD_LOG_MONTH:
+                __indexMonthCmp(p_logs, p_instr, bms + i);
+                break;
+
+            case PREDICATE_FIELD_LOG_FUEL:
+                __indexLogFuelCmp(p_plants, p_logs, p_instr, bms + i);
+                break;
+
+            default:
+                is_indexed = false;
+                break;
+        }
+    }
+
+    return is_indexed;
+}
+
+
+/// Combine the comparison bitmaps of fully indexed predicate with bitmap operations into
+/// the bitmap of matching rows out of row_c rows
+/// NOTE: Comparison bitmaps are consumed by the evaluation
+void evalPredicateBitmaps (
+    const PredicateInstr *pred,
+    size_t pred_c,
+    RoaringBitmap *bms,
+    size_t row_c,
+    RoaringBitmap *p_out
+) {
+    RoaringBitmap stack[LIST_MAX_PREDICATE_C] = { 0 };
+    size_t n = 0;
+
+    for(size_t i = 0; i < pred_c; i++) {
+        switch(pred[i].op) {
+            case PREDICATE_OP_AND:
+                n--;
+                roaringAnd(stack + n - 1, stack + n);
+                destroyRoaring(stack + n);
+                break;
+
+            case PREDICATE_OP_OR:
+                n--;
+                roaringOr(stack + n - 1, stack + n);
+                destroyRoaring(stack + n);
+                break;
+
+            // Negation is the difference from the bitmap of all rows
+            case PREDICATE_OP_NOT: {
+                RoaringBitmap all = { 0 };
+                roaringAddRange(&all, 0, (uint32_t) row_c);
+                roaringAndNot(&all, stack + n - 1);
+                destroyRoaring(stack + n - 1);
+                stack[n - 1] = all;
+                break;
+            }
+
+            default:
+                stack[n++] = bms[i];
+                bms[i] = (RoaringBitmap) { 0 };
+                break;
+        }
+    }
+
+    destroyRoaring(p_out);
+    if(n) *p_out = stack[0];
+    else roaringAddRange(p_out, 0, (uint32_t) row_c);
+}
+
+
+/// Free all comparison bitmaps of the predicate
+void destroyPredicateBitmaps(RoaringBitmap *bms, size_t pred_c) {
+    for(size_t i = 0; i < pred_c; i++)
+        destroyRoaring(bms + i);
+}
+
+
+/// Check if the power plant matches the predicate
+bool matchPowerPlant(PlantData *p_plant, const PredicateInstr *pred, size_t pred_c) {
+    return __matchRow(p_plant, __powerPlantFieldValue, pred, pred_c, NULL, 0);
+}
+
+
+/// Check if the log entry matches the predicate
+/// NOTE: Comparisons on log fuel type can only be answered with matchLogRow()
+bool matchLogEntry(LogEntry *p_entry, const PredicateInstr *pred, size_t pred_c) {
+    return __matchRow(p_entry, __logEntryFieldValue, pred, pred_c, NULL, 0);
+}
+
+
+/// Check if the archived log of the power plant with the given fuel type matches the predicate
+/// Archived logs are not in bitmap indexes, so all comparisons are evaluated on the log
+bool matchArchivedLog(LogEntry *p_entry, FuelType fuel, const PredicateInstr *pred, size_t pred_c) {
+    __ArchivedLogRow row = { .p_entry = p_entry, .fuel = fuel };
+    return __matchRow(&row, __archivedLogFieldValue, pred, pred_c, NULL, 0);
+}
+
+
+/// Check if the log row matches the predicate, comparisons on indexed fields are
+/// answered from the comparison bitmaps found with indexPredicate()
+bool matchLogRow (
+    PlantLogs *p_logs, 
+    size_t row, 
+    const PredicateInstr *pred, 
+    size_t pred_c,
+    const RoaringBitmap *bms
+) {
+    return __matchRow(p_logs->entries + row, __logEntryFieldValue, pred, pred_c, bms, (uint32_t) row);
+}
+
+
+/// Find the indices of all column rows that match the predicate
+/// Rows are evaluated in blocks of 64, where each instruction produces a bit mask
+/// for the whole block in a tight loop over the column values
+/// If comparison bitmaps are given, masks of comparisons on indexed fields are
+/// read from the bitmaps instead
+/// Returns the amount of matching rows written into out
+size_t filterLogColumns (
+    LogColumns *p_cols,
+    const PredicateInstr *pred,
+    size_t pred_c,
+    const RoaringBitmap *bms,
+    uint32_t *out
+) {
+    double vals[__PREDICATE_BLOCK_SIZE];
+    uint64_t stack[LIST_MAX_PREDICATE_C];
+    size_t out_n = 0;
+
+    for(size_t beg = 0; beg < p_cols->n; beg += __PREDICATE_BLOCK_SIZE) {
+        size_t n = p_cols->n - beg;
+        n = n > __PREDICATE_BLOCK_SIZE ? __PREDICATE_BLOCK_SIZE : n;
+        const uint64_t all = n == 64 ? UINT64_MAX : ((uint64_t) 1 << n) - 1;
+
+        // Evaluate the predicate for all rows of the block at once
+        size_t sn = 0;
+        for(size_t i = 0; i < pred_c; i++) {
+            const PredicateInstr *p_instr = pred + i;
+            switch(p_instr->op) {
+                case PREDICATE_OP_AND:  sn--; stack[sn - 1] &= stack[sn]; break;
+                case PREDICATE_OP_OR:   sn--; stack[sn - 1] |= stack[sn]; break;
+                case PREDICATE_OP_NOT:  stack[sn - 1] = ~stack[sn - 1] & all; break;
+                default:
+                    if(bms && isIndexedPredicateField(p_instr->field)) {
+                        stack[sn++] = roaringWord(bms + i, (uint32_t) beg) & all;
+                        break;
+                    }
+
+                    __loadColumnBlock(p_cols, p_instr->field, beg, n, vals);
+                    stack[sn++] = __cmpBlock(vals, n, p_instr->op, p_instr->val);
+                    break;
+            }
+        }
+
+        // Write out the indices of set bits
+        uint64_t mask = sn ? stack[0] : all;
+        while(mask) {
+            out[out_n++] = (uint32_t) (beg + __builtin_ctzll(mask));
+            mask &= mask - 1;
+        }
+    }
+
+    return out_n;
+}
@@ -42,7 +42,7 @@ void displayLogData(PlantLogRefs *p_refs) {
     // For each log instance print its data
     for(size_t i = 0; i < p_refs->n; i++) {
         char buf[__DEFAULT_BUF_SIZE] = { 0 };
-        char *date = formatDate(&p_refs->p_entries[i]->date);
+        char *date = formatDate(p_refs->p_entries[i]->date);
         sprintf(buf, "  %d.  |  %d.  |  %0.2fMWh  |  %0.4f€ |  %s  ", p_refs->p_entries[i]->log_id,
             p_refs->p_entries[i]->plant_no, p_refs->p_entries[i]->production, p_refs->p_entries[i]->avg_sale_price,
             date);
@@ -81,26 +81,57 @@ void displayPowerPlants(PowerPlantRefs *p_refs) {
 }
 
 
-/// Format date from Date structure into string yyyy-mm-dd format
+/// Display monthly or yearly rollup buckets of the power plant
+void displayRollup(PlantData *p_plant, RollupPeriod period) {
+    char *sep = __mkTableSeparator();
+
+    printf("%s rollup for power plant nr %u (%s): \n"\
+           " | Period | Production (MWh) | Average Sale Price (Euros) | Logs | \n",
+           period == ROLLUP_PERIOD_YEAR ? "Yearly" : "Monthly", p_plant->no, p_plant->name);
+
+    // Monthly buckets are merged into yearly buckets while iterating
+    PlantAggregates agg = { 0 };
+    for(size_t i = 0; i < p_plant->rollup.n; i++) {
+        int32_t month = p_plant->rollup.first_month + (int32_t) i;
+        PlantAggregates *p_bucket = p_plant->rollup.months + i;
+
+        kahanAdd(&agg.production, kahanValue(&p_bucket->production));
+        kahanAdd(&agg.sale_price, kahanValue(&p_bucket->sale_price));
+        agg.n += p_bucket->n;
+
+        // Check if the bucket is the last one of the period
+        if(period == ROLLUP_PERIOD_YEAR && (month + 1) % 12 && i + 1 < p_plant->rollup.n)
+            continue;
+
+        if(agg.n) {
+            char buf[__DEFAULT_BUF_SIZE] = { 0 };
+            char period_str[__DEFAULT_SMALL_BUF_SIZE] = { 0 };
+            int32_t year = month >= 0 ? 1970 + month / 12 : 1969 - (-month - 1) / 12;
+            if(period == ROLLUP_PERIOD_YEAR)
+                sprintf(period_str, "%04d", year);
+            else sprintf(period_str, "%04d-%02d", year, month - (year - 1970) * 12 + 1);
+
+            sprintf(buf, "  %s  |  %0.2fMWh  |  %0.4f€  |  %zu  ", period_str, 
+                kahanValue(&agg.production), kahanValue(&agg.sale_price) / agg.n, agg.n);
+            printf("%s\n%s\n%s\n", sep, buf, sep);
+        }
+
+        agg = (PlantAggregates) { 0 };
+    }
+
+    free(sep);
+}
+
+
+/// Format date from epoch day into string yyyy-mm-dd format
 /// NOTE: This function returns a pointer to stack allocated memory area,
 /// which gets overwritten with every function call
-char *formatDate(Date *p_date) {
+char *formatDate(int32_t day) {
     // Char buffer for containing date information
     static char date[64] = {0};
+    Date civil = epochDayToDate(day);
 
-    // Write year and hyphen to buffer
-    sprintf(date, "%d-", p_date->year);
-    
-    // Check if zero should be added before month number
-    if(p_date->month < 10)
-        sprintf(date + 5, "0%d-", p_date->month);
-    else sprintf(date + 5, "%d-", p_date->month);
-
-    // Check if zero should be added before day number
-    if(p_date->day < 10)
-        sprintf(date + 8, "0%d", p_date->day);
-    else sprintf(date + 8, "%d", p_date->day);
-
+    sprintf(date, "%04d-%02d-%02d", civil.year, civil.month, civil.day);
     return date;
 }
 
@@ -145,6 +176,10 @@ static UserInputAction __convertStrInputToEnum(Hashmap *tokens, char *in_str, bo
         return USER_INPUT_ACTION_SAVE;
     else if(!strncmp(in_str, "exit", len))
         return USER_INPUT_ACTION_EXIT;
+    else if(!strncmp(in_str, "compact", len))
+        return USER_INPUT_ACTION_COMPACT;
+    else if(!strncmp(in_str, "mem", len))
+        return USER_INPUT_ACTION_MEM;
 
     char buf[__DEFAULT_BUF_SIZE] = { 0 };
 
@@ -222,16 +257,371 @@ Hashmap tokeniseUserInput() {
 }
 
 
+/// Split the where clause arguments into tokens, where comparison operators and
+/// parentheses form their own tokens even if they are not separated by spaces
+/// Returns false if there are too many or too long tokens
+static bool __lexWhereArgs(char **args, size_t arg_c, __WhereParser *p_parser) {
+    for(size_t i = 0; i < arg_c; i++) {
+        char *ptr = args[i];
+        while(*ptr) {
+            // Find the length of the next token
+            size_t len = 1;
+            if(strchr("<>=!", *ptr))
+                len = ptr[1] == '=' ? 2 : 1;
+            else if(*ptr != '(' && *ptr != ')')
+                len = strcspn(ptr, "<>=!()");
+
+            if(p_parser->token_c >= __MAX_WHERE_TOKEN_C || len >= __MAX_WHERE_TOKEN_LEN)
+                return false;
+
+            strncpy(p_parser->tokens[p_parser->token_c], ptr, len);
+            p_parser->tokens[p_parser->token_c][len] = 0x00;
+            p_parser->token_c++;
+            ptr += len;
+        }
+    }
+
+    return true;
+}
+
+
+/// Append the instruction to the compiled predicate of the query
+static bool __emitPredicate(__WhereParser *p_parser, PredicateOp op, PredicateField field, double val) {
+    ListQuery *p_query = p_parser->p_query;
+    if(p_query->pred_c >= LIST_MAX_PREDICATE_C)
+        return false;
+
+    p_query->pred[p_query->pred_c++] = (PredicateInstr) { op, field, val };
+    return true;
+}
+
+
+/// Parse the comparison 'field op value' and emit the comparison instruction
+static bool __parseWhereCmp(__WhereParser *p_parser) {
+    static const char *ops[] = { "<", "<=", ">", ">=", "=", "!=" };
+    static const PredicateOp op_codes[] = { PREDICATE_OP_LT, PREDICATE_OP_LE, PREDICATE_OP_GT, 
+        PREDICATE_OP_GE, PREDICATE_OP_EQ, PREDICATE_OP_NE };
+
+    if(p_parser->pos + 3 > p_parser->token_c)
+        return false;
+
+    char *field_str = p_parser->tokens[p_parser->pos];
+    char *op_str = p_parser->tokens[p_parser->pos + 1];
+    char *val_str = p_parser->tokens[p_parser->pos + 2];
+    p_parser->pos += 3;
+
+    // Find the field and the comparison operator
+    size_t field_i = 0;
+    while(field_i < p_parser->field_c && strcmp(p_parser->fields[field_i].str_field, field_str))
+        field_i++;
+    if(field_i == p_parser->field_c) return false;
+    PredicateField field = p_parser->fields[field_i].field;
+
+    size_t op_i = 0;
+    while(op_i < ARR_LEN(ops) && strcmp(ops[op_i], op_str))
+        op_i++;
+    if(!strcmp(op_str, "==")) op_i = 4;
+    if(op_i == ARR_LEN(ops)) return false;
+
+    // Parse the constant according to the field type
+    double val = 0;
+    size_t val_len = strlen(val_str);
+    if(field == PREDICATE_FIELD_LOG_DATE) {
+        int32_t day = 0;
+        if(!parseDate(val_str, val_len, &day)) return false;
+        val = day;
+    }
+    else if(field == PREDICATE_FIELD_POW_FUEL || field == PREDICATE_FIELD_LOG_FUEL) {
+        FuelType fuel = strToFuelType(val_str);
+        if(fuel == FUEL_TYPE_UNKNOWN) return false;
+        val = fuel;
+    }
+    else if(floatcheck(val_str, val_len))
+        val = atof(val_str);
+    else return false;
+
+    return __emitPredicate(p_parser, op_codes[op_i], field, val);
+}
+
+
+/// Parse the comparison, negation or parenthesised expression
+static bool __parseWhereUnary(__WhereParser *p_parser) {
+    if(p_parser->pos >= p_parser->token_c)
+        return false;
+
+    char *token = p_parser->tokens[p_parser->pos];
+    if(!strcmp(token, "not") || !strcmp(token, "!")) {
+        p_parser->pos++;
+        return __parseWhereUnary(p_parser) && __emitPredicate(p_parser, PREDICATE_OP_NOT, 0, 0);
+    }
+
+    if(!strcmp(token, "(")) {
+        p_parser->pos++;
+        if(!__parseWhereOr(p_parser) || p_parser->pos >= p_parser->token_c || 
+           strcmp(p_parser->tokens[p_parser->pos], ")"))
+            return false;
+        p_parser->pos++;
+        return true;
+    }
+
+    return __parseWhereCmp(p_parser);
+}
+
+
+/// Parse the conjunction of unary expressions
+static bool __parseWhereAnd(__WhereParser *p_parser) {
+    if(!__parseWhereUnary(p_parser)) 
+        return false;
+
+    while(p_parser->pos < p_parser->token_c && !strcmp(p_parser->tokens[p_parser->pos], "and")) {
+        p_parser->pos++;
+        if(!__parseWhereUnary(p_parser) || !__emitPredicate(p_parser, PREDICATE_OP_AND, 0, 0))
+            return false;
+    }
+
+    return true;
+}
+
+
+/// Parse the disjunction of conjunctions
+static bool __parseWhereOr(__WhereParser *p_parser) {
+    if(!__parseWhereAnd(p_parser)) 
+        return false;
+
+    while(p_parser->pos < p_parser->token_c && !strcmp(p_parser->tokens[p_parser->pos], "or")) {
+        p_parser->pos++;
+        if(!__parseWhereAnd(p_parser) || !__emitPredicate(p_parser, PREDICATE_OP_OR, 0, 0))
+            return false;
+    }
+
+    return true;
+}
+
+
+/// Compile the where clause arguments into postfix predicate of the query
+/// Returns false if the clause could not be parsed
+static bool __parseWhereArgs (
+    char **args,
+    size_t arg_c,
+    const __PredicateFieldDef *fields,
+    size_t field_c,
+    ListQuery *p_query
+) {
+    __WhereParser *p_parser = (__WhereParser*) calloc(1, sizeof(__WhereParser));
+    p_parser->fields = fields;
+    p_parser->field_c = field_c;
+    p_parser->p_query = p_query;
+
+    // The whole clause must be consumed by the expression
+    bool is_valid = __lexWhereArgs(args, arg_c, p_parser) && __parseWhereOr(p_parser) &&
+        p_parser->pos == p_parser->token_c;
+
+    free(p_parser);
+    return is_valid;
+}
+
+
+/// Parse listing arguments into list query
+/// Returns false if any of the arguments could not be parsed
+static bool __parseListArgs (
+    char **args,
+    size_t arg_c,
+    const __SortDef *modes,
+    size_t mode_c,
+    ListSortMode def_mode,
+    bool allow_range,
+    const __PredicateFieldDef *fields,
+    size_t field_c,
+    ListQuery *p_query
+) {
+    size_t mode_i = 0;
+    bool has_dir = false;
+
+    // For each argument check its meaning
+    for(size_t i = 0; i < arg_c; i++) {
+        // Sorting is done in increasing or decreasing order for the following key
+        if(!strcmp(args[i], "i") || !strcmp(args[i], "d")) {
+            if(has_dir) return false;
+            mode_i = !strcmp(args[i], "d");
+            has_dir = true;
+        }
+
+        // Row window arguments, which must be followed by a positive number
+        else if(!strcmp(args[i], "limit") || !strcmp(args[i], "offset")) {
+            if(i + 1 >= arg_c || !numcheck(args[i + 1], strlen(args[i + 1])))
+                return false;
+
+            size_t val = (size_t) strtoull(args[i + 1], NULL, 10);
+            if(!strcmp(args[i], "limit")) {
+                if(!val) return false;
+                p_query->limit = val;
+            }
+            else p_query->offset = val;
+            i++;
+        }
+
+        // Date range arguments, which must be followed by a date
+        else if(allow_range && (!strcmp(args[i], "from") || !strcmp(args[i], "to"))) {
+            int32_t day = 0;
+            if(i + 1 >= arg_c || !parseDate(args[i + 1], strlen(args[i + 1]), &day))
+                return false;
+
+            if(!p_query->has_range) {
+                p_query->from = INT32_MIN;
+                p_query->to = INT32_MAX;
+                p_query->has_range = true;
+            }
+
+            if(!strcmp(args[i], "from")) p_query->from = day;
+            else p_query->to = day;
+            i++;
+        }
+
+        // Where clause, which takes all of the remaining arguments
+        else if(fields && !strcmp(args[i], "where")) {
+            if(!__parseWhereArgs(args + i + 1, arg_c - i - 1, fields, field_c, p_query))
+                return false;
+            break;
+        }
+
+        // Sort key specifier, keys are given in the order of priority
+        else {
+            if(p_query->smode_c >= LIST_MAX_SORT_KEY_C)
+                return false;
+
+            // Perform linear search for mode specifiers
+            size_t j = 0;
+            while(j < mode_c && strcmp(modes[j].str_mode, args[i]))
+                j++;
+
+            // Check if the key was not found
+            if(j == mode_c) return false;
+
+            p_query->smodes[p_query->smode_c] = modes[j].sort_modes[mode_i];
+            p_query->smode_c++;
+
+            mode_i = 0;
+            has_dir = false;
+        }
+    }
+
+    // Sorting direction was given without a key
+    if(has_dir) return false;
+
+    // Date range queries are shown in date order by default
+    if(!p_query->smode_c && p_query->has_range) {
+        p_query->smodes[0] = LIST_SORT_MODE_LOG_DATE_INCR;
+        p_query->smode_c = 1;
+    }
+
+    if(!p_query->smode_c) {
+        p_query->smodes[0] = def_mode;
+        p_query->smode_c = 1;
+    }
+
+    return true;
+}
+
+
+/// Parse rollup arguments into list query
+/// Returns false if any of the arguments could not be parsed
+static bool __parseRollupArgs(char **args, size_t arg_c, ListQuery *p_query) {
+    if(!arg_c || !strcmp(args[0], "month"))
+        p_query->period = ROLLUP_PERIOD_MONTH;
+    else if(!strcmp(args[0], "year"))
+        p_query->period = ROLLUP_PERIOD_YEAR;
+    else return false;
+
+    return arg_c <= 1;
+}
+
+
+/// Parse group by arguments 'by <key> agg <func>(<field>) [where <expr>]' into list query
+/// Returns false if any of the arguments could not be parsed
+static bool __parseGroupArgs(char **args, size_t arg_c, ListQuery *p_query) {
+    if(arg_c < 4 || strcmp(args[0], "by") || strcmp(args[2], "agg"))
+        return false;
+
+    size_t key_i = 0;
+    while(key_i < ARR_LEN(__group_keys) && strcmp(__group_keys[key_i].str_key, args[1]))
+        key_i++;
+    if(key_i == ARR_LEN(__group_keys)) return false;
+    p_query->group_key = __group_keys[key_i].key;
+
+    // Split the aggregate into function name and the parenthesised field
+    char *open = strchr(args[3], '(');
+    size_t len = strlen(args[3]);
+    if(!open || args[3][len - 1] != ')')
+        return false;
+
+    size_t func_i = 0;
+    while(func_i < ARR_LEN(__group_funcs) && (strlen(__group_funcs[func_i].str_func) != 
+          (size_t) (open - args[3]) || strncmp(__group_funcs[func_i].str_func, args[3], open - args[3])))
+        func_i++;
+    if(func_i == ARR_LEN(__group_funcs)) return false;
+    p_query->agg_func = __group_funcs[func_i].func;
+
+    // Counting does not depend on the field, so any field or '*' is accepted
+    args[3][len - 1] = 0x00;
+    if(!strcmp(open + 1, "production"))
+        p_query->qfield = QUANTILE_FIELD_PRODUCTION;
+    else if(!strcmp(open + 1, "price"))
+        p_query->qfield = QUANTILE_FIELD_SALE_PRICE;
+    else if(strcmp(open + 1, "*") || p_query->agg_func != GROUP_AGG_FUNC_COUNT)
+        return false;
+
+    if(arg_c == 4) return true;
+    return !strcmp(args[4], "where") && __parseWhereArgs(args + 5, arg_c - 5, __log_pred_fields,
+        ARR_LEN(__log_pred_fields), p_query);
+}
+
+
+/// Parse quantile arguments into list query
+/// Returns false if any of the arguments could not be parsed
+static bool __parseQuantileArgs(char **args, size_t arg_c, ListQuery *p_query) {
+    if(!arg_c || arg_c > LIST_MAX_QUANTILE_C + 1)
+        return false;
+
+    if(!strcmp(args[0], "production"))
+        p_query->qfield = QUANTILE_FIELD_PRODUCTION;
+    else if(!strcmp(args[0], "price"))
+        p_query->qfield = QUANTILE_FIELD_SALE_PRICE;
+    else return false;
+
+    // Each quantile is given as percentile in the form p<N>
+    for(size_t i = 1; i < arg_c; i++) {
+        size_t len = strlen(args[i]);
+        if(len < 2 || args[i][0] != 'p' || !floatcheck(args[i] + 1, len - 1))
+            return false;
+
+        double percentile = atof(args[i] + 1);
+        if(percentile > 100)
+            return false;
+        p_query->quantiles[p_query->quantile_c++] = percentile / 100;
+    }
+
+    // Use the default quantiles if none were given
+    if(!p_query->quantile_c) {
+        p_query->quantiles[0] = 0.5;
+        p_query->quantiles[1] = 0.9;
+        p_query->quantiles[2] = 0.99;
+        p_query->quantile_c = 3;
+    }
+
+    return true;
+}
+
+
 /// Parse the user entry into enumeral
 UserInputAction parseUserInputAction ( 
     Hashmap *tokens,
     char *in_str,
     bool is_sel,
-    ListSortMode *p_sort,
+    ListQuery *p_query,
     uint32_t *out_arg
 ) {
-    UserInputAction act;
-    *p_sort = LIST_SORT_MODE_UNKNOWN;
+    UserInputAction act = USER_INPUT_ACTION_UNKNOWN;
+    memset(p_query, 0, sizeof(ListQuery));
 
     // Allocate memory for command line arguments
     size_t cmd_arg_cap = 8;
@@ -254,6 +644,9 @@ UserInputAction parseUserInputAction (
 
         // Check if the word exists
         if(word_end - ptr) {
+            // Check if more memory is needed for arguments
+            reallocCheck((void**) &cmd_args, sizeof(char*), cmd_arg_n + 1, &cmd_arg_cap);
+
             // Allocate memory for the word
             cmd_args[cmd_arg_n] = (char*) calloc(word_end - ptr + 1, sizeof(char));
             
@@ -266,72 +659,82 @@ UserInputAction parseUserInputAction (
     }
 
     // Find the requested action
-    if(!cmd_args[0]) 
-        return USER_INPUT_ACTION_UNKNOWN;
-    else {
-        size_t i = cmd_arg_n == 2 ? 1 : 2;
+    if(cmd_arg_n) {
         act = __convertStrInputToEnum(tokens, cmd_args[0], is_sel, strlen(cmd_args[0]));
 
         // Check if the parsed action is power plant listing 
         if(act == USER_INPUT_ACTION_U_LIST_PLANTS) {
-            if(cmd_arg_n == 1) 
-                *p_sort = LIST_SORT_MODE_POW_ID_INCR;
-
-            else {
-                size_t mode_i = 0;
-                // Sorting is done in increasing order
-                if(cmd_arg_n == 2 || cmd_arg_n == 3 && !strcmp(cmd_args[1], "i"))
-                    mode_i = 0;
-
-                // Sorting is done in decreasing order
-                else if(cmd_arg_n == 3 && !strcmp(cmd_args[1], "d"))
-                    mode_i = 1;
-
-                // Perform linear search for unselected mode specifiers
-                for(size_t j = 0; j < ARR_LEN(__unsel_sort_modes); j++) {
-                    if(!strcmp(__unsel_sort_modes[j].str_mode, cmd_args[i])) {
-                        *p_sort = __unsel_sort_modes[j].sort_modes[mode_i];
-                        break;
-                    }
-                }
-
-                // Check if unknown return is necessary
-                if(*p_sort == LIST_SORT_MODE_UNKNOWN)
-                    return USER_INPUT_ACTION_UNKNOWN;
-            }
+            if(!__parseListArgs(cmd_args + 1, cmd_arg_n - 1, __unsel_sort_modes, 
+               ARR_LEN(__unsel_sort_modes), LIST_SORT_MODE_POW_ID_INCR, false, __plant_pred_fields,
+               ARR_LEN(__plant_pred_fields), p_query))
+                act = USER_INPUT_ACTION_UNKNOWN;
         }
 
         // Check if the parsed action is log listing
         else if(act == USER_INPUT_ACTION_U_LIST_LOGS || act == USER_INPUT_ACTION_S_LIST_LOGS) {
+            if(!__parseListArgs(cmd_args + 1, cmd_arg_n - 1, __sel_sort_modes,
+               ARR_LEN(__sel_sort_modes), LIST_SORT_MODE_LOG_ID_INCR, true, __log_pred_fields,
+               ARR_LEN(__log_pred_fields), p_query))
+                act = USER_INPUT_ACTION_UNKNOWN;
+        }
+        
+        // Check if the parsed action is log counting with optional where clause
+        else if(act == USER_INPUT_ACTION_U_COUNT_LOGS || act == USER_INPUT_ACTION_S_COUNT_LOGS) {
+            if(cmd_arg_n > 1 && (strcmp(cmd_args[1], "where") || !__parseWhereArgs(cmd_args + 2, 
+               cmd_arg_n - 2, __log_pred_fields, ARR_LEN(__log_pred_fields), p_query)))
+                act = USER_INPUT_ACTION_UNKNOWN;
+        }
+        
+        // Check if the parsed action is log grouping
+        else if(act == USER_INPUT_ACTION_U_GROUP_LOGS) {
+            if(!__parseGroupArgs(cmd_args + 1, cmd_arg_n - 1, p_query))
+                act = USER_INPUT_ACTION_UNKNOWN;
+        }
+
+        // Check if the parsed action is rollup display
+        else if(act == USER_INPUT_ACTION_U_SHOW_ROLLUP || act == USER_INPUT_ACTION_S_SHOW_ROLLUP) {
+            if(!__parseRollupArgs(cmd_args + 1, cmd_arg_n - 1, p_query))
+                act = USER_INPUT_ACTION_UNKNOWN;
+        }
+
+        // Check if the parsed action is quantile display
+        else if(act == USER_INPUT_ACTION_U_SHOW_QUANTILES || act == USER_INPUT_ACTION_S_SHOW_QUANTILES) {
+            if(!__parseQuantileArgs(cmd_args + 1, cmd_arg_n - 1, p_query))
+                act = USER_INPUT_ACTION_UNKNOWN;
+        }
+
+        // Check if the parsed action is rolling window display with optional window length
+        else if(act == USER_INPUT_ACTION_U_SHOW_ROLLING || act == USER_INPUT_ACTION_S_SHOW_ROLLING) {
             if(cmd_arg_n == 1)
-                *p_sort = LIST_SORT_MODE_LOG_ID_INCR;
-
-            else {
-                size_t mode_i;
-
-                // Sorting is done in increasing order
-                if(cmd_arg_n == 2 || cmd_arg_n == 3 && !strcmp(cmd_args[1], "i"))
-                    mode_i = 0;
-
-                // Sorting is done in decreasing order
-                else if(cmd_arg_n == 3 && !strcmp(cmd_args[1], "d"))
-                    mode_i = 1;
-
-                // Perform linear search for selected mode specifiers
-                for(size_t j = 0; j < ARR_LEN(__sel_sort_modes); j++) {
-                    if(!strcmp(__sel_sort_modes[j].str_mode, cmd_args[i])) {
-                        *p_sort = __sel_sort_modes[j].sort_modes[mode_i];
-                        break;
-                    }
-                }
-
-                // Check if unknown return is necessary
-                if(*p_sort == LIST_SORT_MODE_UNKNOWN)
-                    return USER_INPUT_ACTION_UNKNOWN;
-            }
+                *out_arg = ROLLING_DEFAULT_DAYS;
+            else if(cmd_arg_n == 2 && numcheck(cmd_args[1], strlen(cmd_args[1])))
+                *out_arg = (uint32_t) atoi(cmd_args[1]);
+            else act = USER_INPUT_ACTION_UNKNOWN;
+        }
+
+        // Check if the parsed action is log archiving with optional log age in days
+        else if(act == USER_INPUT_ACTION_U_ARCHIVE_LOGS) {
+            if(cmd_arg_n == 1)
+                *out_arg = ARCHIVE_DEFAULT_DAYS;
+            else if(cmd_arg_n == 2 && numcheck(cmd_args[1], strlen(cmd_args[1])))
+                *out_arg = (uint32_t) atoi(cmd_args[1]);
+            else act = USER_INPUT_ACTION_UNKNOWN;
+        }
 
+        // Check if the parsed action is statistics display grouped by fuel type,
+        // which accepts an optional thread count
+        else if(act == USER_INPUT_ACTION_U_SHOW_STATS && cmd_arg_n > 1) {
+            act = USER_INPUT_ACTION_UNKNOWN;
+            if(!strcmp(cmd_args[1], "fuel") && cmd_arg_n <= 3) {
+                act = USER_INPUT_ACTION_U_SHOW_FUEL_STATS;
+                *out_arg = 0;
+                if(cmd_arg_n == 3 && numcheck(cmd_args[2], strlen(cmd_args[2])))
+                    *out_arg = (uint32_t) atoi(cmd_args[2]);
+                else if(cmd_arg_n == 3)
+                    act = USER_INPUT_ACTION_UNKNOWN;
+            }
         }
-        
+
         // Check if argument is required
         else if(cmd_arg_n == 2)
             *out_arg = atoi(cmd_args[1]);
@@ -346,6 +749,16 @@ UserInputAction parseUserInputAction (
 }
 
 
+/// Parse log listing arguments into list query
+/// Returns false if any of the arguments could not be parsed
+bool parseLogListArgs(char **args, size_t arg_c, ListQuery *p_query) {
+    memset(p_query, 0, sizeof(ListQuery));
+    return __parseListArgs(args, arg_c, __sel_sort_modes, ARR_LEN(__sel_sort_modes),
+        LIST_SORT_MODE_LOG_ID_INCR, false, __file_log_pred_fields, ARR_LEN(__file_log_pred_fields), 
+        p_query);
+}
+
+
 /********** New powerplant creation prompts *********/
 
 /// Prompt the user about new power plant fuel type
@@ -378,10 +791,9 @@ FuelType __promptNewPowerPlantFuelType(FuelType *old) {
 }
 
 
-/// Prompt the user about new power plant name
-char *__promptNewPowerPlantNameValue(char *old) {
-    // Allocate memory for name buffer
-    char *name = (char*) calloc(__DEFAULT_NAME_LEN, sizeof(char));
+/// Prompt the user about new power plant name, the new name is allocated from the arena
+char *__promptNewPowerPlantNameValue(char *old, Arena *p_arena) {
+    char name[__DEFAULT_NAME_LEN] = { 0 };
 
     // Check if keeping the old values should be considered
     if(old) printf("Enter new power plant name (!k: keep previous value): ");
@@ -396,14 +808,14 @@ char *__promptNewPowerPlantNameValue(char *old) {
     if(old && !strcmp(name, "!k"))
         return old;
 
-    return name;
+    return arenaStrdup(p_arena, name);
 }
 
 
 /********** New log creation prompts **********/
 
 /// Prompt the user about log's date info
-Date __promptNewLogDate(Date *old) {
+int32_t __promptNewLogDate(int32_t *old) {
     // Prompt the user until he enters correct date
     while(true) {
         if(old)
@@ -422,34 +834,17 @@ Date __promptNewLogDate(Date *old) {
             time_t ti = time(NULL);
             struct tm ts = *localtime(&ti);
 
-            return (Date) { 
+            return dateToEpochDay((Date) { 
                 .year = (uint16_t) ts.tm_year + 1900, 
                 .month = (uint16_t) ts.tm_mon + 1,
                 .day = (uint16_t) ts.tm_mday
-            };
+            });
         }
 
-        // Try to parse user input into Date format
-        if(in_buf[4] == '-' && in_buf[7] == '-') {
-            // Create string represantations of year, month and day
-            char year[8] = { 0 };
-            char month[4] = { 0 };
-            char day[4] = { 0 };
-
-            // Copy substrings to their appropriate string instances
-            strncpy(year, in_buf, 4);
-            strncpy(month, in_buf + 5, 2);
-            strncpy(day, in_buf + 8, 2);
-
-            // Check if the string year, month and day are parseable to int
-            if(numcheck(year, 4) && numcheck(month, 2) && numcheck(day, 2)) {
-                return (Date) {
-                    .year = (uint16_t) atoi(year),
-                    .month = (uint16_t) atoi(month),
-                    .day = (uint16_t) atoi(day)
-                };
-            }
-        }
+        // Try to parse user input into epoch day
+        int32_t day = 0;
+        if(parseDate(in_buf, strlen(in_buf), &day))
+            return day;
 
         printf("Invalid date format\n"\
                "Try again\n\n");
@@ -488,7 +883,8 @@ float __promptFloatValue(char *msg, float *old) {
 
 
 /// Prompt the user until he enters correct id or lets it be autogenerated
-uint32_t __promptIdValue(char *msg, size_t *p_max_id, Hashmap *p_map) {
+/// Ids in the optional reserved id bitmap are treated as used
+uint32_t __promptIdValue(char *msg, size_t *p_max_id, IdMap *p_map, const RoaringBitmap *p_reserved) {
     uint32_t id = UINT32_MAX;
 
     // Until no correct number or no auto gen flag is provided prompt the 
@@ -518,7 +914,7 @@ uint32_t __promptIdValue(char *msg, size_t *p_max_id, Hashmap *p_map) {
                 goto ERR;
 
             // Check if the value does not collide with already existing one
-            if(!findValue(p_map, &no, sizeof(uint32_t))) {
+            if(idMapFind(p_map, no) == ID_MAP_NONE && (!p_reserved || !roaringContains(p_reserved, no))) {
                 id = no;
                 
                 // Check if the new id is bigger than the current maximum id
@@ -542,10 +938,10 @@ uint32_t __promptIdValue(char *msg, size_t *p_max_id, Hashmap *p_map) {
 
 
 /// Prompt the user for information about a new power plant instance
-PlantData promptNewPowerPlant(size_t *p_max_id, Hashmap *p_map) {
+PlantData promptNewPowerPlant(size_t *p_max_id, IdMap *p_map, Arena *p_arena) {
     PlantData data = { 0 };
-    data.no = __promptIdValue("Enter new power plant id value", p_max_id, p_map);
-    data.name = __promptNewPowerPlantNameValue(NULL);
+    data.no = __promptIdValue("Enter new power plant id value", p_max_id, p_map, NULL);
+    data.name = __promptNewPowerPlantNameValue(NULL, p_arena);
     data.fuel = __promptNewPowerPlantFuelType(NULL);
     data.rated_cap = __promptFloatValue("Enter new rated capacity", 
         false);
@@ -556,24 +952,27 @@ PlantData promptNewPowerPlant(size_t *p_max_id, Hashmap *p_map) {
 
 
 /// Prompt the user for information about editing a power plant instance
-void promptEditPowerPlant(PlantData *data) {
+void promptEditPowerPlant(PlantData *data, Arena *p_arena) {
     PlantData new_dat = {};
     new_dat.no = data->no;
-    new_dat.name = __promptNewPowerPlantNameValue(data->name);
+    new_dat.name = __promptNewPowerPlantNameValue(data->name, p_arena);
     new_dat.fuel = __promptNewPowerPlantFuelType(&data->fuel);
     new_dat.rated_cap = __promptFloatValue("Enter new rated capacity", 
         &data->rated_cap);
-    new_dat.avg_cost = data->avg_cost;
+    new_dat.agg = data->agg;
+    new_dat.rollup = data->rollup;
+    new_dat.sketch = data->sketch;
     new_dat.logs = data->logs;
+    new_dat.archive = data->archive;
 
-    // Check if the previous name instance memory must be freed
+    // Check if the previous name instance memory must be returned to the arena
     if(new_dat.name != data->name)
-        free(data->name);
+        arenaFree(p_arena, data->name, strlen(data->name) + 1);
 
     *data = new_dat;
 
     // Calculate new average utilisation and cost
-    calcAvgUtilisation(data);
+    calcPlantAverages(data);
 }
 
 
@@ -590,13 +989,11 @@ void promptEditLog(LogEntry *log) {
 
 
 /// Prompt the user to create a new log entry
-LogEntry promptNewLogEntry(Hashmap *p_map, size_t *p_max_id, uint32_t sel_id) {
+/// Ids of archived logs are not available for new logs
+LogEntry promptNewLogEntry(IdMap *p_map, const RoaringBitmap *archived_ids, size_t *p_max_id, uint32_t sel_id) {
     LogEntry entry = { 0 };
-    entry.log_id = __promptIdValue("Enter new log id value", p_max_id, p_map);
+    entry.log_id = __promptIdValue("Enter new log id value", p_max_id, p_map, archived_ids);
     entry.plant_no = sel_id;
-
-    // Temporary value
-    entry.ref_ind = UINT32_MAX;
     entry.avg_sale_price = __promptFloatValue("Enter average price for the day", NULL);
     entry.production = __promptFloatValue("Enter energy production amount (MWh)", NULL); 
     entry.date = __promptNewLogDate(NULL);
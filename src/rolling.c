@@ -0,0 +1,103 @@
+/*
+ * File:        rolling.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-09
+ * Last edit:   2021-06-09
+ * Description: Function definitions for sliding window sums and extremes over
+ *              daily value series
+ */
+
+
+#define __ROLLING_C
+#include <rolling.h>
+
+
+/// Find the value at given position from the front of the deque
+static RollingValue *__dequeAt(RollingDeque *p_q, size_t cap, size_t i) {
+    return p_q->vals + (p_q->beg + i) % cap;
+}
+
+
+/// Remove all values from the front of the deque that are older than the first window day
+static void __dequeEvict(RollingDeque *p_q, size_t cap, int32_t first_day) {
+    while(p_q->n && __dequeAt(p_q, cap, 0)->day < first_day) {
+        p_q->beg = (p_q->beg + 1) % cap;
+        p_q->n--;
+    }
+}
+
+
+/// Create a sliding window of the given amount of days
+void newRollingWindow(RollingWindow *p_win, size_t days) {
+    memset(p_win, 0, sizeof(RollingWindow));
+    p_win->days = days;
+    p_win->vals.vals = (RollingValue*) malloc(days * sizeof(RollingValue));
+    p_win->min_q.vals = (RollingValue*) malloc(days * sizeof(RollingValue));
+    p_win->max_q.vals = (RollingValue*) malloc(days * sizeof(RollingValue));
+
+    if(!p_win->vals.vals || !p_win->min_q.vals || !p_win->max_q.vals) {
+        fprintf(stderr, "Failed to allocate memory for rolling window\n");
+        exit(EXIT_FAILURE);
+    }
+}
+
+
+/// Push the value of the next day into the window, days must be pushed in
+/// increasing order and values of older days are evicted from the window
+void pushRollingWindow(RollingWindow *p_win, int32_t day, double val) {
+    const size_t cap = p_win->days;
+    const int32_t first_day = day - (int32_t) cap + 1;
+
+    // Subtract the evicted values from the sum
+    while(p_win->vals.n && __dequeAt(&p_win->vals, cap, 0)->day < first_day) {
+        kahanAdd(&p_win->sum, -__dequeAt(&p_win->vals, cap, 0)->val);
+        p_win->vals.beg = (p_win->vals.beg + 1) % cap;
+        p_win->vals.n--;
+    }
+
+    __dequeEvict(&p_win->min_q, cap, first_day);
+    __dequeEvict(&p_win->max_q, cap, first_day);
+
+    // Values that can never become the minimum or maximum are popped from the back
+    while(p_win->min_q.n && __dequeAt(&p_win->min_q, cap, p_win->min_q.n - 1)->val >= val)
+        p_win->min_q.n--;
+    while(p_win->max_q.n && __dequeAt(&p_win->max_q, cap, p_win->max_q.n - 1)->val <= val)
+        p_win->max_q.n--;
+
+    *__dequeAt(&p_win->vals, cap, p_win->vals.n++) = (RollingValue) { day, val };
+    *__dequeAt(&p_win->min_q, cap, p_win->min_q.n++) = (RollingValue) { day, val };
+    *__dequeAt(&p_win->max_q, cap, p_win->max_q.n++) = (RollingValue) { day, val };
+    kahanAdd(&p_win->sum, val);
+
+    // Reset the sum once the window holds a single value, so that no rounding
+    // error from the subtractions is carried further
+    if(p_win->vals.n == 1)
+        p_win->sum = (KahanSum) { val, 0 };
+}
+
+
+/// Find the sum of the values in the window
+double rollingSum(RollingWindow *p_win) {
+    return kahanValue(&p_win->sum);
+}
+
+
+/// Find the minimum value in the window
+double rollingMin(RollingWindow *p_win) {
+    return p_win->min_q.n ? __dequeAt(&p_win->min_q, p_win->days, 0)->val : 0;
+}
+
+
+/// Find the maximum value in the window
+double rollingMax(RollingWindow *p_win) {
+    return p_win->max_q.n ? __dequeAt(&p_win->max_q, p_win->days, 0)->val : 0;
+}
+
+
+/// Free all memory allocated for the window
+void destroyRollingWindow(RollingWindow *p_win) {
+    free(p_win->vals.vals);
+    free(p_win->min_q.vals);
+    free(p_win->max_q.vals);
+    memset(p_win, 0, sizeof(RollingWindow));
+}
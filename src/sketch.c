@@ -0,0 +1,185 @@
+/*
+ * File:        sketch.c
+ * Author:      Karl-Mihkel Ott
+ * Created      2021-06-08
+ * Last edit:   2021-06-08
+ * Description: Function definitions for mergeable t-digest quantile sketches
+ */
+
+
+#define __SKETCH_C
+#include <sketch.h>
+
+
+/// Add a centroid into the buffer of the digest, the buffer is compressed when full
+static void __tdigestPush(TDigest *p_td, float mean, float weight) {
+    // Centroids and buffer share a single allocation of constant size
+    if(!p_td->centroids) {
+        p_td->centroids = (TDigestCentroid*) memAlloc(MEM_TAG_PLANTS, (__TDIGEST_CENTROID_CAP + 
+            __TDIGEST_BUFFER_C) * sizeof(TDigestCentroid));
+        if(!p_td->centroids) {
+            fprintf(stderr, "Failed to allocate memory for quantile sketch\n");
+            exit(EXIT_FAILURE);
+        }
+
+        p_td->min = mean;
+        p_td->max = mean;
+    }
+
+    if(p_td->buf_n == __TDIGEST_BUFFER_C)
+        __tdigestCompress(p_td);
+
+    p_td->centroids[p_td->n + p_td->buf_n] = (TDigestCentroid) { mean, weight };
+    p_td->buf_n++;
+    p_td->weight += weight;
+    p_td->min = mean < p_td->min ? mean : p_td->min;
+    p_td->max = mean > p_td->max ? mean : p_td->max;
+}
+
+
+/// Find the quantile limit of a centroid that starts at quantile q0
+/// The k1 scale function k(q) = d / 2pi * asin(2q - 1) is used, which allows each
+/// centroid to span one unit of k, keeping the centroids near the tails small
+static double __tdigestQuantileLimit(double q0) {
+    const double scale = TDIGEST_COMPRESSION / (2 * M_PI);
+    double k = scale * asin(2 * q0 - 1) + 1;
+    if(k >= TDIGEST_COMPRESSION / 4.0)
+        return 1;
+
+    return (sin(k / scale) + 1) / 2;
+}
+
+
+/// Sort the buffered centroids together with compressed centroids and merge
+/// the neighbouring centroids while they fit into the scale function limit
+static void __tdigestCompress(TDigest *p_td) {
+    if(!p_td->buf_n) return;
+
+    // Compressed centroids form a sorted run, which the merge sort detects
+    TDigestCentroid *c = p_td->centroids;
+    const size_t n = p_td->n + p_td->buf_n;
+    mergesort(c, offsetof(TDigestCentroid, mean), sizeof(TDigestCentroid), false,
+        SORT_VALUE_TYPE_FLOAT32, false, 0, n - 1);
+
+    // Merge the centroids in place, since output never overtakes the input
+    size_t out_n = 0;
+    double mean = c[0].mean;
+    double weight = c[0].weight;
+    double prev_w = 0;
+    double q_limit = __tdigestQuantileLimit(0);
+
+    for(size_t i = 1; i < n; i++) {
+        double q = (prev_w + weight + c[i].weight) / p_td->weight;
+        if(q <= q_limit) {
+            weight += c[i].weight;
+            mean += (c[i].mean - mean) * c[i].weight / weight;
+            continue;
+        }
+
+        c[out_n++] = (TDigestCentroid) { (float) mean, (float) weight };
+        prev_w += weight;
+        q_limit = __tdigestQuantileLimit(prev_w / p_td->weight);
+        mean = c[i].mean;
+        weight = c[i].weight;
+    }
+
+    c[out_n++] = (TDigestCentroid) { (float) mean, (float) weight };
+    p_td->n = out_n;
+    p_td->buf_n = 0;
+}
+
+
+/// Add a value into the digest
+void tdigestAdd(TDigest *p_td, float val) {
+    __tdigestPush(p_td, val, 1);
+}
+
+
+/// Merge all centroids of the source digest into the destination digest
+void tdigestMerge(TDigest *p_dst, TDigest *p_src) {
+    if(!p_src->weight) return;
+
+    __tdigestCompress(p_src);
+    for(size_t i = 0; i < p_src->n; i++)
+        __tdigestPush(p_dst, p_src->centroids[i].mean, p_src->centroids[i].weight);
+
+    // Extremes of the source might be summarised inside its centroids
+    p_dst->min = p_src->min < p_dst->min ? p_src->min : p_dst->min;
+    p_dst->max = p_src->max > p_dst->max ? p_src->max : p_dst->max;
+}
+
+
+/// Estimate the value at quantile q (0 <= q <= 1) of the digest
+/// Returns NAN if the digest is empty
+double tdigestQuantile(TDigest *p_td, double q) {
+    __tdigestCompress(p_td);
+    if(!p_td->n) return NAN;
+    if(q <= 0) return p_td->min;
+    if(q >= 1) return p_td->max;
+
+    const TDigestCentroid *c = p_td->centroids;
+    const size_t n = p_td->n;
+    const double index = q * p_td->weight;
+
+    // Interpolate between the minimum and the first centroid
+    double cum_w = c[0].weight / 2;
+    if(index < cum_w)
+        return p_td->min + (c[0].mean - p_td->min) * index / cum_w;
+
+    // Interpolate between the centres of neighbouring centroids
+    for(size_t i = 0; i + 1 < n; i++) {
+        double dw = (c[i].weight + c[i + 1].weight) / 2;
+        if(index < cum_w + dw)
+            return c[i].mean + (c[i + 1].mean - c[i].mean) * (index - cum_w) / dw;
+        cum_w += dw;
+    }
+
+    // Interpolate between the last centroid and the maximum
+    double tail_w = c[n - 1].weight / 2;
+    double t = (index - cum_w) / tail_w;
+    return c[n - 1].mean + (p_td->max - c[n - 1].mean) * (t > 1 ? 1 : t);
+}
+
+
+/// Free all memory allocated for the digest
+void destroyTDigest(TDigest *p_td) {
+    memFree(MEM_TAG_PLANTS, p_td->centroids, (__TDIGEST_CENTROID_CAP + __TDIGEST_BUFFER_C) *
+        sizeof(TDigestCentroid));
+    memset(p_td, 0, sizeof(TDigest));
+}
+
+
+/// Add the log entry values to quantile sketches of the power plant
+void addLogSketches(PlantData *p_plant, LogEntry *p_entry) {
+    // Stale sketches are rebuilt from all logs anyway
+    if(p_plant->sketch.is_stale) return;
+
+    tdigestAdd(&p_plant->sketch.production, p_entry->production);
+    tdigestAdd(&p_plant->sketch.sale_price, p_entry->avg_sale_price);
+}
+
+
+/// Rebuild the quantile sketches of the power plant from its live and archived logs if they are stale
+void refreshPlantSketches(PlantData *p_plant, PlantLogs *p_logs) {
+    if(!p_plant->sketch.is_stale) return;
+
+    destroyPlantSketches(&p_plant->sketch);
+    for(size_t i = 0; i < p_plant->logs.n; i++)
+        addLogSketches(p_plant, p_logs->entries + p_plant->logs.rows[i]);
+
+    // Archived logs are decoded one block at a time
+    LogEntry block[ARCHIVE_BLOCK_LOG_C];
+    for(size_t i = 0; i < p_plant->archive.n; i++) {
+        size_t n = decodeArchiveBlock(p_plant->archive.blocks + i, p_plant->no, block);
+        for(size_t j = 0; j < n; j++)
+            addLogSketches(p_plant, block + j);
+    }
+}
+
+
+/// Free all memory allocated for the power plant quantile sketches
+void destroyPlantSketches(PlantSketches *p_sketch) {
+    destroyTDigest(&p_sketch->production);
+    destroyTDigest(&p_sketch->sale_price);
+    p_sketch->is_stale = false;
+}
@@ -0,0 +1,26 @@
+#!/bin/sh
+# File:        edit_log_date.sh
+# Author:      Karl-Mihkel Ott
+# Created      2021-06-12
+# Last edit:   2021-06-12
+# Description: Check that a log edited to an earlier date stays in the power plant
+#              log rows exactly once
+
+BIN="$(pwd)/energy_manager"
+DIR="$(mktemp -d)"
+cp plants.csv logs.csv "$DIR"
+cd "$DIR" || exit 1
+
+# Log 504 of power plant 62 is moved from 2021-01-27 before all other logs of the plant
+OUT="$(printf 'plants.csv\nlogs.csv\nselect 62\nedit 504\n!k\n!k\n2021-01-01\ncount\nlist\nexit\n' | \
+    timeout 10 "$BIN")"
+cd - > /dev/null
+rm -rf "$DIR"
+
+COUNT="$(printf '%s\n' "$OUT" | grep -c '^ *504\. ')"
+if [ "$COUNT" != 1 ] || ! printf '%s\n' "$OUT" | grep -q 'Matching logs: 9 '; then
+    echo "edit_log_date: FAILED, log 504 is listed $COUNT time(s)"
+    exit 1
+fi
+
+echo "edit_log_date: OK"